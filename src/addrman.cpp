@@ -552,7 +552,24 @@ void AddrManImpl::MakeTried(AddrInfo& info, int nId)
     m_network_counts[info.GetNetwork()].n_tried++;
 }
 
-bool AddrManImpl::AddSingle(const CAddress& addr, const CNetAddr& source, std::chrono::seconds time_penalty)
+std::vector<AddrManImpl::NewTablePosition> AddrManImpl::GetNewTablePositions(Span<const CAddress> addrs, const CNetAddr& source) const
+{
+    std::vector<NewTablePosition> positions;
+    positions.reserve(addrs.size());
+    for (const CAddress& addr : addrs) {
+        // Unroutable addresses are never inserted, don't bother hashing them.
+        if (!addr.IsRoutable()) {
+            positions.push_back({-1, -1});
+            continue;
+        }
+        const AddrInfo info{addr, source};
+        const int bucket{info.GetNewBucket(nKey, source, m_netgroupman)};
+        positions.push_back({bucket, info.GetBucketPosition(nKey, true, bucket)});
+    }
+    return positions;
+}
+
+bool AddrManImpl::AddSingle(const CAddress& addr, const NewTablePosition& new_position, const CNetAddr& source, std::chrono::seconds time_penalty)
 {
     AssertLockHeld(cs);
 
@@ -602,8 +619,8 @@ bool AddrManImpl::AddSingle(const CAddress& addr, const CNetAddr& source, std::c
         pinfo->nTime = std::max(NodeSeconds{0s}, pinfo->nTime - time_penalty);
     }
 
-    int nUBucket = pinfo->GetNewBucket(nKey, source, m_netgroupman);
-    int nUBucketPos = pinfo->GetBucketPosition(nKey, true, nUBucket);
+    const int nUBucket{new_position.bucket};
+    const int nUBucketPos{new_position.position};
     bool fInsert = vvNew[nUBucket][nUBucketPos] == -1;
     if (vvNew[nUBucket][nUBucketPos] != nId) {
         if (!fInsert) {
@@ -682,16 +699,15 @@ bool AddrManImpl::Good_(const CService& addr, bool test_before_evict, NodeSecond
     }
 }
 
-bool AddrManImpl::Add_(const std::vector<CAddress>& vAddr, const CNetAddr& source, std::chrono::seconds time_penalty)
+int AddrManImpl::Add_(Span<const CAddress> addrs, Span<const NewTablePosition> new_positions, const CNetAddr& source, std::chrono::seconds time_penalty)
 {
+    AssertLockHeld(cs);
+
     int added{0};
-    for (std::vector<CAddress>::const_iterator it = vAddr.begin(); it != vAddr.end(); it++) {
-        added += AddSingle(*it, source, time_penalty) ? 1 : 0;
+    for (size_t i = 0; i < addrs.size(); ++i) {
+        added += AddSingle(addrs[i], new_positions[i], source, time_penalty) ? 1 : 0;
     }
-    if (added > 0) {
-        LogPrint(BCLog::ADDRMAN, "Added %i addresses (of %i) from %s: %i tried, %i new\n", added, vAddr.size(), source.ToStringAddr(), nTried, nNew);
-    }
-    return added > 0;
+    return added;
 }
 
 void AddrManImpl::Attempt_(const CService& addr, bool fCountFailure, NodeSeconds time)
@@ -1123,11 +1139,21 @@ size_t AddrManImpl::Size(std::optional<Network> net, std::optional<bool> in_new)
 
 bool AddrManImpl::Add(const std::vector<CAddress>& vAddr, const CNetAddr& source, std::chrono::seconds time_penalty)
 {
-    LOCK(cs);
-    Check();
-    auto ret = Add_(vAddr, source, time_penalty);
-    Check();
-    return ret;
+    // Hash the addresses into the new table before taking the lock, and insert them a batch at a
+    // time, so that a full addr message doesn't hold up Select() and GetAddr() for its duration.
+    const auto new_positions{GetNewTablePositions(vAddr, source)};
+    int added{0};
+    for (size_t begin = 0; begin < vAddr.size(); begin += ADDRMAN_ADD_BATCH_SIZE) {
+        const size_t count{std::min(ADDRMAN_ADD_BATCH_SIZE, vAddr.size() - begin)};
+        LOCK(cs);
+        Check();
+        added += Add_(Span{vAddr}.subspan(begin, count), Span{new_positions}.subspan(begin, count), source, time_penalty);
+        Check();
+        if (begin + count == vAddr.size() && added > 0) {
+            LogPrint(BCLog::ADDRMAN, "Added %i addresses (of %i) from %s: %i tried, %i new\n", added, vAddr.size(), source.ToStringAddr(), nTried, nNew);
+        }
+    }
+    return added > 0;
 }
 
 bool AddrManImpl::Good(const CService& addr, NodeSeconds time)
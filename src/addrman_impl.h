@@ -10,6 +10,7 @@
 #include <netaddress.h>
 #include <protocol.h>
 #include <serialize.h>
+#include <span.h>
 #include <sync.h>
 #include <timedata.h>
 #include <uint256.h>
@@ -32,6 +33,8 @@ static constexpr int ADDRMAN_NEW_BUCKET_COUNT{1 << ADDRMAN_NEW_BUCKET_COUNT_LOG2
 /** Maximum allowed number of entries in buckets for new and tried addresses */
 static constexpr int32_t ADDRMAN_BUCKET_SIZE_LOG2{6};
 static constexpr int ADDRMAN_BUCKET_SIZE{1 << ADDRMAN_BUCKET_SIZE_LOG2};
+/** Maximum number of addresses inserted while holding the lock once */
+static constexpr size_t ADDRMAN_ADD_BATCH_SIZE{100};
 
 /**
  * Extended statistics about a CAddress
@@ -151,7 +154,8 @@ private:
     //! Source of random numbers for randomization in inner loops
     mutable FastRandomContext insecure_rand GUARDED_BY(cs);
 
-    //! secret key to randomize bucket select with
+    //! secret key to randomize bucket select with. Only changed while loading, before the
+    //! address manager is shared, so that it can be read without holding cs.
     uint256 nKey;
 
     //! Serialization versions.
@@ -241,13 +245,25 @@ private:
     //! Move an entry from the "new" table(s) to the "tried" table
     void MakeTried(AddrInfo& info, int nId) EXCLUSIVE_LOCKS_REQUIRED(cs);
 
+    //! Bucket and position in the new table an address from a given source is placed at.
+    struct NewTablePosition {
+        int bucket;
+        int position;
+    };
+
+    //! Compute the new table positions of addresses from a source. This only depends on the
+    //! addresses, the source and nKey, so it doesn't need cs.
+    std::vector<NewTablePosition> GetNewTablePositions(Span<const CAddress> addrs, const CNetAddr& source) const;
+
     /** Attempt to add a single address to addrman's new table.
-     *  @see AddrMan::Add() for parameters. */
-    bool AddSingle(const CAddress& addr, const CNetAddr& source, std::chrono::seconds time_penalty) EXCLUSIVE_LOCKS_REQUIRED(cs);
+     *  @param[in] new_position Its position in the new table, see GetNewTablePositions().
+     *  @see AddrMan::Add() for the other parameters. */
+    bool AddSingle(const CAddress& addr, const NewTablePosition& new_position, const CNetAddr& source, std::chrono::seconds time_penalty) EXCLUSIVE_LOCKS_REQUIRED(cs);
 
     bool Good_(const CService& addr, bool test_before_evict, NodeSeconds time) EXCLUSIVE_LOCKS_REQUIRED(cs);
 
-    bool Add_(const std::vector<CAddress>& vAddr, const CNetAddr& source, std::chrono::seconds time_penalty) EXCLUSIVE_LOCKS_REQUIRED(cs);
+    //! @returns the number of addresses that were added.
+    int Add_(Span<const CAddress> addrs, Span<const NewTablePosition> new_positions, const CNetAddr& source, std::chrono::seconds time_penalty) EXCLUSIVE_LOCKS_REQUIRED(cs);
 
     void Attempt_(const CService& addr, bool fCountFailure, NodeSeconds time) EXCLUSIVE_LOCKS_REQUIRED(cs);
 
@@ -11,41 +11,83 @@
 #include <test/util/setup_common.h>
 #include <txmempool.h>
 #include <validation.h>
-
+#include <validationinterface.h>
 
 #include <vector>
 
-static void AssembleBlock(benchmark::Bench& bench)
+/** Mine blocks and collect loose transactions that spend their matured coinbases */
+static std::vector<CTransactionRef> MineSpendableTransactions(const TestingSetup& test_setup)
 {
-    const auto test_setup = MakeNoLogFileContext<const TestingSetup>();
-
     CScriptWitness witness;
     witness.stack.push_back(WITNESS_STACK_ELEM_OP_TRUE);
 
     // Collect some loose transactions that spend the coinbases of our mined blocks
     constexpr size_t NUM_BLOCKS{200};
-    std::array<CTransactionRef, NUM_BLOCKS - COINBASE_MATURITY + 1> txs;
+    std::vector<CTransactionRef> txs;
     for (size_t b{0}; b < NUM_BLOCKS; ++b) {
         CMutableTransaction tx;
-        tx.vin.push_back(MineBlock(test_setup->m_node, P2WSH_OP_TRUE));
+        tx.vin.push_back(MineBlock(test_setup.m_node, P2WSH_OP_TRUE));
         tx.vin.back().scriptWitness = witness;
         tx.vout.emplace_back(1337, P2WSH_OP_TRUE);
         if (NUM_BLOCKS - b >= COINBASE_MATURITY)
-            txs.at(b) = MakeTransactionRef(tx);
+            txs.push_back(MakeTransactionRef(tx));
     }
     {
         LOCK(::cs_main);
 
         for (const auto& txr : txs) {
-            const MempoolAcceptResult res = test_setup->m_node.chainman->ProcessTransaction(txr);
+            const MempoolAcceptResult res = test_setup.m_node.chainman->ProcessTransaction(txr);
             assert(res.m_result_type == MempoolAcceptResult::ResultType::VALID);
         }
     }
+    return txs;
+}
+
+static void AssembleBlock(benchmark::Bench& bench)
+{
+    const auto test_setup = MakeNoLogFileContext<const TestingSetup>();
+    MineSpendableTransactions(*test_setup);
 
     bench.run([&] {
         PrepareBlock(test_setup->m_node, P2WSH_OP_TRUE);
     });
 }
+
+/** Evict a transaction from the mempool and accept it again before each template request */
+static void AssembleBlockChurn(benchmark::Bench& bench, bool incremental)
+{
+    const auto test_setup = MakeNoLogFileContext<const TestingSetup>();
+    const std::vector<CTransactionRef> txs{MineSpendableTransactions(*test_setup)};
+    CTxMemPool& mempool{*test_setup->m_node.mempool};
+    ChainstateManager& chainman{*test_setup->m_node.chainman};
+
+    node::BlockTemplateManager manager{chainman, mempool, node::BlockAssembler::Options{}};
+    RegisterValidationInterface(&manager);
+
+    size_t i{0};
+    bench.run([&] {
+        const CTransactionRef& tx{txs[i++ % txs.size()]};
+        WITH_LOCK(mempool.cs, mempool.removeRecursive(*tx, MemPoolRemovalReason::EXPIRY));
+        {
+            LOCK(::cs_main);
+            const MempoolAcceptResult res = chainman.ProcessTransaction(tx);
+            assert(res.m_result_type == MempoolAcceptResult::ResultType::VALID);
+        }
+        SyncWithValidationInterfaceQueue();
+
+        if (incremental) {
+            manager.GetTemplate(P2WSH_OP_TRUE);
+        } else {
+            node::BlockAssembler{chainman.ActiveChainstate(), &mempool}.CreateNewBlock(P2WSH_OP_TRUE);
+        }
+    });
+
+    UnregisterValidationInterface(&manager);
+}
+
+static void AssembleBlockChurnRebuild(benchmark::Bench& bench) { AssembleBlockChurn(bench, /*incremental=*/false); }
+static void AssembleBlockChurnIncremental(benchmark::Bench& bench) { AssembleBlockChurn(bench, /*incremental=*/true); }
+
 static void BlockAssemblerAddPackageTxns(benchmark::Bench& bench)
 {
     FastRandomContext det_rand{true};
@@ -60,4 +102,6 @@ static void BlockAssemblerAddPackageTxns(benchmark::Bench& bench)
 }
 
 BENCHMARK(AssembleBlock, benchmark::PriorityLevel::HIGH);
+BENCHMARK(AssembleBlockChurnRebuild, benchmark::PriorityLevel::HIGH);
+BENCHMARK(AssembleBlockChurnIncremental, benchmark::PriorityLevel::HIGH);
 BENCHMARK(BlockAssemblerAddPackageTxns, benchmark::PriorityLevel::LOW);
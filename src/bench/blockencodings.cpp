@@ -0,0 +1,75 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <blockencodings.h>
+#include <consensus/amount.h>
+#include <kernel/mempool_entry.h>
+#include <primitives/block.h>
+#include <random.h>
+#include <script/script.h>
+#include <test/util/setup_common.h>
+#include <txmempool.h>
+#include <validation.h>
+
+#include <cassert>
+#include <vector>
+
+static void AddTx(const CTransactionRef& tx, CTxMemPool& pool) EXCLUSIVE_LOCKS_REQUIRED(cs_main, pool.cs)
+{
+    LockPoints lp;
+    pool.addUnchecked(CTxMemPoolEntry(tx, /*fee=*/1000, /*time=*/0, /*entry_height=*/1, /*spends_coinbase=*/false, /*sigops_cost=*/4, lp));
+}
+
+/** Reconstruct a compact block from a mempool many times the size of the block,
+ *  with one transaction of the block missing, so that the whole mempool is looked at. */
+static void ReconstructCompactBlock(benchmark::Bench& bench)
+{
+    constexpr size_t MEMPOOL_TXS{20000};
+    constexpr size_t BLOCK_TXS{500};
+
+    const auto testing_setup = MakeNoLogFileContext<const TestingSetup>(CBaseChainParams::REGTEST);
+    CTxMemPool& pool = *Assert(testing_setup->m_node.mempool);
+    FastRandomContext det_rand{true};
+
+    CBlock block;
+    {
+        CMutableTransaction coinbase;
+        coinbase.vin.resize(1);
+        coinbase.vin[0].scriptSig = CScript() << OP_TRUE;
+        coinbase.vout.resize(1);
+        coinbase.vout[0].nValue = 50 * COIN;
+        block.vtx.push_back(MakeTransactionRef(coinbase));
+    }
+
+    {
+    LOCK2(cs_main, pool.cs);
+    for (size_t i = 0; i < MEMPOOL_TXS; ++i) {
+        CMutableTransaction tx;
+        tx.vin.resize(1);
+        tx.vin[0].prevout = COutPoint{det_rand.rand256(), 0};
+        tx.vin[0].scriptWitness.stack.push_back({1});
+        tx.vout.resize(1);
+        tx.vout[0].scriptPubKey = CScript() << OP_TRUE;
+        tx.vout[0].nValue = COIN;
+        const CTransactionRef ref{MakeTransactionRef(tx)};
+        // The last transaction of the block is not in the mempool
+        if (i != BLOCK_TXS - 1) AddTx(ref, pool);
+        if (i < BLOCK_TXS) block.vtx.push_back(ref);
+    }
+    }
+
+    block.nBits = 0x207fffff;
+    const CBlockHeaderAndShortTxIDs cmpctblock{block};
+    const std::vector<std::pair<uint256, CTransactionRef>> extra_txn;
+
+    bench.run([&] {
+        PartiallyDownloadedBlock partial_block{&pool};
+        const ReadStatus status{partial_block.InitData(cmpctblock, extra_txn)};
+        assert(status == READ_STATUS_OK);
+        assert(!partial_block.IsTxAvailable(BLOCK_TXS));
+    });
+}
+
+BENCHMARK(ReconstructCompactBlock, benchmark::PriorityLevel::HIGH);
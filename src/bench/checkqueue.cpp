@@ -3,12 +3,19 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <bench/bench.h>
+#include <bench/data.h>
 #include <checkqueue.h>
 #include <key.h>
 #include <prevector.h>
+#include <primitives/block.h>
 #include <pubkey.h>
 #include <random.h>
+#include <script/interpreter.h>
+#include <script/sigcache.h>
+#include <streams.h>
+#include <test/util/setup_common.h>
 #include <util/system.h>
+#include <validation.h>
 
 #include <vector>
 
@@ -20,11 +27,8 @@ static const unsigned int QUEUE_BATCH_SIZE = 128;
 // This Benchmark tests the CheckQueue with a slightly realistic workload,
 // where checks all contain a prevector that is indirect 50% of the time
 // and there is a little bit of work done between calls to Add.
-static void CCheckQueueSpeedPrevectorJob(benchmark::Bench& bench)
+static void CheckQueuePrevectorJob(benchmark::Bench& bench, int worker_threads)
 {
-    // We shouldn't ever be running with the checkqueue on a single core machine.
-    if (GetNumCores() <= 1) return;
-
     ECC_Start();
 
     struct PrevectorJob {
@@ -38,9 +42,7 @@ static void CCheckQueueSpeedPrevectorJob(benchmark::Bench& bench)
         }
     };
     CCheckQueue<PrevectorJob> queue {QUEUE_BATCH_SIZE};
-    // The main thread should be counted to prevent thread oversubscription, and
-    // to decrease the variance of benchmark results.
-    queue.StartWorkerThreads(GetNumCores() - 1);
+    queue.StartWorkerThreads(worker_threads);
 
     // create all the data once, then submit copies in the benchmark.
     FastRandomContext insecure_rand(true);
@@ -64,4 +66,91 @@ static void CCheckQueueSpeedPrevectorJob(benchmark::Bench& bench)
     queue.StopWorkerThreads();
     ECC_Stop();
 }
+
+static void CCheckQueueSpeedPrevectorJob(benchmark::Bench& bench)
+{
+    // We shouldn't ever be running with the checkqueue on a single core machine.
+    if (GetNumCores() <= 1) return;
+
+    // The main thread should be counted to prevent thread oversubscription, and
+    // to decrease the variance of benchmark results.
+    CheckQueuePrevectorJob(bench, GetNumCores() - 1);
+}
+
+// Fixed thread counts (including the master), to compare how the queue
+// scales independently of the machine the benchmark runs on.
+static void CCheckQueuePrevectorJob2Threads(benchmark::Bench& bench) { CheckQueuePrevectorJob(bench, 1); }
+static void CCheckQueuePrevectorJob8Threads(benchmark::Bench& bench) { CheckQueuePrevectorJob(bench, 7); }
+static void CCheckQueuePrevectorJob32Threads(benchmark::Bench& bench) { CheckQueuePrevectorJob(bench, 31); }
+
+// Verifies the scripts of block 6513497 extended with synthetic transactions
+// that spend `inputs_per_tx` Taproot key-path outputs each, through a script
+// check queue as ConnectBlock does (Schnorr signatures are batch verified).
+static void CheckQueueTaprootBlock(benchmark::Bench& bench, size_t n_txs, size_t inputs_per_tx)
+{
+    const auto testing_setup{MakeNoLogFileContext<const BasicTestingSetup>()};
+    const unsigned int flags{SCRIPT_VERIFY_P2SH | SCRIPT_VERIFY_WITNESS | SCRIPT_VERIFY_TAPROOT};
+
+    CBlock block;
+    CDataStream{benchmark::data::block6513497, SER_NETWORK, PROTOCOL_VERSION} >> block;
+
+    FastRandomContext rng{true};
+    CKey key;
+    key.MakeNewKey(true);
+    const XOnlyPubKey output_key{XOnlyPubKey{key.GetPubKey()}.CreateTapTweak(nullptr)->first};
+    const CTxOut spent{1 * COIN, CScript() << OP_1 << ToByteVector(output_key)};
+
+    const uint256 no_scripts;
+    ScriptExecutionData execdata;
+    execdata.m_annex_init = true;
+    execdata.m_annex_present = false;
+    for (size_t t = 0; t < n_txs; ++t) {
+        CMutableTransaction mtx;
+        mtx.vin.resize(inputs_per_tx);
+        for (auto& txin : mtx.vin) txin.prevout = COutPoint{rng.rand256(), 0};
+        mtx.vout.push_back(spent);
+        PrecomputedTransactionData sign_data;
+        sign_data.Init(mtx, std::vector<CTxOut>(inputs_per_tx, spent), /*force=*/true);
+        for (size_t i = 0; i < inputs_per_tx; ++i) {
+            uint256 sighash;
+            bool ok = SignatureHashSchnorr(sighash, execdata, mtx, i, SIGHASH_DEFAULT, SigVersion::TAPROOT, sign_data, MissingDataBehavior::FAIL);
+            std::vector<unsigned char> sig(64);
+            // A null merkle root selects the key-path tweak for an output without scripts.
+            ok = ok && key.SignSchnorr(sighash, sig, &no_scripts, rng.rand256());
+            assert(ok);
+            mtx.vin[i].scriptWitness.stack.push_back(std::move(sig));
+        }
+        block.vtx.push_back(MakeTransactionRef(std::move(mtx)));
+    }
+
+    std::vector<PrecomputedTransactionData> txdata(block.vtx.size());
+    for (size_t t = 1; t < block.vtx.size(); ++t) {
+        txdata[t].Init(*block.vtx[t], std::vector<CTxOut>(block.vtx[t]->vin.size(), spent));
+    }
+
+    CCheckQueue<CScriptCheck> queue{QUEUE_BATCH_SIZE};
+    queue.StartWorkerThreads(std::max(0, GetNumCores() - 1));
+    bench.batch(n_txs * inputs_per_tx).unit("input").run([&] {
+        CCheckQueueControl<CScriptCheck> control(&queue);
+        for (size_t t = 1; t < block.vtx.size(); ++t) {
+            std::vector<CScriptCheck> vChecks;
+            for (size_t i = 0; i < block.vtx[t]->vin.size(); ++i) {
+                vChecks.emplace_back(spent, *block.vtx[t], i, flags, /*cacheIn=*/false, &txdata[t]);
+            }
+            control.Add(std::move(vChecks));
+        }
+        bool ok = control.Wait();
+        assert(ok);
+    });
+    queue.StopWorkerThreads();
+}
+
+static void CCheckQueueTaprootPayments(benchmark::Bench& bench) { CheckQueueTaprootBlock(bench, 500, 2); }
+static void CCheckQueueTaprootConsolidations(benchmark::Bench& bench) { CheckQueueTaprootBlock(bench, 5, 200); }
+
 BENCHMARK(CCheckQueueSpeedPrevectorJob, benchmark::PriorityLevel::HIGH);
+BENCHMARK(CCheckQueuePrevectorJob2Threads, benchmark::PriorityLevel::HIGH);
+BENCHMARK(CCheckQueuePrevectorJob8Threads, benchmark::PriorityLevel::HIGH);
+BENCHMARK(CCheckQueuePrevectorJob32Threads, benchmark::PriorityLevel::HIGH);
+BENCHMARK(CCheckQueueTaprootPayments, benchmark::PriorityLevel::HIGH);
+BENCHMARK(CCheckQueueTaprootConsolidations, benchmark::PriorityLevel::HIGH);
@@ -30,10 +30,10 @@ static void LoadExternalBlockFile(benchmark::Bench& bench)
     DataStream ss{};
     auto params{testing_setup->m_node.chainman->GetParams()};
     ss << params.MessageStart();
-    ss << static_cast<uint32_t>(benchmark::data::block413567.size());
-    // We can't use the streaming serialization (ss << benchmark::data::block413567)
+    ss << static_cast<uint32_t>(benchmark::data::block6513497.size());
+    // We can't use the streaming serialization (ss << benchmark::data::block6513497)
     // because that first writes a compact size.
-    ss.write(MakeByteSpan(benchmark::data::block413567));
+    ss.write(MakeByteSpan(benchmark::data::block6513497));
 
     // Create the test file.
     {
@@ -100,6 +100,34 @@ static void ComplexMemPool(benchmark::Bench& bench)
     });
 }
 
+static void MemPoolLongChains(benchmark::Bench& bench)
+{
+    // Chains of transactions that each spend their parent, as built by
+    // repeated CPFP, which are then mined parent first.
+    constexpr int NUM_CHAINS{40};
+    constexpr int CHAIN_LENGTH{25};
+    std::vector<CTransactionRef> ordered_txs;
+    for (int chain = 0; chain < NUM_CHAINS; ++chain) {
+        COutPoint prevout{uint256::ONE, static_cast<uint32_t>(chain)};
+        for (int depth = 0; depth < CHAIN_LENGTH; ++depth) {
+            CMutableTransaction tx;
+            tx.vin.emplace_back(prevout);
+            tx.vout.emplace_back(10 * COIN, CScript() << OP_TRUE);
+            ordered_txs.emplace_back(MakeTransactionRef(tx));
+            prevout = COutPoint{ordered_txs.back()->GetHash(), 0};
+        }
+    }
+    const auto testing_setup = MakeNoLogFileContext<const TestingSetup>(CBaseChainParams::MAIN);
+    CTxMemPool& pool = *testing_setup.get()->m_node.mempool;
+    LOCK2(cs_main, pool.cs);
+    bench.run([&]() NO_THREAD_SAFETY_ANALYSIS {
+        for (auto& tx : ordered_txs) {
+            AddTx(tx, pool);
+        }
+        pool.removeForBlock(ordered_txs, /*nBlockHeight=*/1);
+    });
+}
+
 static void MempoolCheck(benchmark::Bench& bench)
 {
     FastRandomContext det_rand{true};
@@ -116,4 +144,5 @@ static void MempoolCheck(benchmark::Bench& bench)
 }
 
 BENCHMARK(ComplexMemPool, benchmark::PriorityLevel::HIGH);
+BENCHMARK(MemPoolLongChains, benchmark::PriorityLevel::HIGH);
 BENCHMARK(MempoolCheck, benchmark::PriorityLevel::HIGH);
@@ -5,8 +5,10 @@
 #include <bench/bench.h>
 
 #include <consensus/merkle.h>
+#include <primitives/block.h>
 #include <random.h>
 #include <uint256.h>
+#include <validation.h>
 
 static void MerkleRoot(benchmark::Bench& bench)
 {
@@ -23,4 +25,33 @@ static void MerkleRoot(benchmark::Bench& bench)
     });
 }
 
+// Merkle root of a block with many transactions, computed serially (worker_threads
+// == 0) or with the lower levels split over the given number of worker threads.
+static void BlockMerkleRootThreads(benchmark::Bench& bench, int worker_threads)
+{
+    CBlock block;
+    block.vtx.resize(9001);
+    for (size_t i = 0; i < block.vtx.size(); ++i) {
+        CMutableTransaction mtx;
+        mtx.nLockTime = i;
+        block.vtx[i] = MakeTransactionRef(std::move(mtx));
+    }
+    if (worker_threads > 0) StartScriptCheckWorkerThreads(worker_threads);
+    bench.batch(block.vtx.size()).unit("leaf").run([&] {
+        bool mutation = false;
+        uint256 hash = ParallelBlockMerkleRoot(block, &mutation);
+        assert(!mutation && !hash.IsNull());
+    });
+    if (worker_threads > 0) StopScriptCheckWorkerThreads();
+}
+
+static void BlockMerkleRootSerial(benchmark::Bench& bench) { BlockMerkleRootThreads(bench, 0); }
+static void BlockMerkleRoot2Threads(benchmark::Bench& bench) { BlockMerkleRootThreads(bench, 1); }
+static void BlockMerkleRoot4Threads(benchmark::Bench& bench) { BlockMerkleRootThreads(bench, 3); }
+static void BlockMerkleRoot8Threads(benchmark::Bench& bench) { BlockMerkleRootThreads(bench, 7); }
+
 BENCHMARK(MerkleRoot, benchmark::PriorityLevel::HIGH);
+BENCHMARK(BlockMerkleRootSerial, benchmark::PriorityLevel::HIGH);
+BENCHMARK(BlockMerkleRoot2Threads, benchmark::PriorityLevel::HIGH);
+BENCHMARK(BlockMerkleRoot4Threads, benchmark::PriorityLevel::HIGH);
+BENCHMARK(BlockMerkleRoot8Threads, benchmark::PriorityLevel::HIGH);
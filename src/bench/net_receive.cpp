@@ -0,0 +1,57 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <chainparamsbase.h>
+#include <net.h>
+#include <netmessagemaker.h>
+#include <protocol.h>
+#include <random.h>
+#include <test/util/setup_common.h>
+#include <version.h>
+
+#include <cassert>
+#include <vector>
+
+//! Small messages in one network read, as during a flood of transaction announcements
+static constexpr int MESSAGES_PER_READ{100};
+
+/** Deserialize a read of small inv messages and hand them to the message handler */
+static void ReceiveSmallMessages(benchmark::Bench& bench)
+{
+    const auto testing_setup = MakeNoLogFileContext<const BasicTestingSetup>(CBaseChainParams::REGTEST);
+    CNode node{/*id=*/0,
+               /*sock=*/nullptr,
+               CAddress{},
+               /*nKeyedNetGroupIn=*/0,
+               /*nLocalHostNonceIn=*/0,
+               CAddress{},
+               /*addrNameIn=*/std::string{},
+               ConnectionType::INBOUND,
+               /*inbound_onion=*/false};
+
+    std::vector<unsigned char> wire;
+    for (int i = 0; i < MESSAGES_PER_READ; ++i) {
+        const SharedNetMsg msg{CNetMsgMaker{INIT_PROTO_VERSION}.Make(NetMsgType::INV, std::vector<CInv>{CInv{MSG_WTX, GetRandHash()}})};
+        std::vector<unsigned char> header;
+        V1TransportSerializer{}.prepareForTransport(msg, header);
+        wire.insert(wire.end(), header.begin(), header.end());
+        wire.insert(wire.end(), msg.Data()->begin(), msg.Data()->end());
+    }
+
+    bench.batch(MESSAGES_PER_READ).unit("message").run([&] {
+        bool complete{false};
+        const bool ok{node.ReceiveMsgBytes(wire, complete)};
+        assert(ok && complete);
+        node.MarkReceivedMsgsForProcessing();
+        int received{0};
+        while (auto poll_result{node.PollMessage()}) {
+            ++received;
+            if (!poll_result->second) break;
+        }
+        assert(received == MESSAGES_PER_READ);
+    });
+}
+
+BENCHMARK(ReceiveSmallMessages, benchmark::PriorityLevel::HIGH);
@@ -6,6 +6,7 @@
 #include <bench/data.h>
 
 #include <rpc/blockchain.h>
+#include <rpc/jsonstream.h>
 #include <streams.h>
 #include <test/util/setup_common.h>
 #include <validation.h>
@@ -58,3 +59,18 @@ static void BlockToJsonVerboseWrite(benchmark::Bench& bench)
 }
 
 BENCHMARK(BlockToJsonVerboseWrite, benchmark::PriorityLevel::HIGH);
+
+static void BlockToJsonVerboseStream(benchmark::Bench& bench)
+{
+    TestBlockAndIndex data;
+    size_t written{0};
+    bench.run([&] {
+        // Unlike BlockToJsonVerbose followed by BlockToJsonVerboseWrite, no
+        // more than one transaction and one buffer of output exist at a time
+        JSONStreamWriter writer{[&](Span<const char> chunk) { written += chunk.size(); }};
+        blockToJSON(writer, data.testing_setup->m_node.chainman->m_blockman, data.block, &data.blockindex, &data.blockindex, TxVerbosity::SHOW_DETAILS_AND_PREVOUT);
+    });
+    ankerl::nanobench::doNotOptimizeAway(written);
+}
+
+BENCHMARK(BlockToJsonVerboseStream, benchmark::PriorityLevel::HIGH);
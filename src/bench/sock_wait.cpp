@@ -0,0 +1,71 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <compat/compat.h>
+#include <util/fs_helpers.h>
+#include <util/sock.h>
+
+#include <algorithm>
+#include <cassert>
+#include <memory>
+#include <vector>
+
+#ifndef WIN32
+#include <sys/socket.h>
+
+//! Connected peers that send nothing, as on a node with many inbound connections
+static constexpr int IDLE_PEERS{1000};
+
+static std::vector<std::shared_ptr<const Sock>> CreateIdlePeers(std::vector<std::unique_ptr<Sock>>& remote_ends)
+{
+    // Two descriptors per peer, and some headroom for the rest of the process
+    const int peers{std::min(IDLE_PEERS, (RaiseFileDescriptorLimit(2 * IDLE_PEERS + 100) - 100) / 2)};
+    std::vector<std::shared_ptr<const Sock>> socks;
+    for (int i = 0; i < peers; ++i) {
+        int fds[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) break;
+        socks.push_back(std::make_shared<const Sock>(fds[0]));
+        remote_ends.push_back(std::make_unique<Sock>(fds[1]));
+    }
+    return socks;
+}
+
+/** Build the events to wait for and poll all sockets, on every wait */
+static void SockWaitManyIdlePeers(benchmark::Bench& bench)
+{
+    std::vector<std::unique_ptr<Sock>> remote_ends;
+    const auto socks{CreateIdlePeers(remote_ends)};
+
+    bench.run([&] {
+        Sock::EventsPerSock events_per_sock;
+        for (const auto& sock : socks) {
+            events_per_sock.emplace(sock, Sock::Events{Sock::RECV});
+        }
+        const bool ok{events_per_sock.begin()->first->WaitMany(0ms, events_per_sock)};
+        assert(ok);
+    });
+}
+
+/** Keep the sockets registered between waits, as CConnman::SocketHandler() does */
+static void SockEventSetIdlePeers(benchmark::Bench& bench)
+{
+    std::vector<std::unique_ptr<Sock>> remote_ends;
+    const auto socks{CreateIdlePeers(remote_ends)};
+    SockEventSet sock_events;
+    Sock::EventsPerSock occurred;
+
+    bench.run([&] {
+        for (const auto& sock : socks) {
+            sock_events.Set(sock, Sock::RECV);
+        }
+        sock_events.RemoveUnset();
+        const bool ok{sock_events.Wait(0ms, occurred)};
+        assert(ok && occurred.empty());
+    });
+}
+
+BENCHMARK(SockWaitManyIdlePeers, benchmark::PriorityLevel::HIGH);
+BENCHMARK(SockEventSetIdlePeers, benchmark::PriorityLevel::HIGH);
+#endif // WIN32
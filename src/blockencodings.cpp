@@ -16,6 +16,10 @@
 
 #include <unordered_map>
 
+/** Bits of the short ID filter of PartiallyDownloadedBlock::InitData per short ID in the
+ *  compact block. One in 16 mempool transactions not in the block gets past the filter. */
+static constexpr size_t SHORTTXIDS_FILTER_BITS_PER_TX = 16;
+
 CBlockHeaderAndShortTxIDs::CBlockHeaderAndShortTxIDs(const CBlock& block) :
         nonce(GetRand<uint64_t>()),
         shorttxids(block.vtx.size() - 1), prefilledtxn(1), header(block) {
@@ -103,11 +107,25 @@ ReadStatus PartiallyDownloadedBlock::InitData(const CBlockHeaderAndShortTxIDs& c
     if (shorttxids.size() != cmpctblock.shorttxids.size())
         return READ_STATUS_FAILED; // Short ID collision
 
+    // Almost none of the mempool is in the block. A bit for each short ID, indexed by its
+    // low bits, rules out most mempool transactions before looking up the map above, so
+    // the scan of the mempool costs little more than computing the short IDs.
+    size_t filter_size = 64;
+    while (filter_size < cmpctblock.shorttxids.size() * SHORTTXIDS_FILTER_BITS_PER_TX)
+        filter_size <<= 1;
+    const uint64_t filter_mask = filter_size - 1;
+    std::vector<uint64_t> filter(filter_size / 64);
+    for (const uint64_t shortid : cmpctblock.shorttxids) {
+        filter[(shortid & filter_mask) >> 6] |= uint64_t{1} << (shortid & 63);
+    }
+
     std::vector<bool> have_txn(txn_available.size());
     {
     LOCK(pool->cs);
     for (size_t i = 0; i < pool->vTxHashes.size(); i++) {
         uint64_t shortid = cmpctblock.GetShortID(pool->vTxHashes[i].first);
+        if (!((filter[(shortid & filter_mask) >> 6] >> (shortid & 63)) & 1))
+            continue;
         std::unordered_map<uint64_t, uint16_t>::iterator idit = shorttxids.find(shortid);
         if (idit != shorttxids.end()) {
             if (!have_txn[idit->second]) {
@@ -11,12 +11,39 @@
 #include <util/threadnames.h>
 
 #include <algorithm>
+#include <atomic>
+#include <deque>
 #include <iterator>
+#include <memory>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 template <typename T>
 class CCheckQueueControl;
 
+/**
+ * A check type may declare a nested `Batch` type. Each participant then keeps
+ * one such object, runs its checks as `check(batch)` and finally calls
+ * `batch.Verify()`, which completes whatever work the checks deferred to it.
+ * If that fails, the checks are run again on their own (`check()`), so the
+ * result never depends on the batch alone.
+ */
+template <typename T, typename = void>
+struct CheckQueueBatch {
+    static constexpr bool enabled{false};
+    struct type {
+    };
+};
+
+template <typename T>
+struct CheckQueueBatch<T, std::void_t<typename T::Batch>> {
+    static constexpr bool enabled{true};
+    using type = typename T::Batch;
+};
+
 /**
  * Queue for verifications that have to be performed.
   * The verifications are represented by a type T, which must provide an
@@ -26,12 +53,25 @@ class CCheckQueueControl;
   * onto the queue, where they are processed by N-1 worker threads. When
   * the master is done adding work, it temporarily joins the worker pool
   * as an N'th worker, until all jobs are done.
+  *
+  * Every participant (each worker, plus the master) owns a deque of
+  * pending checks. The master spreads added checks over all deques in
+  * chunks; a participant takes work from the back of its own deque and,
+  * once that is empty, steals from the front of the others. The shared
+  * mutex is only taken to go to sleep, so executing checks does not
+  * contend on a single lock.
   */
 template <typename T>
 class CCheckQueue
 {
 private:
-    //! Mutex to protect the inner state
+    //! Pending checks owned by one participant, which other participants may steal from.
+    struct WorkQueue {
+        Mutex m_mutex;
+        std::deque<T> m_checks GUARDED_BY(m_mutex);
+    };
+
+    //! Mutex to protect the sleep/wake-up state
     Mutex m_mutex;
 
     //! Worker threads block on this when out of work
@@ -40,117 +80,166 @@ private:
     //! Master thread blocks on this when out of work
     std::condition_variable m_master_cv;
 
-    //! The queue of elements to be processed.
-    //! As the order of booleans doesn't matter, it is used as a LIFO (stack)
-    std::vector<T> queue GUARDED_BY(m_mutex);
+    //! One work queue per worker thread, the last one belongs to the master.
+    //! Only resized while no worker threads are running.
+    std::vector<std::unique_ptr<WorkQueue>> m_queues;
 
-    //! The number of workers (including the master) that are idle.
-    int nIdle GUARDED_BY(m_mutex){0};
+    //! Index of the work queue that receives the next chunk of added checks.
+    //! Only used by the thread holding m_control_mutex.
+    size_t m_next_queue{0};
 
-    //! The total number of workers (including the master).
-    int nTotal GUARDED_BY(m_mutex){0};
-
-    //! The temporary evaluation result.
-    bool fAllOk GUARDED_BY(m_mutex){true};
+    //! Number of checks sitting in the work queues, not yet taken by anyone.
+    std::atomic<unsigned int> m_queued{0};
 
     /**
      * Number of verifications that haven't completed yet.
-     * This includes elements that are no longer queued, but still in the
-     * worker's own batches.
+     * This includes elements that are no longer queued, but still in a
+     * participant's own batch.
      */
-    unsigned int nTodo GUARDED_BY(m_mutex){0};
+    std::atomic<unsigned int> m_todo{0};
+
+    //! The temporary evaluation result.
+    std::atomic<bool> m_all_ok{true};
 
     //! The maximum number of elements to be processed in one batch
     const unsigned int nBatchSize;
 
+    //! Name of the worker threads, suffixed with their index
+    const std::string m_thread_name;
+
     std::vector<std::thread> m_worker_threads;
     bool m_request_stop GUARDED_BY(m_mutex){false};
 
+    /**
+     * Move a batch of checks into vChecks: from the back of our own work
+     * queue if it has any, otherwise from the front of another one.
+     * Takes at most half of a queue so the remainder stays available to
+     * thieves, and never more than nBatchSize.
+     */
+    bool TakeChecks(size_t self, std::vector<T>& vChecks)
+    {
+        const size_t n_queues{m_queues.size()};
+        for (size_t i = 0; i < n_queues; ++i) {
+            const bool own{i == 0};
+            WorkQueue& wq{*m_queues[(self + i) % n_queues]};
+            LOCK(wq.m_mutex);
+            auto& checks{wq.m_checks};
+            if (checks.empty()) continue;
+            const size_t nNow{std::max<size_t>(1, std::min<size_t>(nBatchSize, checks.size() / 2))};
+            if (own) {
+                const auto start_it{checks.end() - nNow};
+                vChecks.assign(std::make_move_iterator(start_it), std::make_move_iterator(checks.end()));
+                checks.erase(start_it, checks.end());
+            } else {
+                const auto end_it{checks.begin() + nNow};
+                vChecks.assign(std::make_move_iterator(checks.begin()), std::make_move_iterator(end_it));
+                checks.erase(checks.begin(), end_it);
+            }
+            m_queued -= nNow;
+            return true;
+        }
+        return false;
+    }
+
+    /** Run a batch of checks, stopping at the first failure. */
+    static bool RunChecks(std::vector<T>& vChecks, typename CheckQueueBatch<T>::type& batch)
+    {
+        bool fOk = true;
+        if constexpr (CheckQueueBatch<T>::enabled) {
+            for (T& check : vChecks)
+                if (fOk)
+                    fOk = check(batch);
+            if (fOk && batch.Verify()) return true;
+            batch.Reset();
+            if (!fOk) return false;
+            // Some deferred work failed; run the checks individually to find out which one.
+            fOk = true;
+        }
+        for (T& check : vChecks)
+            if (fOk)
+                fOk = check();
+        return fOk;
+    }
+
     /** Internal function that does bulk of the verification work. */
-    bool Loop(bool fMaster) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    bool Loop(bool fMaster, size_t self) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
     {
-        std::condition_variable& cond = fMaster ? m_master_cv : m_worker_cv;
         std::vector<T> vChecks;
         vChecks.reserve(nBatchSize);
-        unsigned int nNow = 0;
-        bool fOk = true;
+        typename CheckQueueBatch<T>::type batch;
         do {
-            {
-                WAIT_LOCK(m_mutex, lock);
-                // first do the clean-up of the previous loop run (allowing us to do it in the same critsect)
-                if (nNow) {
-                    fAllOk &= fOk;
-                    nTodo -= nNow;
-                    if (nTodo == 0 && !fMaster)
-                        // We processed the last element; inform the master it can exit and return the result
-                        m_master_cv.notify_one();
-                } else {
-                    // first iteration
-                    nTotal++;
-                }
-                // logically, the do loop starts here
-                while (queue.empty() && !m_request_stop) {
-                    if (fMaster && nTodo == 0) {
-                        nTotal--;
-                        bool fRet = fAllOk;
-                        // reset the status for new work later
-                        fAllOk = true;
-                        // return the current status
-                        return fRet;
-                    }
-                    nIdle++;
-                    cond.wait(lock); // wait
-                    nIdle--;
+            if (TakeChecks(self, vChecks)) {
+                // Check whether we need to do work at all
+                bool fOk = m_all_ok.load(std::memory_order_relaxed);
+                if (fOk) fOk = RunChecks(vChecks, batch);
+                const unsigned int nNow = vChecks.size();
+                // Destroy the checks before reporting them as done, so the
+                // master cannot return while any of them is still alive.
+                vChecks.clear();
+                if (!fOk) m_all_ok = false;
+                if (m_todo.fetch_sub(nNow) == nNow && !fMaster) {
+                    // We processed the last element; inform the master it can exit and return the result
+                    { LOCK(m_mutex); }
+                    m_master_cv.notify_one();
                 }
+                continue;
+            }
+
+            // Checks that were counted by Add() may not be visible yet; look again.
+            if (m_queued > 0) {
+                std::this_thread::yield();
+                continue;
+            }
+
+            WAIT_LOCK(m_mutex, lock);
+            if (fMaster) {
+                // Nothing left to take: wait for the other participants to finish their batches.
+                m_master_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_todo == 0 || m_request_stop; });
                 if (m_request_stop) {
                     return false;
                 }
-
-                // Decide how many work units to process now.
-                // * Do not try to do everything at once, but aim for increasingly smaller batches so
-                //   all workers finish approximately simultaneously.
-                // * Try to account for idle jobs which will instantly start helping.
-                // * Don't do batches smaller than 1 (duh), or larger than nBatchSize.
-                nNow = std::max(1U, std::min(nBatchSize, (unsigned int)queue.size() / (nTotal + nIdle + 1)));
-                auto start_it = queue.end() - nNow;
-                vChecks.assign(std::make_move_iterator(start_it), std::make_move_iterator(queue.end()));
-                queue.erase(start_it, queue.end());
-                // Check whether we need to do work at all
-                fOk = fAllOk;
+                // reset the status for new work later, and return the current status
+                return m_all_ok.exchange(true);
+            }
+            m_worker_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_queued > 0 || m_request_stop; });
+            if (m_request_stop) {
+                return false;
             }
-            // execute work
-            for (T& check : vChecks)
-                if (fOk)
-                    fOk = check();
-            vChecks.clear();
         } while (true);
     }
 
+    //! (Re)create the work queues for the given number of worker threads, plus the master.
+    void ResetWorkQueues(int threads_num)
+    {
+        m_queues.clear();
+        for (int n = 0; n <= threads_num; ++n) {
+            m_queues.push_back(std::make_unique<WorkQueue>());
+        }
+        m_next_queue = 0;
+    }
+
 public:
     //! Mutex to ensure only one concurrent CCheckQueueControl
     Mutex m_control_mutex;
 
     //! Create a new check queue
-    explicit CCheckQueue(unsigned int nBatchSizeIn)
-        : nBatchSize(nBatchSizeIn)
+    explicit CCheckQueue(unsigned int nBatchSizeIn, std::string thread_name = "scriptch")
+        : nBatchSize(nBatchSizeIn), m_thread_name(std::move(thread_name))
     {
+        ResetWorkQueues(0);
     }
 
     //! Create a pool of new worker threads.
     void StartWorkerThreads(const int threads_num) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
     {
-        {
-            LOCK(m_mutex);
-            nIdle = 0;
-            nTotal = 0;
-            fAllOk = true;
-        }
         assert(m_worker_threads.empty());
+        ResetWorkQueues(threads_num);
+        m_all_ok = true;
         for (int n = 0; n < threads_num; ++n) {
             m_worker_threads.emplace_back([this, n]() {
-                util::ThreadRename(strprintf("scriptch.%i", n));
+                util::ThreadRename(strprintf("%s.%i", m_thread_name, n));
                 SetSyscallSandboxPolicy(SyscallSandboxPolicy::VALIDATION_SCRIPT_CHECK);
-                Loop(false /* worker thread */);
+                Loop(false /* worker thread */, n);
             });
         }
     }
@@ -158,7 +247,7 @@ public:
     //! Wait until execution finishes, and return whether all evaluations were successful.
     bool Wait() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
     {
-        return Loop(true /* master thread */);
+        return Loop(true /* master thread */, m_queues.size() - 1);
     }
 
     //! Add a batch of checks to the queue
@@ -168,12 +257,25 @@ public:
             return;
         }
 
-        {
-            LOCK(m_mutex);
-            queue.insert(queue.end(), std::make_move_iterator(vChecks.begin()), std::make_move_iterator(vChecks.end()));
-            nTodo += vChecks.size();
+        // Account for the checks before they become visible, so that
+        // participants taking them can never observe a negative count.
+        m_todo += vChecks.size();
+        m_queued += vChecks.size();
+
+        // Spread the checks over the work queues in contiguous chunks.
+        const size_t n_queues{m_queues.size()};
+        const size_t chunk{std::max<size_t>(1, std::min<size_t>(nBatchSize, (vChecks.size() + n_queues - 1) / n_queues))};
+        for (auto it = vChecks.begin(); it != vChecks.end();) {
+            const auto chunk_end{it + std::min<size_t>(chunk, vChecks.end() - it)};
+            WorkQueue& wq{*m_queues[m_next_queue]};
+            m_next_queue = (m_next_queue + 1) % n_queues;
+            LOCK(wq.m_mutex);
+            wq.m_checks.insert(wq.m_checks.end(), std::make_move_iterator(it), std::make_move_iterator(chunk_end));
+            it = chunk_end;
         }
 
+        // Synchronize with workers deciding to go to sleep, so the wake-up cannot be missed.
+        { LOCK(m_mutex); }
         if (vChecks.size() == 1) {
             m_worker_cv.notify_one();
         } else {
@@ -190,6 +292,7 @@ public:
             t.join();
         }
         m_worker_threads.clear();
+        ResetWorkQueues(0);
         WITH_LOCK(m_mutex, m_request_stop = false);
     }
 
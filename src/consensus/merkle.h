@@ -12,6 +12,17 @@
 
 uint256 ComputeMerkleRoot(std::vector<uint256> hashes, bool* mutated = nullptr);
 
+/*
+ * Compute the root of a subtree of the given height, as it appears inside a
+ * larger Merkle tree. hashes must hold between 1 and 2^height leaves; a
+ * subtree with fewer leaves is completed the way ComputeMerkleRoot completes
+ * odd levels, by repeating the last node. The subtree roots of consecutive
+ * runs of 2^height leaves combine with ComputeMerkleRoot into the root of the
+ * whole tree.
+ * *mutated is set to true if a duplicated subtree was found.
+ */
+uint256 ComputeMerkleSubtreeRoot(std::vector<uint256> hashes, unsigned int height, bool* mutated = nullptr);
+
 /*
  * Compute the Merkle root of the transactions in a block.
  * *mutated is set to true if a duplicated subtree was found.
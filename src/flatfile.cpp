@@ -10,6 +10,13 @@
 #include <tinyformat.h>
 #include <util/fs_helpers.h>
 
+#ifndef WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 FlatFileSeq::FlatFileSeq(fs::path dir, const char* prefix, size_t chunk_size) :
     m_dir(std::move(dir)),
     m_prefix(prefix),
@@ -52,6 +59,48 @@ FILE* FlatFileSeq::Open(const FlatFilePos& pos, bool read_only)
     return file;
 }
 
+std::shared_ptr<const FlatFileMapping> FlatFileSeq::Map(const FlatFilePos& pos) const
+{
+    if (pos.IsNull()) {
+        return nullptr;
+    }
+    auto mapping{std::make_shared<const FlatFileMapping>(FileName(pos))};
+    if (mapping->IsNull()) {
+        return nullptr;
+    }
+    return mapping;
+}
+
+FlatFileMapping::FlatFileMapping(const fs::path& path)
+{
+#ifndef WIN32
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd == -1) {
+        return;
+    }
+    struct stat st;
+    if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+        void* addr = ::mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (addr != MAP_FAILED) {
+            m_data = static_cast<const unsigned char*>(addr);
+            m_size = st.st_size;
+        } else {
+            LogPrintf("Unable to map file %s\n", fs::PathToString(path));
+        }
+    }
+    ::close(fd);
+#endif
+}
+
+FlatFileMapping::~FlatFileMapping()
+{
+#ifndef WIN32
+    if (m_data) {
+        ::munmap(const_cast<unsigned char*>(m_data), m_size);
+    }
+#endif
+}
+
 size_t FlatFileSeq::Allocate(const FlatFilePos& pos, size_t add_size, bool& out_of_space)
 {
     out_of_space = false;
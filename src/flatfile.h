@@ -6,9 +6,11 @@
 #ifndef BITCOIN_FLATFILE_H
 #define BITCOIN_FLATFILE_H
 
+#include <memory>
 #include <string>
 
 #include <serialize.h>
+#include <span.h>
 #include <util/fs.h>
 
 struct FlatFilePos
@@ -38,6 +40,29 @@ struct FlatFilePos
     std::string ToString() const;
 };
 
+/**
+ * A read-only memory mapping of a whole file. Only the bytes that were part of the file when the
+ * mapping was created can be accessed, and the file must not be truncated while it is mapped.
+ */
+class FlatFileMapping
+{
+private:
+    const unsigned char* m_data{nullptr};
+    size_t m_size{0};
+
+public:
+    /** Map the file at the given path. On failure, or on platforms without mmap, the mapping is null. */
+    explicit FlatFileMapping(const fs::path& path);
+    ~FlatFileMapping();
+
+    FlatFileMapping(const FlatFileMapping&) = delete;
+    FlatFileMapping& operator=(const FlatFileMapping&) = delete;
+
+    bool IsNull() const { return m_data == nullptr; }
+
+    Span<const unsigned char> Data() const { return {m_data, m_size}; }
+};
+
 /**
  * FlatFileSeq represents a sequence of numbered files storing raw data. This class facilitates
  * access to and efficient management of these files.
@@ -65,6 +90,9 @@ public:
     /** Open a handle to the file at the given position. */
     FILE* Open(const FlatFilePos& pos, bool read_only = false);
 
+    /** Map the file at the given position read-only. Returns nullptr if it cannot be mapped. */
+    std::shared_ptr<const FlatFileMapping> Map(const FlatFilePos& pos) const;
+
     /**
      * Allocate additional space in a file after the given starting position. The amount allocated
      * will be the minimum multiple of the sequence chunk size greater than add_size.
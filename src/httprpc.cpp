@@ -6,6 +6,7 @@
 
 #include <crypto/hmac_sha256.h>
 #include <httpserver.h>
+#include <rpc/jsonstream.h>
 #include <rpc/protocol.h>
 #include <rpc/server.h>
 #include <util/strencodings.h>
@@ -198,6 +199,23 @@ static bool HTTPReq_JSONRPC(const std::any& context, HTTPRequest* req)
                 req->WriteReply(HTTP_FORBIDDEN);
                 return false;
             }
+            if (RPCResultWriter result_writer = tableRPC.prepareStream(jreq)) {
+                // Write the reply into the response buffer while it is
+                // generated, in the same format as JSONRPCReply()
+                req->WriteHeader("Content-Type", "application/json");
+                {
+                    JSONStreamWriter writer{[req](Span<const char> data) { req->WriteReplyBody(MakeByteSpan(data)); }};
+                    writer.BeginObject();
+                    writer.Key("result");
+                    result_writer(writer);
+                    writer.KeyValue("error", NullUniValue);
+                    writer.KeyValue("id", jreq.id);
+                    writer.EndObject();
+                    writer.Raw("\n");
+                }
+                req->WriteReply(HTTP_OK);
+                return true;
+            }
             UniValue result = tableRPC.execute(jreq);
 
             // Send reply
@@ -291,6 +309,29 @@ static bool InitRPCAuthentication()
     return true;
 }
 
+/** Bodies larger than this are not inspected to pick a -rpclane (parsing happens on the event loop thread) */
+static constexpr size_t MAX_ROUTED_BODY_SIZE{64 * 1024};
+
+/** Route a JSON-RPC request by its method. A batch is routed by its method if
+ * all its elements call the same one. */
+static std::string RPCMethodRoute(HTTPRequest* req)
+{
+    UniValue request;
+    if (!request.read(req->PeekBody(MAX_ROUTED_BODY_SIZE))) return {};
+
+    const auto method_of = [](const UniValue& call) -> std::string {
+        const UniValue& method{find_value(call, "method")};
+        return method.isStr() ? method.get_str() : std::string{};
+    };
+    if (!request.isArray()) return method_of(request);
+    if (request.empty()) return {};
+    std::string route{method_of(request[0])};
+    for (size_t i = 1; i < request.size(); ++i) {
+        if (method_of(request[i]) != route) return {};
+    }
+    return route;
+}
+
 bool StartHTTPRPC(const std::any& context)
 {
     LogPrint(BCLog::RPC, "Starting HTTP RPC server\n");
@@ -298,9 +339,9 @@ bool StartHTTPRPC(const std::any& context)
         return false;
 
     auto handle_rpc = [context](HTTPRequest* req, const std::string&) { return HTTPReq_JSONRPC(context, req); };
-    RegisterHTTPHandler("/", true, handle_rpc);
+    RegisterHTTPHandler("/", true, handle_rpc, RPCMethodRoute);
     if (g_wallet_init_interface.HasWalletSupport()) {
-        RegisterHTTPHandler("/wallet/", false, handle_rpc);
+        RegisterHTTPHandler("/wallet/", false, handle_rpc, RPCMethodRoute);
     }
     struct event_base* eventBase = EventBase();
     assert(eventBase);
@@ -16,15 +16,18 @@
 #include <shutdown.h>
 #include <sync.h>
 #include <util/strencodings.h>
+#include <util/string.h>
 #include <util/syscall_sandbox.h>
 #include <util/system.h>
 #include <util/threadnames.h>
+#include <util/time.h>
 #include <util/translation.h>
 
 #include <condition_variable>
 #include <cstdio>
 #include <cstdlib>
 #include <deque>
+#include <map>
 #include <memory>
 #include <optional>
 #include <string>
@@ -75,9 +78,13 @@ class WorkQueue
 private:
     Mutex cs;
     std::condition_variable cond GUARDED_BY(cs);
-    std::deque<std::unique_ptr<WorkItem>> queue GUARDED_BY(cs);
+    std::deque<std::pair<std::unique_ptr<WorkItem>, SteadyClock::time_point>> queue GUARDED_BY(cs);
     bool running GUARDED_BY(cs){true};
     const size_t maxDepth;
+    uint64_t m_processed GUARDED_BY(cs){0};
+    uint64_t m_rejected GUARDED_BY(cs){0};
+    std::chrono::microseconds m_total_wait GUARDED_BY(cs){0};
+    std::chrono::microseconds m_max_wait GUARDED_BY(cs){0};
 
 public:
     explicit WorkQueue(size_t _maxDepth) : maxDepth(_maxDepth)
@@ -91,9 +98,10 @@ public:
     {
         LOCK(cs);
         if (!running || queue.size() >= maxDepth) {
+            ++m_rejected;
             return false;
         }
-        queue.emplace_back(std::unique_ptr<WorkItem>(item));
+        queue.emplace_back(std::unique_ptr<WorkItem>(item), SteadyClock::now());
         cond.notify_one();
         return true;
     }
@@ -108,7 +116,11 @@ public:
                     cond.wait(lock);
                 if (!running && queue.empty())
                     break;
-                i = std::move(queue.front());
+                const auto wait{std::chrono::duration_cast<std::chrono::microseconds>(SteadyClock::now() - queue.front().second)};
+                ++m_processed;
+                m_total_wait += wait;
+                m_max_wait = std::max(m_max_wait, wait);
+                i = std::move(queue.front().first);
                 queue.pop_front();
             }
             (*i)();
@@ -121,17 +133,37 @@ public:
         running = false;
         cond.notify_all();
     }
+    /** Fill in the queue part of stats */
+    void GetStats(HTTPWorkQueueStats& stats) EXCLUSIVE_LOCKS_REQUIRED(!cs)
+    {
+        LOCK(cs);
+        stats.depth = queue.size();
+        stats.max_depth = maxDepth;
+        stats.processed = m_processed;
+        stats.rejected = m_rejected;
+        stats.total_wait = m_total_wait;
+        stats.max_wait = m_max_wait;
+    }
 };
 
 struct HTTPPathHandler
 {
-    HTTPPathHandler(std::string _prefix, bool _exactMatch, HTTPRequestHandler _handler):
-        prefix(_prefix), exactMatch(_exactMatch), handler(_handler)
+    HTTPPathHandler(std::string _prefix, bool _exactMatch, HTTPRequestHandler _handler, HTTPRouteSelector _route_selector):
+        prefix(_prefix), exactMatch(_exactMatch), handler(_handler), route_selector(_route_selector)
     {
     }
     std::string prefix;
     bool exactMatch;
     HTTPRequestHandler handler;
+    HTTPRouteSelector route_selector;
+};
+
+/** Work queue with its own worker threads */
+struct HTTPLane
+{
+    std::string name;
+    int threads;
+    std::unique_ptr<WorkQueue<HTTPClosure>> queue;
 };
 
 /** HTTP module state */
@@ -144,6 +176,10 @@ static struct evhttp* eventHTTP = nullptr;
 static std::vector<CSubNet> rpc_allow_subnets;
 //! Work queue for handling longer requests off the event loop thread
 static std::unique_ptr<WorkQueue<HTTPClosure>> g_work_queue{nullptr};
+//! Additional work queues configured with -rpclane
+static std::vector<HTTPLane> g_lanes;
+//! Work queue for each route assigned to a lane
+static std::map<std::string, WorkQueue<HTTPClosure>*> g_lane_routes;
 //! Handlers for (sub)paths
 static GlobalMutex g_httppathhandlers_mutex;
 static std::vector<HTTPPathHandler> pathHandlers GUARDED_BY(g_httppathhandlers_mutex);
@@ -276,9 +312,14 @@ static void http_request_cb(struct evhttp_request* req, void* arg)
 
     // Dispatch to worker thread
     if (i != iend) {
-        std::unique_ptr<HTTPWorkItem> item(new HTTPWorkItem(std::move(hreq), path, i->handler));
         assert(g_work_queue);
-        if (g_work_queue->Enqueue(item.get())) {
+        WorkQueue<HTTPClosure>* queue{g_work_queue.get()};
+        if (i->route_selector && !g_lane_routes.empty()) {
+            const auto route{g_lane_routes.find(i->route_selector(hreq.get()))};
+            if (route != g_lane_routes.end()) queue = route->second;
+        }
+        std::unique_ptr<HTTPWorkItem> item(new HTTPWorkItem(std::move(hreq), path, i->handler));
+        if (queue->Enqueue(item.get())) {
             item.release(); /* if true, queue took ownership */
         } else {
             LogPrintf("WARNING: request rejected because http work queue depth exceeded, it can be increased with the -rpcworkqueue= setting\n");
@@ -350,9 +391,9 @@ static bool HTTPBindAddresses(struct evhttp* http)
 }
 
 /** Simple wrapper to set thread name and run work queue */
-static void HTTPWorkQueueRun(WorkQueue<HTTPClosure>* queue, int worker_num)
+static void HTTPWorkQueueRun(WorkQueue<HTTPClosure>* queue, std::string thread_name)
 {
-    util::ThreadRename(strprintf("httpworker.%i", worker_num));
+    util::ThreadRename(std::move(thread_name));
     SetSyscallSandboxPolicy(SyscallSandboxPolicy::NET_HTTP_SERVER_WORKER);
     queue->Run();
 }
@@ -378,6 +419,29 @@ static void libevent_log_cb(int severity, const char *msg)
     LogPrintLevel(BCLog::LIBEVENT, level, "%s\n", msg);
 }
 
+/** Create the work queues configured with -rpclane=<name>:<threads>:<route>[,<route>...] */
+static bool InitHTTPLanes(size_t depth)
+{
+    g_lanes.clear();
+    g_lane_routes.clear();
+    for (const std::string& lane_arg : gArgs.GetArgs("-rpclane")) {
+        const std::vector<std::string> parts{SplitString(lane_arg, ':')};
+        int threads{0};
+        if (parts.size() != 3 || parts[0].empty() || !ParseInt32(parts[1], &threads) || threads < 1) {
+            uiInterface.ThreadSafeMessageBox(
+                strprintf(Untranslated("Invalid -rpclane specification: %s. The format is <name>:<threads>:<method>[,<method>...]."), lane_arg),
+                "", CClientUIInterface::MSG_ERROR);
+            return false;
+        }
+        HTTPLane& lane{g_lanes.emplace_back(HTTPLane{parts[0], threads, std::make_unique<WorkQueue<HTTPClosure>>(depth)})};
+        for (const std::string& route : SplitString(parts[2], ',')) {
+            if (!route.empty()) g_lane_routes[route] = lane.queue.get();
+        }
+        LogPrintfCategory(BCLog::HTTP, "creating work queue %s of depth %d\n", lane.name, depth);
+    }
+    return true;
+}
+
 bool InitHTTPServer()
 {
     if (!InitHTTPAllowList())
@@ -419,6 +483,9 @@ bool InitHTTPServer()
     LogPrintfCategory(BCLog::HTTP, "creating work queue of depth %d\n", workQueueDepth);
 
     g_work_queue = std::make_unique<WorkQueue<HTTPClosure>>(workQueueDepth);
+    if (!InitHTTPLanes(workQueueDepth)) {
+        return false;
+    }
     // transfer ownership to eventBase/HTTP via .release()
     eventBase = base_ctr.release();
     eventHTTP = http_ctr.release();
@@ -444,7 +511,13 @@ void StartHTTPServer()
     g_thread_http = std::thread(ThreadHTTP, eventBase);
 
     for (int i = 0; i < rpcThreads; i++) {
-        g_thread_http_workers.emplace_back(HTTPWorkQueueRun, g_work_queue.get(), i);
+        g_thread_http_workers.emplace_back(HTTPWorkQueueRun, g_work_queue.get(), strprintf("httpworker.%i", i));
+    }
+    for (const HTTPLane& lane : g_lanes) {
+        LogPrintfCategory(BCLog::HTTP, "starting %d worker threads for %s\n", lane.threads, lane.name);
+        for (int i = 0; i < lane.threads; i++) {
+            g_thread_http_workers.emplace_back(HTTPWorkQueueRun, lane.queue.get(), strprintf("http.%s.%i", lane.name, i));
+        }
     }
 }
 
@@ -458,6 +531,9 @@ void InterruptHTTPServer()
     if (g_work_queue) {
         g_work_queue->Interrupt();
     }
+    for (const HTTPLane& lane : g_lanes) {
+        lane.queue->Interrupt();
+    }
 }
 
 void StopHTTPServer()
@@ -501,9 +577,28 @@ void StopHTTPServer()
         eventBase = nullptr;
     }
     g_work_queue.reset();
+    g_lane_routes.clear();
+    g_lanes.clear();
     LogPrint(BCLog::HTTP, "Stopped HTTP server\n");
 }
 
+std::vector<HTTPWorkQueueStats> GetHTTPWorkQueueStats()
+{
+    std::vector<HTTPWorkQueueStats> stats;
+    if (!g_work_queue) return stats;
+    HTTPWorkQueueStats& default_stats{stats.emplace_back()};
+    default_stats.name = "default";
+    default_stats.threads = std::max((long)gArgs.GetIntArg("-rpcthreads", DEFAULT_HTTP_THREADS), 1L);
+    g_work_queue->GetStats(default_stats);
+    for (const HTTPLane& lane : g_lanes) {
+        HTTPWorkQueueStats& lane_stats{stats.emplace_back()};
+        lane_stats.name = lane.name;
+        lane_stats.threads = lane.threads;
+        lane.queue->GetStats(lane_stats);
+    }
+    return stats;
+}
+
 struct event_base* EventBase()
 {
     return eventBase;
@@ -541,7 +636,11 @@ HTTPRequest::HTTPRequest(struct evhttp_request* _req, bool _replySent) : req(_re
 
 HTTPRequest::~HTTPRequest()
 {
-    if (!replySent) {
+    if (!replySent && m_chunked) {
+        // The status was already sent, so only the body can be cut short
+        LogPrintf("%s: Unfinished chunked reply\n", __func__);
+        EndChunkedReply();
+    } else if (!replySent) {
         // Keep track of whether reply was sent to avoid request leaks
         LogPrintf("%s: Unhandled request\n", __func__);
         WriteReply(HTTP_INTERNAL_SERVER_ERROR, "Unhandled request");
@@ -580,6 +679,20 @@ std::string HTTPRequest::ReadBody()
     return rv;
 }
 
+std::string HTTPRequest::PeekBody(size_t max_size) const
+{
+    struct evbuffer* buf = evhttp_request_get_input_buffer(req);
+    if (!buf)
+        return "";
+    size_t size = evbuffer_get_length(buf);
+    if (size > max_size)
+        return "";
+    const char* data = (const char*)evbuffer_pullup(buf, size);
+    if (!data)
+        return "";
+    return std::string(data, size);
+}
+
 void HTTPRequest::WriteHeader(const std::string& hdr, const std::string& value)
 {
     struct evkeyvalq* headers = evhttp_request_get_output_headers(req);
@@ -587,12 +700,36 @@ void HTTPRequest::WriteHeader(const std::string& hdr, const std::string& value)
     evhttp_add_header(headers, hdr.c_str(), value.c_str());
 }
 
+void HTTPRequest::WriteReplyBody(Span<const std::byte> data)
+{
+    assert(!replySent && req);
+    struct evbuffer* evb = evhttp_request_get_output_buffer(req);
+    assert(evb);
+    evbuffer_add(evb, data.data(), data.size());
+}
+
+/** Re-enable reading from the socket after a reply was sent. This is the
+ * second part of the libevent workaround in http_request_cb.
+ */
+static void ReenableReading(evhttp_request* req)
+{
+    if (event_get_version_number() >= 0x02010600 && event_get_version_number() < 0x02020001) {
+        evhttp_connection* conn = evhttp_request_get_connection(req);
+        if (conn) {
+            bufferevent* bev = evhttp_connection_get_bufferevent(conn);
+            if (bev) {
+                bufferevent_enable(bev, EV_READ | EV_WRITE);
+            }
+        }
+    }
+}
+
 /** Closure sent to main thread to request a reply to be sent to
  * a HTTP request.
  * Replies must be sent in the main loop in the main http thread,
  * this cannot be done from worker threads.
  */
-void HTTPRequest::WriteReply(int nStatus, const std::string& strReply)
+void HTTPRequest::WriteReply(int nStatus, Span<const std::byte> reply)
 {
     assert(!replySent && req);
     if (ShutdownRequested()) {
@@ -601,23 +738,120 @@ void HTTPRequest::WriteReply(int nStatus, const std::string& strReply)
     // Send event to main http thread to send reply message
     struct evbuffer* evb = evhttp_request_get_output_buffer(req);
     assert(evb);
-    evbuffer_add(evb, strReply.data(), strReply.size());
+    evbuffer_add(evb, reply.data(), reply.size());
     auto req_copy = req;
     HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy, nStatus]{
         evhttp_send_reply(req_copy, nStatus, nullptr, nullptr);
-        // Re-enable reading from the socket. This is the second part of the libevent
-        // workaround above.
-        if (event_get_version_number() >= 0x02010600 && event_get_version_number() < 0x02020001) {
-            evhttp_connection* conn = evhttp_request_get_connection(req_copy);
-            if (conn) {
-                bufferevent* bev = evhttp_connection_get_bufferevent(conn);
-                if (bev) {
-                    bufferevent_enable(bev, EV_READ | EV_WRITE);
-                }
-            }
+        ReenableReading(req_copy);
+    });
+    ev->trigger(nullptr);
+    replySent = true;
+    req = nullptr; // transferred back to main thread
+}
+
+/** State of a chunked reply, shared between the worker generating it and the
+ * http thread sending it.
+ */
+struct HTTPRequest::ChunkedReply {
+    Mutex m_mutex;
+    std::condition_variable m_cv;
+    //! Bytes passed to the http thread that are not yet written to the socket
+    size_t m_unsent GUARDED_BY(m_mutex){0};
+    //! Part of m_unsent that is in the output buffer of the connection
+    size_t m_buffered GUARDED_BY(m_mutex){0};
+    //! Whether the connection was closed
+    bool m_closed GUARDED_BY(m_mutex){false};
+
+    /** Called by libevent when the output buffer of the connection is empty */
+    static void OnWritten(evhttp_connection*, void* arg)
+    {
+        auto chunked{static_cast<ChunkedReply*>(arg)};
+        {
+            LOCK(chunked->m_mutex);
+            chunked->m_unsent -= chunked->m_buffered;
+            chunked->m_buffered = 0;
+        }
+        chunked->m_cv.notify_all();
+    }
+
+    /** Called by libevent when the connection is closed */
+    static void OnClosed(evhttp_connection*, void* arg)
+    {
+        auto chunked{static_cast<ChunkedReply*>(arg)};
+        WITH_LOCK(chunked->m_mutex, chunked->m_closed = true);
+        chunked->m_cv.notify_all();
+    }
+};
+
+void HTTPRequest::StartChunkedReply(int nStatus)
+{
+    assert(!replySent && req && !m_chunked);
+    if (ShutdownRequested()) {
+        WriteHeader("Connection", "close");
+    }
+    m_chunked = std::make_shared<ChunkedReply>();
+    auto req_copy = req;
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy, chunked = m_chunked, nStatus]{
+        evhttp_connection* conn = evhttp_request_get_connection(req_copy);
+        if (!conn) {
+            ChunkedReply::OnClosed(nullptr, chunked.get());
+            return;
+        }
+        // Unset again by EndChunkedReply, while the state is still alive
+        evhttp_connection_set_closecb(conn, ChunkedReply::OnClosed, chunked.get());
+        evhttp_send_reply_start(req_copy, nStatus, nullptr);
+    });
+    ev->trigger(nullptr);
+}
+
+bool HTTPRequest::WriteReplyChunk(Span<const std::byte> data)
+{
+    assert(!replySent && req && m_chunked);
+    {
+        WAIT_LOCK(m_chunked->m_mutex, lock);
+        // Shutdown is not signalled through the condition variable, so poll
+        // for it in case the client stopped reading.
+        while (!m_chunked->m_cv.wait_for(lock, std::chrono::seconds{1}, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_chunked->m_mutex) {
+            return m_chunked->m_closed || m_chunked->m_unsent < MAX_UNSENT_REPLY_BYTES || ShutdownRequested();
+        })) {}
+        if (m_chunked->m_closed || ShutdownRequested()) return false;
+        m_chunked->m_unsent += data.size();
+    }
+    struct evbuffer* evb = evbuffer_new();
+    assert(evb);
+    evbuffer_add(evb, data.data(), data.size());
+    auto req_copy = req;
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy, chunked = m_chunked, evb]{
+        const size_t size{evbuffer_get_length(evb)};
+        if (evhttp_request_get_connection(req_copy)) {
+            WITH_LOCK(chunked->m_mutex, chunked->m_buffered += size);
+            evhttp_send_reply_chunk_with_cb(req_copy, evb, ChunkedReply::OnWritten, chunked.get());
+        }
+        evbuffer_free(evb);
+    });
+    ev->trigger(nullptr);
+    return true;
+}
+
+void HTTPRequest::EndChunkedReply()
+{
+    assert(!replySent && req && m_chunked);
+    auto req_copy = req;
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy, chunked = m_chunked]{
+        evhttp_connection* conn = evhttp_request_get_connection(req_copy);
+        if (conn) {
+            evhttp_connection_set_closecb(conn, nullptr, nullptr);
+        } else {
+            // The connection is gone, so evhttp_send_reply_end frees the
+            // request without calling the on-complete callback.
+            WITH_LOCK(g_requests_mutex, g_requests.erase(req_copy));
+            g_requests_cv.notify_all();
         }
+        evhttp_send_reply_end(req_copy);
+        if (conn) ReenableReading(req_copy);
     });
     ev->trigger(nullptr);
+    m_chunked.reset();
     replySent = true;
     req = nullptr; // transferred back to main thread
 }
@@ -697,11 +931,11 @@ std::optional<std::string> GetQueryParameterFromUri(const char* uri, const std::
     return result;
 }
 
-void RegisterHTTPHandler(const std::string &prefix, bool exactMatch, const HTTPRequestHandler &handler)
+void RegisterHTTPHandler(const std::string &prefix, bool exactMatch, const HTTPRequestHandler &handler, const HTTPRouteSelector& route_selector)
 {
     LogPrint(BCLog::HTTP, "Registering HTTP handler for %s (exactmatch %d)\n", prefix, exactMatch);
     LOCK(g_httppathhandlers_mutex);
-    pathHandlers.push_back(HTTPPathHandler(prefix, exactMatch, handler));
+    pathHandlers.push_back(HTTPPathHandler(prefix, exactMatch, handler, route_selector));
 }
 
 void UnregisterHTTPHandler(const std::string &prefix, bool exactMatch)
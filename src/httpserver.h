@@ -5,9 +5,15 @@
 #ifndef BITCOIN_HTTPSERVER_H
 #define BITCOIN_HTTPSERVER_H
 
+#include <chrono>
+#include <cstdint>
 #include <functional>
+#include <memory>
 #include <optional>
 #include <string>
+#include <vector>
+
+#include <span.h>
 
 static const int DEFAULT_HTTP_THREADS=4;
 static const int DEFAULT_HTTP_WORKQUEUE=128; // was (16)
@@ -37,14 +43,35 @@ void UpdateHTTPServerLogging(bool enable);
 
 /** Handler for requests to a certain HTTP path */
 typedef std::function<bool(HTTPRequest* req, const std::string &)> HTTPRequestHandler;
+/** Return the route of a request (e.g. its RPC method), which determines the
+ * work queue that handles it. Called on the event loop thread, and only if any
+ * -rpclane is configured, so it must be cheap and must not consume the request. */
+typedef std::function<std::string(HTTPRequest* req)> HTTPRouteSelector;
 /** Register handler for prefix.
  * If multiple handlers match a prefix, the first-registered one will
- * be invoked.
+ * be invoked. Requests are handled by the default work queue unless
+ * route_selector returns a route assigned to another one with -rpclane.
  */
-void RegisterHTTPHandler(const std::string &prefix, bool exactMatch, const HTTPRequestHandler &handler);
+void RegisterHTTPHandler(const std::string &prefix, bool exactMatch, const HTTPRequestHandler &handler, const HTTPRouteSelector& route_selector = nullptr);
 /** Unregister handler for prefix */
 void UnregisterHTTPHandler(const std::string &prefix, bool exactMatch);
 
+/** Statistics of an HTTP work queue */
+struct HTTPWorkQueueStats {
+    std::string name;
+    int threads;
+    size_t depth;
+    size_t max_depth;
+    uint64_t processed;
+    uint64_t rejected;
+    //! Time requests spent queued before a worker picked them up
+    std::chrono::microseconds total_wait;
+    std::chrono::microseconds max_wait;
+};
+
+/** Get statistics of the default work queue and those added with -rpclane */
+std::vector<HTTPWorkQueueStats> GetHTTPWorkQueueStats();
+
 /** Return evhttp event base. This can be used by submodules to
  * queue timers or custom events.
  */
@@ -58,6 +85,8 @@ class HTTPRequest
 private:
     struct evhttp_request* req;
     bool replySent;
+    struct ChunkedReply;
+    std::shared_ptr<ChunkedReply> m_chunked;
 
 public:
     explicit HTTPRequest(struct evhttp_request* req, bool replySent = false);
@@ -108,6 +137,12 @@ public:
      */
     std::string ReadBody();
 
+    /**
+     * Read request body without consuming it, or an empty string if it is
+     * larger than max_size.
+     */
+    std::string PeekBody(size_t max_size) const;
+
     /**
      * Write output header.
      *
@@ -123,7 +158,47 @@ public:
      * @note Can be called only once. As this will give the request back to the
      * main thread, do not call any other HTTPRequest methods after calling this.
      */
-    void WriteReply(int nStatus, const std::string& strReply = "");
+    void WriteReply(int nStatus, const std::string& strReply = "")
+    {
+        WriteReply(nStatus, MakeByteSpan(strReply));
+    }
+    void WriteReply(int nStatus, Span<const std::byte> reply);
+
+    /**
+     * Append to the body of the reply while it is being generated, without
+     * collecting it in a string first. The data is sent by WriteReply(),
+     * before the reply passed to it.
+     */
+    void WriteReplyBody(Span<const std::byte> data);
+
+    /**
+     * Start a reply with chunked transfer encoding, for replies that are too
+     * large to be collected in memory. Send the body with WriteReplyChunk()
+     * and finish the reply with EndChunkedReply().
+     */
+    void StartChunkedReply(int nStatus);
+
+    /**
+     * Send a chunk of a reply started with StartChunkedReply(). Blocks while
+     * more than MAX_UNSENT_REPLY_BYTES of the reply are waiting to be written
+     * to the client, so the reply is generated no faster than it is sent.
+     *
+     * @returns false if the client went away or the server is shutting down,
+     * in which case the caller should stop generating the reply and call
+     * EndChunkedReply().
+     */
+    bool WriteReplyChunk(Span<const std::byte> data);
+
+    /**
+     * Finish a reply started with StartChunkedReply().
+     *
+     * @note As this will give the request back to the main thread, do not
+     * call any other HTTPRequest methods after calling this.
+     */
+    void EndChunkedReply();
+
+    //! Maximum amount of a chunked reply that is generated but not yet sent
+    static constexpr size_t MAX_UNSENT_REPLY_BYTES{4 * 1024 * 1024};
 };
 
 /** Get the query parameter value from request uri for a specified key, or std::nullopt if the key
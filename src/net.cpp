@@ -686,9 +686,14 @@ bool CNode::ReceiveMsgBytes(Span<const uint8_t> msg_bytes, bool& complete)
         }
 
         if (m_deserializer->Complete()) {
-            // decompose a transport agnostic CNetMessage from the deserializer
+            // decompose a transport agnostic CNetMessage from the deserializer,
+            // into a message already processed if there is one to reuse
+            if (m_recv_spare.empty()) {
+                m_recv_spare.emplace_back(CDataStream{SER_NETWORK, INIT_PROTO_VERSION});
+            }
+            CNetMessage& msg{m_recv_spare.front()};
             bool reject_message{false};
-            CNetMessage msg = m_deserializer->GetMessage(time, reject_message);
+            m_deserializer->GetMessage(msg, time, reject_message);
             if (reject_message) {
                 // Message deserialization failed. Drop the message but don't disconnect the peer.
                 // store the size of the corrupt message
@@ -706,7 +711,7 @@ bool CNode::ReceiveMsgBytes(Span<const uint8_t> msg_bytes, bool& complete)
             i->second += msg.m_raw_message_size;
 
             // push the message to the process queue,
-            vRecvMsg.push_back(std::move(msg));
+            vRecvMsg.splice(vRecvMsg.end(), m_recv_spare, m_recv_spare.begin());
 
             complete = true;
         }
@@ -780,12 +785,14 @@ const uint256& V1TransportDeserializer::GetMessageHash() const
     return data_hash;
 }
 
-CNetMessage V1TransportDeserializer::GetMessage(const std::chrono::microseconds time, bool& reject_message)
+void V1TransportDeserializer::GetMessage(CNetMessage& msg, const std::chrono::microseconds time, bool& reject_message)
 {
     // Initialize out parameter
     reject_message = false;
-    // decompose a single CNetMessage from the TransportDeserializer
-    CNetMessage msg(std::move(vRecv));
+    // decompose a single CNetMessage from the TransportDeserializer, and
+    // receive the next message into the buffer msg held before
+    std::swap(msg.m_recv, vRecv);
+    vRecv.SetVersion(msg.m_recv.GetVersion());
 
     // store message type string, time, and sizes
     msg.m_type = hdr.GetCommand();
@@ -814,17 +821,20 @@ CNetMessage V1TransportDeserializer::GetMessage(const std::chrono::microseconds
 
     // Always reset the network deserializer (prepare for the next message)
     Reset();
-    return msg;
 }
 
-void V1TransportSerializer::prepareForTransport(CSerializedNetMsg& msg, std::vector<unsigned char>& header) const
+SharedNetMsg::SharedNetMsg(CSerializedNetMsg&& msg)
+    : m_type{std::move(msg.m_type)},
+      m_hash{::Hash(msg.data)}
 {
-    // create dbl-sha256 checksum
-    uint256 hash = Hash(msg.data);
+    m_data = std::make_shared<const std::vector<unsigned char>>(std::move(msg.data));
+}
 
-    // create header
-    CMessageHeader hdr(Params().MessageStart(), msg.m_type.c_str(), msg.data.size());
-    memcpy(hdr.pchChecksum, hash.begin(), CMessageHeader::CHECKSUM_SIZE);
+void V1TransportSerializer::prepareForTransport(const SharedNetMsg& msg, std::vector<unsigned char>& header) const
+{
+    // create header, with the dbl-sha256 checksum
+    CMessageHeader hdr(Params().MessageStart(), msg.Type().c_str(), msg.Data()->size());
+    memcpy(hdr.pchChecksum, msg.Hash().begin(), CMessageHeader::CHECKSUM_SIZE);
 
     // serialize header
     header.reserve(CMessageHeader::HEADER_SIZE);
@@ -833,12 +843,22 @@ void V1TransportSerializer::prepareForTransport(CSerializedNetMsg& msg, std::vec
 
 size_t CConnman::SocketSendData(CNode& node) const
 {
-    auto it = node.vSendMsg.begin();
     size_t nSentSize = 0;
 
-    while (it != node.vSendMsg.end()) {
-        const auto& data = *it;
-        assert(data.size() > node.nSendOffset);
+    while (!node.vSendMsg.empty()) {
+        // Send as many of the queued headers and payloads as fit in one call
+        std::array<Span<const unsigned char>, Sock::MAX_SEND_MANY_BUFFERS> bufs;
+        size_t num_bufs{0};
+        size_t buffered{0};
+        for (auto it = node.vSendMsg.begin(); it != node.vSendMsg.end() && num_bufs < bufs.size(); ++it) {
+            Span<const unsigned char> buf{**it};
+            if (num_bufs == 0) {
+                assert(buf.size() > node.nSendOffset);
+                buf = buf.subspan(node.nSendOffset);
+            }
+            bufs[num_bufs++] = buf;
+            buffered += buf.size();
+        }
         int nBytes = 0;
         {
             LOCK(node.m_sock_mutex);
@@ -847,24 +867,32 @@ size_t CConnman::SocketSendData(CNode& node) const
             }
             int flags = MSG_NOSIGNAL | MSG_DONTWAIT;
 #ifdef MSG_MORE
-            if (it + 1 != node.vSendMsg.end()) {
+            if (num_bufs < node.vSendMsg.size()) {
                 flags |= MSG_MORE;
             }
 #endif
-            nBytes = node.m_sock->Send(reinterpret_cast<const char*>(data.data()) + node.nSendOffset, data.size() - node.nSendOffset, flags);
+            nBytes = node.m_sock->SendMany(Span{bufs.data(), num_bufs}, flags);
         }
         if (nBytes > 0) {
             node.m_last_send = GetTime<std::chrono::seconds>();
             node.nSendBytes += nBytes;
-            node.nSendOffset += nBytes;
             nSentSize += nBytes;
-            if (node.nSendOffset == data.size()) {
+            // Drop what was sent completely from the queue
+            size_t sent = nBytes;
+            while (sent > 0) {
+                const size_t size{node.vSendMsg.front()->size()};
+                if (sent < size - node.nSendOffset) {
+                    node.nSendOffset += sent;
+                    break;
+                }
+                sent -= size - node.nSendOffset;
                 node.nSendOffset = 0;
-                node.nSendSize -= data.size();
-                node.fPauseSend = node.nSendSize > nSendBufferMaxSize;
-                it++;
-            } else {
-                // could not send full message; stop sending more
+                node.nSendSize -= size;
+                node.vSendMsg.pop_front();
+            }
+            node.fPauseSend = node.nSendSize > nSendBufferMaxSize;
+            if (static_cast<size_t>(nBytes) < buffered) {
+                // could not send everything; stop sending more
                 break;
             }
         } else {
@@ -881,11 +909,10 @@ size_t CConnman::SocketSendData(CNode& node) const
         }
     }
 
-    if (it == node.vSendMsg.end()) {
+    if (node.vSendMsg.empty()) {
         assert(node.nSendOffset == 0);
         assert(node.nSendSize == 0);
     }
-    node.vSendMsg.erase(node.vSendMsg.begin(), it);
     return nSentSize;
 }
 
@@ -1212,12 +1239,12 @@ bool CConnman::InactivityCheck(const CNode& node) const
     return false;
 }
 
-Sock::EventsPerSock CConnman::GenerateWaitSockets(Span<CNode* const> nodes)
+void CConnman::UpdateWaitSockets(SockEventSet& sock_events, Span<CNode* const> nodes, bool listening)
 {
-    Sock::EventsPerSock events_per_sock;
-
-    for (const ListenSocket& hListenSocket : vhListenSocket) {
-        events_per_sock.emplace(hListenSocket.sock, Sock::Events{Sock::RECV});
+    if (listening) {
+        for (const ListenSocket& hListenSocket : vhListenSocket) {
+            sock_events.Set(hListenSocket.sock, Sock::RECV);
+        }
     }
 
     for (CNode* pnode : nodes) {
@@ -1251,29 +1278,32 @@ Sock::EventsPerSock CConnman::GenerateWaitSockets(Span<CNode* const> nodes)
             requested = Sock::RECV;
         }
 
-        events_per_sock.emplace(pnode->m_sock, Sock::Events{requested});
+        sock_events.Set(pnode->m_sock, requested);
     }
 
-    return events_per_sock;
+    // Forget the sockets of disconnected nodes
+    sock_events.RemoveUnset();
 }
 
-void CConnman::SocketHandler()
+void CConnman::SocketHandler(int net_thread)
 {
     AssertLockNotHeld(m_total_bytes_sent_mutex);
 
+    SockEventSet& sock_events{*m_sock_events[net_thread]};
+    const bool listening{net_thread == 0};
     Sock::EventsPerSock events_per_sock;
 
     {
-        const NodesSnapshot snap{*this, /*shuffle=*/false};
+        const NodesSnapshot snap{*this, /*shuffle=*/false, net_thread};
 
         const auto timeout = std::chrono::milliseconds(SELECT_TIMEOUT_MILLISECONDS);
 
         // Check for the readiness of the already connected sockets and the
-        // listening sockets in one call ("readiness" as in poll(2) or
-        // select(2)). If none are ready, wait for a short while and return
+        // listening sockets in one call ("readiness" as in epoll(7), poll(2)
+        // or select(2)). If none are ready, wait for a short while and return
         // empty sets.
-        events_per_sock = GenerateWaitSockets(snap.Nodes());
-        if (events_per_sock.empty() || !events_per_sock.begin()->first->WaitMany(timeout, events_per_sock)) {
+        UpdateWaitSockets(sock_events, snap.Nodes(), listening);
+        if (!sock_events.Wait(timeout, events_per_sock)) {
             interruptNet.sleep_for(timeout);
         }
 
@@ -1282,7 +1312,7 @@ void CConnman::SocketHandler()
     }
 
     // Accept new connections from listening sockets.
-    SocketHandlerListening(events_per_sock);
+    if (listening) SocketHandlerListening(events_per_sock);
 }
 
 void CConnman::SocketHandlerConnected(const std::vector<CNode*>& nodes,
@@ -1381,16 +1411,19 @@ void CConnman::SocketHandlerListening(const Sock::EventsPerSock& events_per_sock
     }
 }
 
-void CConnman::ThreadSocketHandler()
+void CConnman::ThreadSocketHandler(int net_thread)
 {
     AssertLockNotHeld(m_total_bytes_sent_mutex);
 
     SetSyscallSandboxPolicy(SyscallSandboxPolicy::NET);
     while (!interruptNet)
     {
-        DisconnectNodes();
-        NotifyNumConnectionsChanged();
-        SocketHandler();
+        // The first thread also manages the list of nodes for all of them
+        if (net_thread == 0) {
+            DisconnectNodes();
+            NotifyNumConnectionsChanged();
+        }
+        SocketHandler(net_thread);
     }
 }
 
@@ -2380,7 +2413,17 @@ bool CConnman::Start(CScheduler& scheduler, const Options& connOptions)
     }
 
     // Send and receive from sockets, accept connections
-    threadSocketHandler = std::thread(&util::TraceThread, "net", [this] { ThreadSocketHandler(); });
+    m_sock_events.clear();
+    for (int i = 0; i < m_num_net_threads; ++i) {
+        m_sock_events.push_back(std::make_unique<SockEventSet>());
+    }
+    threadSocketHandler = std::thread(&util::TraceThread, "net", [this] { ThreadSocketHandler(0); });
+    for (int i = 1; i < m_num_net_threads; ++i) {
+        m_extra_socket_handler_threads.emplace_back(&util::TraceThread, strprintf("net.%i", i), [this, i] { ThreadSocketHandler(i); });
+    }
+    if (m_num_net_threads > 1) {
+        LogPrintf("Using %d threads for P2P socket IO\n", m_num_net_threads);
+    }
 
     if (!gArgs.GetBoolArg("-dnsseed", DEFAULT_DNSSEED))
         LogPrintf("DNS seeding disabled\n");
@@ -2472,6 +2515,10 @@ void CConnman::StopThreads()
         threadDNSAddressSeed.join();
     if (threadSocketHandler.joinable())
         threadSocketHandler.join();
+    for (std::thread& thread : m_extra_socket_handler_threads) {
+        thread.join();
+    }
+    m_extra_socket_handler_threads.clear();
 }
 
 void CConnman::StopNodes()
@@ -2502,6 +2549,7 @@ void CConnman::StopNodes()
         DeleteNode(pnode);
     }
     m_nodes_disconnected.clear();
+    m_sock_events.clear();
     vhListenSocket.clear();
     semOutbound.reset();
     semAddnode.reset();
@@ -2829,20 +2877,30 @@ void CNode::MarkReceivedMsgsForProcessing()
     m_msg_process_queue.splice(m_msg_process_queue.end(), vRecvMsg);
     m_msg_process_queue_size += nSizeAdded;
     fPauseRecv = m_msg_process_queue_size > m_recv_flood_size;
+    m_recv_spare.splice(m_recv_spare.end(), m_msg_recycled);
 }
 
-std::optional<std::pair<CNetMessage, bool>> CNode::PollMessage()
+std::optional<std::pair<CNetMessage&, bool>> CNode::PollMessage()
 {
+    // Freed after releasing the lock
+    std::list<CNetMessage> discard;
     LOCK(m_msg_process_queue_mutex);
+    if (!m_msg_polled.empty()) {
+        // Hand the previous message back to the receive path, unless its buffer is large
+        if (m_msg_recycled.size() < MAX_RECYCLED_MSGS && m_msg_polled.front().m_message_size <= MAX_RECYCLED_MSG_SIZE) {
+            m_msg_recycled.splice(m_msg_recycled.end(), m_msg_polled);
+        } else {
+            discard.splice(discard.end(), m_msg_polled);
+        }
+    }
     if (m_msg_process_queue.empty()) return std::nullopt;
 
-    std::list<CNetMessage> msgs;
     // Just take one message
-    msgs.splice(msgs.begin(), m_msg_process_queue, m_msg_process_queue.begin());
-    m_msg_process_queue_size -= msgs.front().m_raw_message_size;
+    m_msg_polled.splice(m_msg_polled.begin(), m_msg_process_queue, m_msg_process_queue.begin());
+    m_msg_process_queue_size -= m_msg_polled.front().m_raw_message_size;
     fPauseRecv = m_msg_process_queue_size > m_recv_flood_size;
 
-    return std::make_pair(std::move(msgs.front()), !m_msg_process_queue.empty());
+    return std::pair<CNetMessage&, bool>{m_msg_polled.front(), !m_msg_process_queue.empty()};
 }
 
 bool CConnman::NodeFullyConnected(const CNode* pnode)
@@ -2851,21 +2909,27 @@ bool CConnman::NodeFullyConnected(const CNode* pnode)
 }
 
 void CConnman::PushMessage(CNode* pnode, CSerializedNetMsg&& msg)
+{
+    PushMessage(pnode, SharedNetMsg{std::move(msg)});
+}
+
+void CConnman::PushMessage(CNode* pnode, const SharedNetMsg& msg)
 {
     AssertLockNotHeld(m_total_bytes_sent_mutex);
-    size_t nMessageSize = msg.data.size();
-    LogPrint(BCLog::NET, "sending %s (%d bytes) peer=%d\n", msg.m_type, nMessageSize, pnode->GetId());
+    const auto& data{msg.Data()};
+    size_t nMessageSize = data->size();
+    LogPrint(BCLog::NET, "sending %s (%d bytes) peer=%d\n", msg.Type(), nMessageSize, pnode->GetId());
     if (gArgs.GetBoolArg("-capturemessages", false)) {
-        CaptureMessage(pnode->addr, msg.m_type, msg.data, /*is_incoming=*/false);
+        CaptureMessage(pnode->addr, msg.Type(), *data, /*is_incoming=*/false);
     }
 
     TRACE6(net, outbound_message,
         pnode->GetId(),
         pnode->m_addr_name.c_str(),
         pnode->ConnectionTypeAsString().c_str(),
-        msg.m_type.c_str(),
-        msg.data.size(),
-        msg.data.data()
+        msg.Type().c_str(),
+        data->size(),
+        data->data()
     );
 
     // make sure we use the appropriate network transport format
@@ -2879,12 +2943,12 @@ void CConnman::PushMessage(CNode* pnode, CSerializedNetMsg&& msg)
         bool optimisticSend(pnode->vSendMsg.empty());
 
         //log total amount of bytes per message type
-        pnode->AccountForSentBytes(msg.m_type, nTotalSize);
+        pnode->AccountForSentBytes(msg.Type(), nTotalSize);
         pnode->nSendSize += nTotalSize;
 
         if (pnode->nSendSize > nSendBufferMaxSize) pnode->fPauseSend = true;
-        pnode->vSendMsg.push_back(std::move(serializedHeader));
-        if (nMessageSize) pnode->vSendMsg.push_back(std::move(msg.data));
+        pnode->vSendMsg.push_back(std::make_shared<const std::vector<unsigned char>>(std::move(serializedHeader)));
+        if (nMessageSize) pnode->vSendMsg.push_back(data);
 
         // If write queue empty, attempt "optimistic write"
         if (optimisticSend) nBytesSent = SocketSendData(*pnode);
@@ -29,6 +29,7 @@
 #include <util/sock.h>
 #include <util/threadinterrupt.h>
 
+#include <algorithm>
 #include <atomic>
 #include <condition_variable>
 #include <cstdint>
@@ -82,6 +83,10 @@ static const std::string DEFAULT_MAX_UPLOAD_TARGET{"0M"};
 static const bool DEFAULT_BLOCKSONLY = false;
 /** -peertimeout default */
 static const int64_t DEFAULT_PEER_CONNECT_TIMEOUT = 60;
+/** -netthreads default */
+static const int DEFAULT_NET_THREADS = 1;
+/** Maximum number of threads for P2P socket IO */
+static const int MAX_NET_THREADS = 16;
 /** Number of file descriptors required for message capture **/
 static const int NUM_FDS_MESSAGE_CAPTURE = 1;
 
@@ -89,6 +94,11 @@ static constexpr bool DEFAULT_FORCEDNSSEED{false};
 static constexpr bool DEFAULT_DNSSEED{true};
 static constexpr bool DEFAULT_FIXEDSEEDS{true};
 static const size_t DEFAULT_MAXRECEIVEBUFFER = 5 * 1000;
+/** Maximum number of processed messages per connection kept for reuse by the receive path.
+ * Together with MAX_RECYCLED_MSG_SIZE this keeps at most 512 KiB per connection. */
+static constexpr size_t MAX_RECYCLED_MSGS{128};
+/** Payload buffers of messages larger than this are freed after processing instead of being reused */
+static constexpr uint32_t MAX_RECYCLED_MSG_SIZE{4 * 1024};
 static const size_t DEFAULT_MAXSENDBUFFER    = 1 * 1000;
 
 typedef int64_t NodeId;
@@ -124,6 +134,28 @@ struct CSerializedNetMsg {
     std::string m_type;
 };
 
+/**
+ * A serialized message whose payload is shared, read-only, by the send queues
+ * of all the peers it is pushed to. Relaying a message to many peers then
+ * serializes and hashes it once, and does not copy it per peer. Copies of a
+ * SharedNetMsg are cheap.
+ */
+class SharedNetMsg
+{
+public:
+    explicit SharedNetMsg(CSerializedNetMsg&& msg);
+
+    const std::string& Type() const { return m_type; }
+    const std::shared_ptr<const std::vector<unsigned char>>& Data() const { return m_data; }
+    /** Double-SHA256 of the payload, from which the transport checksum is taken */
+    const uint256& Hash() const { return m_hash; }
+
+private:
+    std::string m_type;
+    std::shared_ptr<const std::vector<unsigned char>> m_data;
+    uint256 m_hash;
+};
+
 /**
  * Look up IP addresses from all interfaces on the machine and add them to the
  * list of local addresses to self-advertise.
@@ -265,8 +297,8 @@ public:
     virtual void SetVersion(int version) = 0;
     /** read and deserialize data, advances msg_bytes data pointer */
     virtual int Read(Span<const uint8_t>& msg_bytes) = 0;
-    // decomposes a message from the context
-    virtual CNetMessage GetMessage(std::chrono::microseconds time, bool& reject_message) = 0;
+    // decomposes a message from the context into msg, keeping the payload buffer msg held for the next message
+    virtual void GetMessage(CNetMessage& msg, std::chrono::microseconds time, bool& reject_message) = 0;
     virtual ~TransportDeserializer() {}
 };
 
@@ -330,7 +362,7 @@ public:
         }
         return ret;
     }
-    CNetMessage GetMessage(std::chrono::microseconds time, bool& reject_message) override;
+    void GetMessage(CNetMessage& msg, std::chrono::microseconds time, bool& reject_message) override;
 };
 
 /** The TransportSerializer prepares messages for the network transport
@@ -338,13 +370,13 @@ public:
 class TransportSerializer {
 public:
     // prepare message for transport (header construction, error-correction computation, payload encryption, etc.)
-    virtual void prepareForTransport(CSerializedNetMsg& msg, std::vector<unsigned char>& header) const = 0;
+    virtual void prepareForTransport(const SharedNetMsg& msg, std::vector<unsigned char>& header) const = 0;
     virtual ~TransportSerializer() {}
 };
 
 class V1TransportSerializer : public TransportSerializer {
 public:
-    void prepareForTransport(CSerializedNetMsg& msg, std::vector<unsigned char>& header) const override;
+    void prepareForTransport(const SharedNetMsg& msg, std::vector<unsigned char>& header) const override;
 };
 
 struct CNodeOptions
@@ -359,7 +391,7 @@ struct CNodeOptions
 class CNode
 {
 public:
-    const std::unique_ptr<TransportDeserializer> m_deserializer; // Used only by SocketHandler thread
+    const std::unique_ptr<TransportDeserializer> m_deserializer; // Used only by the SocketHandler thread of the node
     const std::unique_ptr<const TransportSerializer> m_serializer;
 
     const NetPermissionFlags m_permission_flags;
@@ -379,7 +411,8 @@ public:
     /** Offset inside the first vSendMsg already sent */
     size_t nSendOffset GUARDED_BY(cs_vSend){0};
     uint64_t nSendBytes GUARDED_BY(cs_vSend){0};
-    std::deque<std::vector<unsigned char>> vSendMsg GUARDED_BY(cs_vSend);
+    /** Headers and payloads to send. Payloads may be shared with the queues of other peers. */
+    std::deque<std::shared_ptr<const std::vector<unsigned char>>> vSendMsg GUARDED_BY(cs_vSend);
     Mutex cs_vSend;
     Mutex m_sock_mutex;
     Mutex cs_vRecv;
@@ -431,8 +464,9 @@ public:
      *
      * Returns std::nullopt if the processing queue is empty, or a pair
      * consisting of the message and a bool that indicates if the processing
-     * queue has more entries. */
-    std::optional<std::pair<CNetMessage, bool>> PollMessage()
+     * queue has more entries. The message stays valid until the next call,
+     * which hands it back to the receive path for reuse. */
+    std::optional<std::pair<CNetMessage&, bool>> PollMessage()
         EXCLUSIVE_LOCKS_REQUIRED(!m_msg_process_queue_mutex);
 
     /** Account for the total size of a sent message in the per msg type connection stats. */
@@ -625,11 +659,18 @@ private:
     std::atomic<int> m_greatest_common_version{INIT_PROTO_VERSION};
 
     const size_t m_recv_flood_size;
-    std::list<CNetMessage> vRecvMsg; // Used only by SocketHandler thread
+    std::list<CNetMessage> vRecvMsg; // Used only by the SocketHandler thread of the node
+    /** Processed messages, whose list nodes and payload buffers are reused for the next
+     * received messages. Used only by the SocketHandler thread of the node. */
+    std::list<CNetMessage> m_recv_spare;
 
     Mutex m_msg_process_queue_mutex;
     std::list<CNetMessage> m_msg_process_queue GUARDED_BY(m_msg_process_queue_mutex);
     size_t m_msg_process_queue_size GUARDED_BY(m_msg_process_queue_mutex){0};
+    /** Processed messages handed back by PollMessage(), picked up by MarkReceivedMsgsForProcessing() */
+    std::list<CNetMessage> m_msg_recycled GUARDED_BY(m_msg_process_queue_mutex);
+    /** The message last returned by PollMessage(). Used only by the message handler thread. */
+    std::list<CNetMessage> m_msg_polled;
 
     // Our address, as reported by the peer
     CService addrLocal GUARDED_BY(m_addr_local_mutex);
@@ -711,6 +752,7 @@ public:
         unsigned int nReceiveFloodSize = 0;
         uint64_t nMaxOutboundLimit = 0;
         int64_t m_peer_connect_timeout = DEFAULT_PEER_CONNECT_TIMEOUT;
+        int m_num_net_threads = DEFAULT_NET_THREADS;
         std::vector<std::string> vSeedNodes;
         std::vector<NetWhitelistPermissions> vWhitelistedRange;
         std::vector<NetWhitebindPermissions> vWhiteBinds;
@@ -743,6 +785,7 @@ public:
         nSendBufferMaxSize = connOptions.nSendBufferMaxSize;
         nReceiveFloodSize = connOptions.nReceiveFloodSize;
         m_peer_connect_timeout = std::chrono::seconds{connOptions.m_peer_connect_timeout};
+        m_num_net_threads = std::clamp(connOptions.m_num_net_threads, 1, MAX_NET_THREADS);
         {
             LOCK(m_total_bytes_sent_mutex);
             nMaxOutboundLimit = connOptions.nMaxOutboundLimit;
@@ -780,6 +823,8 @@ public:
     bool ForNode(NodeId id, std::function<bool(CNode* pnode)> func);
 
     void PushMessage(CNode* pnode, CSerializedNetMsg&& msg) EXCLUSIVE_LOCKS_REQUIRED(!m_total_bytes_sent_mutex);
+    /** Push a message whose payload may also be pushed to other peers, without copying it */
+    void PushMessage(CNode* pnode, const SharedNetMsg& msg) EXCLUSIVE_LOCKS_REQUIRED(!m_total_bytes_sent_mutex);
 
     using NodeFn = std::function<void(CNode*)>;
     void ForEachNode(const NodeFn& func)
@@ -940,17 +985,25 @@ private:
     /** Return true if the peer is inactive and should be disconnected. */
     bool InactivityCheck(const CNode& node) const;
 
+    /** Return the socket handler thread that does the IO of a node */
+    int GetNetThread(const CNode& node) const { return node.GetId() % m_num_net_threads; }
+
     /**
-     * Generate a collection of sockets to check for IO readiness.
+     * Update the sockets in the wait set of a socket handler thread and the
+     * IO readiness to check them for. Only the sockets whose requested events
+     * changed are passed to the kernel again.
+     * @param[in] sock_events The wait set to update.
      * @param[in] nodes Select from these nodes' sockets.
-     * @return sockets to check for readiness
+     * @param[in] listening Whether to include the listening sockets.
      */
-    Sock::EventsPerSock GenerateWaitSockets(Span<CNode* const> nodes);
+    void UpdateWaitSockets(SockEventSet& sock_events, Span<CNode* const> nodes, bool listening);
 
     /**
-     * Check connected and listening sockets for IO readiness and process them accordingly.
+     * Check the connected sockets of the nodes of a socket handler thread
+     * for IO readiness and process them accordingly. The first thread also
+     * accepts new connections from the listening sockets.
      */
-    void SocketHandler() EXCLUSIVE_LOCKS_REQUIRED(!m_total_bytes_sent_mutex, !mutexMsgProc);
+    void SocketHandler(int net_thread) EXCLUSIVE_LOCKS_REQUIRED(!m_total_bytes_sent_mutex, !mutexMsgProc);
 
     /**
      * Do the read/write for connected sockets that are ready for IO.
@@ -967,7 +1020,7 @@ private:
      */
     void SocketHandlerListening(const Sock::EventsPerSock& events_per_sock);
 
-    void ThreadSocketHandler() EXCLUSIVE_LOCKS_REQUIRED(!m_total_bytes_sent_mutex, !mutexMsgProc);
+    void ThreadSocketHandler(int net_thread) EXCLUSIVE_LOCKS_REQUIRED(!m_total_bytes_sent_mutex, !mutexMsgProc);
     void ThreadDNSAddressSeed() EXCLUSIVE_LOCKS_REQUIRED(!m_addr_fetches_mutex, !m_nodes_mutex);
 
     uint64_t CalculateKeyedNetGroup(const CAddress& ad) const;
@@ -1033,6 +1086,17 @@ private:
     unsigned int nReceiveFloodSize{0};
 
     std::vector<ListenSocket> vhListenSocket;
+    /**
+     * Number of threads for socket IO (-netthreads). The connected nodes are
+     * spread over them by id, see GetNetThread().
+     */
+    int m_num_net_threads{DEFAULT_NET_THREADS};
+    /**
+     * Sockets waited on by SocketHandler(), per socket handler thread. Each
+     * set is only used by its thread, and by StopNodes() after the threads
+     * have exited.
+     */
+    std::vector<std::unique_ptr<SockEventSet>> m_sock_events;
     std::atomic<bool> fNetworkActive{true};
     bool fAddressesInitialized{false};
     AddrMan& addrman;
@@ -1139,6 +1203,8 @@ private:
 
     std::thread threadDNSAddressSeed;
     std::thread threadSocketHandler;
+    //! Socket handler threads other than threadSocketHandler (-netthreads)
+    std::vector<std::thread> m_extra_socket_handler_threads;
     std::thread threadOpenAddedConnections;
     std::thread threadOpenConnections;
     std::thread threadMessageHandler;
@@ -1188,11 +1254,21 @@ private:
     class NodesSnapshot
     {
     public:
-        explicit NodesSnapshot(const CConnman& connman, bool shuffle)
+        /**
+         * @param[in] net_thread If set, only take the nodes whose IO is done
+         * by this socket handler thread.
+         */
+        explicit NodesSnapshot(const CConnman& connman, bool shuffle, std::optional<int> net_thread = std::nullopt)
         {
             {
                 LOCK(connman.m_nodes_mutex);
-                m_nodes_copy = connman.m_nodes;
+                if (net_thread) {
+                    for (CNode* node : connman.m_nodes) {
+                        if (connman.GetNetThread(*node) == *net_thread) m_nodes_copy.push_back(node);
+                    }
+                } else {
+                    m_nodes_copy = connman.m_nodes;
+                }
                 for (auto& node : m_nodes_copy) {
                     node->AddRef();
                 }
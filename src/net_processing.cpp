@@ -25,6 +25,7 @@
 #include <policy/fees.h>
 #include <policy/policy.h>
 #include <policy/settings.h>
+#include <pow.h>
 #include <primitives/block.h>
 #include <primitives/transaction.h>
 #include <random.h>
@@ -38,8 +39,10 @@
 #include <txorphanage.h>
 #include <txrequest.h>
 #include <util/check.h> // For NDEBUG compile time check
+#include <util/hasher.h>
 #include <util/strencodings.h>
 #include <util/system.h>
+#include <util/threadpool.h>
 #include <util/trace.h>
 #include <validation.h>
 
@@ -47,9 +50,11 @@
 #include <atomic>
 #include <chrono>
 #include <future>
+#include <list>
 #include <memory>
 #include <optional>
 #include <typeinfo>
+#include <unordered_map>
 
 using node::ReadBlockFromDisk;
 using node::ReadRawBlockFromDisk;
@@ -64,6 +69,9 @@ static constexpr auto HEADERS_DOWNLOAD_TIMEOUT_BASE = 15min;
 static constexpr auto HEADERS_DOWNLOAD_TIMEOUT_PER_HEADER = 1ms;
 /** How long to wait for a peer to respond to a getheaders request */
 static constexpr auto HEADERS_RESPONSE_TIME{2min};
+/** Headers messages with at least this many headers have their proof of work hashed on the
+ *  peer work threads, while the message handler goes on with other peers */
+static constexpr size_t MIN_HEADERS_FOR_PEER_WORK{8};
 /** Protect at least this many outbound peers from disconnection due to slow/
  * behind headers chain.
  */
@@ -134,10 +142,16 @@ static constexpr double BLOCK_DOWNLOAD_TIMEOUT_BASE = 5;
 static constexpr double BLOCK_DOWNLOAD_TIMEOUT_PER_PEER = 2.5;
 /** Maximum number of headers to announce when relaying blocks with headers message.*/
 static const unsigned int MAX_BLOCKS_TO_ANNOUNCE = 8;
+/** Maximum number of new blocks whose first receipt is remembered until they are announced, for their relay latency */
+static constexpr size_t MAX_BLOCKS_FIRST_SEEN{16};
 /** Maximum number of unconnecting headers announcements before DoS score */
 static const int MAX_NUM_UNCONNECTING_HEADERS_MSGS = 10;
 /** Minimum blocks required to signal NODE_NETWORK_LIMITED */
 static const unsigned int NODE_NETWORK_LIMITED_MIN_BLOCKS = 288;
+/** Size of the blocks recently served to peers that are kept in memory, shared by all peers */
+static constexpr size_t SERVED_BLOCK_CACHE_SIZE{32 << 20};
+/** How many blocks to read ahead for a peer that requests the blocks of the active chain in order */
+static constexpr int BLOCK_READ_AHEAD{8};
 /** Average delay between local address broadcasts */
 static constexpr auto AVG_LOCAL_ADDRESS_BROADCAST_INTERVAL{24h};
 /** Average delay between peer address broadcasts */
@@ -187,6 +201,48 @@ static constexpr uint64_t CMPCTBLOCKS_VERSION{2};
 
 // Internal stuff
 namespace {
+/** BLOCK messages, with witness, of the blocks most recently served to or read ahead for peers */
+class ServedBlockCache
+{
+private:
+    Mutex m_mutex;
+    /** Least recently used first */
+    std::list<std::pair<uint256, SharedNetMsg>> m_blocks GUARDED_BY(m_mutex);
+    std::unordered_map<uint256, decltype(m_blocks)::iterator, SaltedTxidHasher> m_index GUARDED_BY(m_mutex);
+    size_t m_size GUARDED_BY(m_mutex){0};
+    const size_t m_max_size;
+
+public:
+    explicit ServedBlockCache(size_t max_size) : m_max_size{max_size} {}
+
+    std::optional<SharedNetMsg> Get(const uint256& hash) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        LOCK(m_mutex);
+        const auto it{m_index.find(hash)};
+        if (it == m_index.end()) return std::nullopt;
+        m_blocks.splice(m_blocks.end(), m_blocks, it->second);
+        return it->second->second;
+    }
+
+    bool Contains(const uint256& hash) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        return WITH_LOCK(m_mutex, return m_index.count(hash) > 0);
+    }
+
+    void Insert(const uint256& hash, const SharedNetMsg& msg) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        LOCK(m_mutex);
+        if (m_index.count(hash) > 0 || msg.Data()->size() > m_max_size) return;
+        m_size += msg.Data()->size();
+        m_index.emplace(hash, m_blocks.emplace(m_blocks.end(), hash, msg));
+        while (m_size > m_max_size) {
+            m_size -= m_blocks.front().second.Data()->size();
+            m_index.erase(m_blocks.front().first);
+            m_blocks.pop_front();
+        }
+    }
+};
+
 /** Blocks that are in flight, and that are in the queue to be downloaded. */
 struct QueuedBlock {
     /** BlockIndex. We must have this since we only request blocks when we've already validated the header. */
@@ -397,6 +453,33 @@ struct Peer {
     /** Whether this peer wants invs or headers (when possible) for block announcements */
     bool m_prefers_headers GUARDED_BY(NetEventsInterface::g_msgproc_mutex){false};
 
+    /** A headers message whose proof of work is being hashed on the peer work threads */
+    struct PendingHeaders {
+        std::vector<CBlockHeader> headers;
+        /** Number of hashing tasks that have not finished */
+        std::atomic<size_t> remaining{0};
+        /** Set when a header with invalid proof of work was found, which stops the other tasks */
+        std::atomic<bool> invalid{false};
+    };
+    /** No further message of this peer is processed until the pending headers are hashed,
+     *  to keep the order of its messages. */
+    std::shared_ptr<PendingHeaders> m_pending_headers GUARDED_BY(NetEventsInterface::g_msgproc_mutex);
+
+    /** A block requested by this peer that is being read on the block serving threads */
+    struct PendingBlock {
+        CInv inv;
+        /** The BLOCK message, or std::nullopt if the block could not be read */
+        std::optional<SharedNetMsg> msg;
+        std::atomic<bool> done{false};
+    };
+    /** No further getdata item or message of this peer is processed until the pending block
+     *  is sent, to keep the order of the responses. */
+    std::shared_ptr<PendingBlock> m_pending_block GUARDED_BY(NetEventsInterface::g_msgproc_mutex);
+    /** Height of the last block of the active chain served to this peer */
+    int m_last_served_height GUARDED_BY(NetEventsInterface::g_msgproc_mutex){-1};
+    /** Height up to which blocks of the active chain were read ahead for this peer */
+    int m_read_ahead_height GUARDED_BY(NetEventsInterface::g_msgproc_mutex){-1};
+
     explicit Peer(NodeId id, ServiceFlags our_services)
         : m_id{id}
         , m_our_services{our_services}
@@ -480,6 +563,9 @@ struct CNodeState {
     //! Time of last new block announcement
     int64_t m_last_block_announcement{0};
 
+    //! Relay latency of the blocks whose header this peer sent us first
+    BlockRelayLatency m_block_relay_latency;
+
     //! Whether this peer is an inbound connection
     const bool m_is_inbound;
 
@@ -519,6 +605,7 @@ public:
     std::optional<std::string> FetchBlock(NodeId peer_id, const CBlockIndex& block_index) override
         EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex);
     bool GetNodeStateStats(NodeId nodeid, CNodeStateStats& stats) const override EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex);
+    BlockRelayLatency GetBlockRelayLatency() const override;
     bool IgnoresIncomingTxs() override { return m_ignore_incoming_txs; }
     void SendPings() override EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex);
     void RelayTransaction(const uint256& txid, const uint256& wtxid) override EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex);
@@ -608,6 +695,12 @@ private:
                                std::vector<CBlockHeader>&& headers,
                                bool via_compact_block)
         EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex, !m_headers_presync_mutex, g_msgproc_mutex);
+    /** Process the headers of a headers message and report headers presync progress */
+    void ProcessReceivedHeaders(CNode& pfrom, Peer& peer, std::vector<CBlockHeader>&& headers)
+        EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex, !m_headers_presync_mutex, g_msgproc_mutex);
+    /** Hash the proof of work of a headers message on the peer work threads. ProcessMessages()
+     *  processes the headers once all hashes are known. */
+    void HashHeadersPoW(Peer& peer, std::vector<CBlockHeader>&& headers) EXCLUSIVE_LOCKS_REQUIRED(g_msgproc_mutex);
     /** Various helpers for headers processing, invoked by ProcessHeadersMessage() */
     /** Return true if headers are continuous and have valid proof-of-work (DoS points assigned on failure) */
     bool CheckHeadersPoW(const std::vector<CBlockHeader>& headers, const Consensus::Params& consensusParams, Peer& peer);
@@ -852,6 +945,8 @@ private:
     Mutex m_most_recent_block_mutex;
     std::shared_ptr<const CBlock> m_most_recent_block GUARDED_BY(m_most_recent_block_mutex);
     std::shared_ptr<const CBlockHeaderAndShortTxIDs> m_most_recent_compact_block GUARDED_BY(m_most_recent_block_mutex);
+    /** m_most_recent_compact_block serialized once, shared by all peers it is announced to */
+    std::optional<SharedNetMsg> m_most_recent_compact_block_msg GUARDED_BY(m_most_recent_block_mutex);
     uint256 m_most_recent_block_hash GUARDED_BY(m_most_recent_block_mutex);
 
     // Data about the low-work headers synchronization, aggregated from all peers' HeadersSyncStates.
@@ -875,6 +970,15 @@ private:
     /** Height of the highest block announced using BIP 152 high-bandwidth mode. */
     int m_highest_fast_announce GUARDED_BY(::cs_main){0};
 
+    /** Peer and time of the first receipt of the header of new blocks, until they are announced */
+    std::map<uint256, std::pair<NodeId, std::chrono::microseconds>> m_block_first_seen GUARDED_BY(::cs_main);
+    /** Relay latency of all blocks received from peers */
+    BlockRelayLatency m_block_relay_latency GUARDED_BY(::cs_main);
+    /** Remember when and from which peer the header of a block we do not have yet was received */
+    void BlockFirstSeen(const uint256& hash, NodeId nodeid, std::chrono::microseconds time_received) EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
+    /** Record the relay latency of a block received from a peer on its first announcement */
+    void BlockAnnounced(const uint256& hash) EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
+
     /** Have we requested this block from a peer */
     bool IsBlockRequested(const uint256& hash) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
@@ -927,6 +1031,14 @@ private:
     /** Expiration-time ordered list of (expire time, relay map entry) pairs. */
     std::deque<std::pair<std::chrono::microseconds, MapRelay::iterator>> g_relay_expiration GUARDED_BY(NetEventsInterface::g_msgproc_mutex);
 
+    /** Record that a transaction is announced to a peer, and keep it in mapRelay so that the peer can request it. */
+    void RecordTxAnnouncement(Peer::TxRelay& tx_relay, CTransactionRef tx, const uint256& hash, std::chrono::microseconds current_time)
+        EXCLUSIVE_LOCKS_REQUIRED(tx_relay.m_tx_inventory_mutex, NetEventsInterface::g_msgproc_mutex);
+
+    /** Announce the transactions a reconciliation round found the peer to be missing. */
+    void AnnounceReconciledTxs(CNode& node, Peer& peer, const std::vector<uint256>& wtxids)
+        EXCLUSIVE_LOCKS_REQUIRED(NetEventsInterface::g_msgproc_mutex);
+
     /**
      * When a peer sends us a valid block, instruct it to announce blocks to us
      * using CMPCTBLOCK if possible by adding its nodeid to the end of
@@ -968,7 +1080,19 @@ private:
     bool BlockRequestAllowed(const CBlockIndex* pindex) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
     bool AlreadyHaveBlock(const uint256& block_hash) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
     void ProcessGetBlockData(CNode& pfrom, Peer& peer, const CInv& inv)
-        EXCLUSIVE_LOCKS_REQUIRED(!m_most_recent_block_mutex);
+        EXCLUSIVE_LOCKS_REQUIRED(!m_most_recent_block_mutex, NetEventsInterface::g_msgproc_mutex);
+    /** Read a requested block on the block serving threads, along with the blocks that follow
+     *  it if the peer is walking the active chain. */
+    void ServeBlockAsync(CNode& pfrom, Peer& peer, const CInv& inv, const CBlockIndex& index)
+        EXCLUSIVE_LOCKS_REQUIRED(cs_main, NetEventsInterface::g_msgproc_mutex);
+    /** The BLOCK message with witness of a block, from the served block cache or from disk */
+    std::optional<SharedNetMsg> ReadServedBlock(const uint256& hash, const FlatFilePos& pos);
+    /** Send the pending block of a peer once it has been read */
+    void SendPendingBlock(CNode& pfrom, Peer& peer) EXCLUSIVE_LOCKS_REQUIRED(NetEventsInterface::g_msgproc_mutex);
+    /** If the peer asked for the block as the last one of a getblocks batch, announce our tip so it asks for the next batch */
+    void MaybeSendContinuationInv(CNode& pfrom, Peer& peer, const uint256& block_hash);
+
+    ServedBlockCache m_served_blocks{SERVED_BLOCK_CACHE_SIZE};
 
     /**
      * Validation logic for compact filters request handling.
@@ -1034,6 +1158,12 @@ private:
 
     void AddAddressKnown(Peer& peer, const CAddress& addr) EXCLUSIVE_LOCKS_REQUIRED(g_msgproc_mutex);
     void PushAddress(Peer& peer, const CAddress& addr, FastRandomContext& insecure_rand) EXCLUSIVE_LOCKS_REQUIRED(g_msgproc_mutex);
+
+    /** Threads doing peer-local work off the message handler thread, see -peerworkthreads.
+     *  Declared last, so that it stops before the members its tasks use are destroyed. */
+    ThreadPool m_peer_work;
+    /** Threads reading blocks requested by peers from disk, see -blockservethreads */
+    ThreadPool m_block_serving;
 };
 
 const CNodeState* PeerManagerImpl::State(NodeId pnode) const EXCLUSIVE_LOCKS_REQUIRED(cs_main)
@@ -1610,6 +1740,7 @@ bool PeerManagerImpl::GetNodeStateStats(NodeId nodeid, CNodeStateStats& stats) c
             return false;
         stats.nSyncHeight = state->pindexBestKnownBlock ? state->pindexBestKnownBlock->nHeight : -1;
         stats.nCommonHeight = state->pindexLastCommonBlock ? state->pindexLastCommonBlock->nHeight : -1;
+        stats.m_block_relay_latency = state->m_block_relay_latency;
         for (const QueuedBlock& queue : state->vBlocksInFlight) {
             if (queue.pindex)
                 stats.vHeightInFlight.push_back(queue.pindex->nHeight);
@@ -1653,6 +1784,40 @@ bool PeerManagerImpl::GetNodeStateStats(NodeId nodeid, CNodeStateStats& stats) c
     return true;
 }
 
+void BlockRelayLatency::Add(std::chrono::microseconds latency)
+{
+    const auto bucket{std::lower_bound(BUCKETS_MS.begin(), BUCKETS_MS.end(), std::chrono::ceil<std::chrono::milliseconds>(latency).count())};
+    ++m_counts[bucket - BUCKETS_MS.begin()];
+}
+
+BlockRelayLatency PeerManagerImpl::GetBlockRelayLatency() const
+{
+    return WITH_LOCK(cs_main, return m_block_relay_latency);
+}
+
+void PeerManagerImpl::BlockFirstSeen(const uint256& hash, NodeId nodeid, std::chrono::microseconds time_received)
+{
+    if (m_block_first_seen.count(hash)) return;
+    if (m_block_first_seen.size() >= MAX_BLOCKS_FIRST_SEEN) {
+        // The oldest is most likely a block that will not be announced
+        m_block_first_seen.erase(std::min_element(m_block_first_seen.begin(), m_block_first_seen.end(),
+            [](const auto& a, const auto& b) { return a.second.second < b.second.second; }));
+    }
+    m_block_first_seen.emplace(hash, std::make_pair(nodeid, time_received));
+}
+
+void PeerManagerImpl::BlockAnnounced(const uint256& hash)
+{
+    const auto it{m_block_first_seen.find(hash)};
+    if (it == m_block_first_seen.end()) return;
+    const auto latency{GetTime<std::chrono::microseconds>() - it->second.second};
+    m_block_relay_latency.Add(latency);
+    if (CNodeState* state = State(it->second.first)) {
+        state->m_block_relay_latency.Add(latency);
+    }
+    m_block_first_seen.erase(it);
+}
+
 void PeerManagerImpl::AddToCompactExtraTransactions(const CTransactionRef& tx)
 {
     size_t max_extra_txn = gArgs.GetIntArg("-blockreconstructionextratxn", DEFAULT_BLOCK_RECONSTRUCTION_EXTRA_TXN);
@@ -1838,6 +2003,8 @@ PeerManagerImpl::PeerManagerImpl(CConnman& connman, AddrMan& addrman,
     if (gArgs.GetBoolArg("-txreconciliation", DEFAULT_TXRECONCILIATION_ENABLE)) {
         m_txreconciliation = std::make_unique<TxReconciliationTracker>(TXRECONCILIATION_VERSION);
     }
+    m_peer_work.Start("peerwork", std::clamp<int>(gArgs.GetIntArg("-peerworkthreads", DEFAULT_PEER_WORK_THREADS), 0, MAX_PEER_WORK_THREADS));
+    m_block_serving.Start("blockserve", std::clamp<int>(gArgs.GetIntArg("-blockservethreads", DEFAULT_BLOCK_SERVE_THREADS), 0, MAX_BLOCK_SERVE_THREADS));
 }
 
 void PeerManagerImpl::StartScheduledTasks(CScheduler& scheduler)
@@ -1925,17 +2092,19 @@ void PeerManagerImpl::NewPoWValidBlock(const CBlockIndex *pindex, const std::sha
     if (!DeploymentActiveAt(*pindex, m_chainman, Consensus::DEPLOYMENT_SEGWIT)) return;
 
     uint256 hashBlock(pblock->GetHash());
-    const std::shared_future<CSerializedNetMsg> lazy_ser{
-        std::async(std::launch::deferred, [&] { return msgMaker.Make(NetMsgType::CMPCTBLOCK, *pcmpctblock); })};
+    const std::shared_future<SharedNetMsg> lazy_ser{
+        std::async(std::launch::deferred, [&] { return SharedNetMsg{msgMaker.Make(NetMsgType::CMPCTBLOCK, *pcmpctblock)}; })};
 
     {
         LOCK(m_most_recent_block_mutex);
         m_most_recent_block_hash = hashBlock;
         m_most_recent_block = pblock;
         m_most_recent_compact_block = pcmpctblock;
+        m_most_recent_compact_block_msg.reset();
     }
 
-    m_connman.ForEachNode([this, pindex, &lazy_ser, &hashBlock](CNode* pnode) EXCLUSIVE_LOCKS_REQUIRED(::cs_main) {
+    bool announced{false};
+    m_connman.ForEachNode([this, pindex, &lazy_ser, &hashBlock, &announced](CNode* pnode) EXCLUSIVE_LOCKS_REQUIRED(::cs_main) {
         AssertLockHeld(::cs_main);
 
         if (pnode->GetCommonVersion() < INVALID_CB_NO_BAN_VERSION || pnode->fDisconnect)
@@ -1949,11 +2118,12 @@ void PeerManagerImpl::NewPoWValidBlock(const CBlockIndex *pindex, const std::sha
             LogPrint(BCLog::NET, "%s sending header-and-ids %s to peer=%d\n", "PeerManager::NewPoWValidBlock",
                     hashBlock.ToString(), pnode->GetId());
 
-            const CSerializedNetMsg& ser_cmpctblock{lazy_ser.get()};
-            m_connman.PushMessage(pnode, ser_cmpctblock.Copy());
+            m_connman.PushMessage(pnode, lazy_ser.get());
             state.pindexBestHeaderSent = pindex;
+            announced = true;
         }
     });
+    if (announced) BlockAnnounced(hashBlock);
 }
 
 /**
@@ -2212,6 +2382,10 @@ void PeerManagerImpl::ProcessGetBlockData(CNode& pfrom, Peer& peer, const CInv&
     std::shared_ptr<const CBlock> pblock;
     if (a_recent_block && a_recent_block->GetHash() == pindex->GetBlockHash()) {
         pblock = a_recent_block;
+    } else if ((inv.IsMsgBlk() || inv.IsMsgWitnessBlk()) && m_block_serving.NumThreads() > 0) {
+        // The block, and the continuation inv after it, are sent by SendPendingBlock()
+        ServeBlockAsync(pfrom, peer, inv, *pindex);
+        return;
     } else if (inv.IsMsgWitnessBlk()) {
         // Fast-path: in this case it is possible to serve the block directly from disk,
         // as the network format matches the format on disk
@@ -2276,19 +2450,116 @@ void PeerManagerImpl::ProcessGetBlockData(CNode& pfrom, Peer& peer, const CInv&
         }
     }
 
-    {
-        LOCK(peer.m_block_inv_mutex);
-        // Trigger the peer node to send a getblocks request for the next batch of inventory
-        if (inv.hash == peer.m_continuation_block) {
-            // Send immediately. This must send even if redundant,
-            // and we want it right after the last block so they don't
-            // wait for other stuff first.
-            std::vector<CInv> vInv;
-            vInv.push_back(CInv(MSG_BLOCK, m_chainman.ActiveChain().Tip()->GetBlockHash()));
-            m_connman.PushMessage(&pfrom, msgMaker.Make(NetMsgType::INV, vInv));
-            peer.m_continuation_block.SetNull();
+    MaybeSendContinuationInv(pfrom, peer, inv.hash);
+}
+
+void PeerManagerImpl::MaybeSendContinuationInv(CNode& pfrom, Peer& peer, const uint256& block_hash)
+{
+    const uint256 tip_hash{WITH_LOCK(cs_main, return m_chainman.ActiveChain().Tip()->GetBlockHash())};
+    LOCK(peer.m_block_inv_mutex);
+    // Trigger the peer node to send a getblocks request for the next batch of inventory
+    if (block_hash == peer.m_continuation_block) {
+        // Send immediately. This must send even if redundant,
+        // and we want it right after the last block so they don't
+        // wait for other stuff first.
+        std::vector<CInv> vInv;
+        vInv.push_back(CInv(MSG_BLOCK, tip_hash));
+        m_connman.PushMessage(&pfrom, CNetMsgMaker(pfrom.GetCommonVersion()).Make(NetMsgType::INV, vInv));
+        peer.m_continuation_block.SetNull();
+    }
+}
+
+void PeerManagerImpl::ServeBlockAsync(CNode& pfrom, Peer& peer, const CInv& inv, const CBlockIndex& index)
+{
+    auto pending{std::make_shared<Peer::PendingBlock>()};
+    pending->inv = inv;
+    peer.m_pending_block = pending;
+
+    // Read ahead the blocks that follow, if the peer is walking the active chain
+    std::vector<std::pair<uint256, FlatFilePos>> read_ahead;
+    const CChain& active_chain{m_chainman.ActiveChain()};
+    if (active_chain.Contains(&index)) {
+        if (index.nHeight > peer.m_last_served_height && index.nHeight <= peer.m_last_served_height + BLOCK_READ_AHEAD) {
+            const int end_height{std::min(index.nHeight + BLOCK_READ_AHEAD, active_chain.Height())};
+            for (int height = std::max(index.nHeight, peer.m_read_ahead_height) + 1; height <= end_height; ++height) {
+                const CBlockIndex* next{active_chain[height]};
+                if (!(next->nStatus & BLOCK_HAVE_DATA)) break;
+                read_ahead.emplace_back(next->GetBlockHash(), next->GetBlockPos());
+                peer.m_read_ahead_height = height;
+            }
+        }
+        peer.m_last_served_height = index.nHeight;
+    }
+
+    m_block_serving.Submit([this, pending, hash = index.GetBlockHash(), pos = index.GetBlockPos(),
+                            version = pfrom.GetCommonVersion(), read_ahead = std::move(read_ahead)] {
+        pending->msg = ReadServedBlock(hash, pos);
+        if (pending->msg && pending->inv.IsMsgBlk()) {
+            // Serialize the block without witness, from the block as it is stored
+            try {
+                CBlock block;
+                SpanReader{SER_NETWORK, PROTOCOL_VERSION, *pending->msg->Data()} >> block;
+                pending->msg.emplace(CNetMsgMaker{version}.Make(SERIALIZE_TRANSACTION_NO_WITNESS, NetMsgType::BLOCK, block));
+            } catch (const std::exception& e) {
+                LogPrintf("%s: Deserialize error - %s for block %s\n", __func__, e.what(), hash.ToString());
+                pending->msg.reset();
+            }
+        }
+        pending->done = true;
+        m_connman.WakeMessageHandler();
+
+        for (const auto& [next_hash, next_pos] : read_ahead) {
+            if (!m_served_blocks.Contains(next_hash)) {
+                ReadServedBlock(next_hash, next_pos);
+            }
+        }
+    });
+}
+
+std::optional<SharedNetMsg> PeerManagerImpl::ReadServedBlock(const uint256& hash, const FlatFilePos& pos)
+{
+    if (auto msg{m_served_blocks.Get(hash)}) return msg;
+
+    // In the network format, as it is stored
+    CSerializedNetMsg ser_msg;
+    ser_msg.m_type = NetMsgType::BLOCK;
+    if (!ReadRawBlockFromDisk(ser_msg.data, pos, m_chainparams.MessageStart())) {
+        return std::nullopt;
+    }
+    // Check the block against its index entry, whose proof of work was checked
+    // when it was accepted, instead of computing the proof of work again.
+    CBlockHeaderUncached header;
+    try {
+        SpanReader{SER_NETWORK, PROTOCOL_VERSION, ser_msg.data} >> header;
+    } catch (const std::exception& e) {
+        LogPrintf("%s: Deserialize error - %s for block %s\n", __func__, e.what(), hash.ToString());
+        return std::nullopt;
+    }
+    if (header.GetHash() != hash) {
+        LogPrintf("%s: Block at %s does not match its index entry %s\n", __func__, pos.ToString(), hash.ToString());
+        return std::nullopt;
+    }
+    const SharedNetMsg msg{std::move(ser_msg)};
+    m_served_blocks.Insert(hash, msg);
+    return msg;
+}
+
+void PeerManagerImpl::SendPendingBlock(CNode& pfrom, Peer& peer)
+{
+    const auto pending{std::move(peer.m_pending_block)};
+    if (!pending->msg) {
+        const bool pruned{WITH_LOCK(cs_main, const CBlockIndex* pindex{m_chainman.m_blockman.LookupBlockIndex(pending->inv.hash)};
+                                                 return pindex && m_chainman.m_blockman.IsBlockPruned(pindex))};
+        if (pruned) {
+            LogPrint(BCLog::NET, "Block was pruned before it could be read, disconnect peer=%d\n", pfrom.GetId());
+        } else {
+            LogPrintf("Cannot load block %s from disk, disconnect peer=%d\n", pending->inv.hash.ToString(), pfrom.GetId());
         }
+        pfrom.fDisconnect = true;
+        return;
     }
+    m_connman.PushMessage(&pfrom, *pending->msg);
+    MaybeSendContinuationInv(pfrom, peer, pending->inv.hash);
 }
 
 CTransactionRef PeerManagerImpl::FindTxForGetData(const Peer::TxRelay& tx_relay, const GenTxid& gtxid, const std::chrono::seconds mempool_req, const std::chrono::seconds now)
@@ -2315,12 +2586,76 @@ CTransactionRef PeerManagerImpl::FindTxForGetData(const Peer::TxRelay& tx_relay,
     return {};
 }
 
+void PeerManagerImpl::RecordTxAnnouncement(Peer::TxRelay& tx_relay, CTransactionRef tx, const uint256& hash, std::chrono::microseconds current_time)
+{
+    const uint256& txid{tx->GetHash()};
+    const uint256& wtxid{tx->GetWitnessHash()};
+    tx_relay.m_recently_announced_invs.insert(hash);
+    {
+        // Expire old relay messages
+        while (!g_relay_expiration.empty() && g_relay_expiration.front().first < current_time)
+        {
+            mapRelay.erase(g_relay_expiration.front().second);
+            g_relay_expiration.pop_front();
+        }
+
+        auto ret = mapRelay.emplace(txid, std::move(tx));
+        if (ret.second) {
+            g_relay_expiration.emplace_back(current_time + RELAY_TX_CACHE_TIME, ret.first);
+        }
+        // Add wtxid-based lookup into mapRelay as well, so that peers can request by wtxid
+        auto ret2 = mapRelay.emplace(wtxid, ret.first->second);
+        if (ret2.second) {
+            g_relay_expiration.emplace_back(current_time + RELAY_TX_CACHE_TIME, ret2.first);
+        }
+    }
+    tx_relay.m_tx_inventory_known_filter.insert(hash);
+    if (hash != txid) {
+        // Insert txid into m_tx_inventory_known_filter, even for
+        // wtxidrelay peers. This prevents re-adding of
+        // unconfirmed parents to the recently_announced
+        // filter, when a child tx is requested. See
+        // ProcessGetData().
+        tx_relay.m_tx_inventory_known_filter.insert(txid);
+    }
+}
+
+void PeerManagerImpl::AnnounceReconciledTxs(CNode& node, Peer& peer, const std::vector<uint256>& wtxids)
+{
+    auto tx_relay = peer.GetTxRelay();
+    if (!tx_relay || wtxids.empty()) return;
+
+    const CNetMsgMaker msgMaker(node.GetCommonVersion());
+    const auto current_time{GetTime<std::chrono::microseconds>()};
+    std::vector<CInv> invs;
+    LOCK(tx_relay->m_tx_inventory_mutex);
+    for (const uint256& wtxid : wtxids) {
+        // Announced by either side since the transaction was added to the set
+        if (tx_relay->m_tx_inventory_known_filter.contains(wtxid)) continue;
+        auto txinfo = m_mempool.info(GenTxid::Wtxid(wtxid));
+        if (!txinfo.tx) continue;
+        invs.emplace_back(MSG_WTX, wtxid);
+        RecordTxAnnouncement(*tx_relay, std::move(txinfo.tx), wtxid, current_time);
+        if (invs.size() == MAX_INV_SZ) {
+            m_connman.PushMessage(&node, msgMaker.Make(NetMsgType::INV, invs));
+            invs.clear();
+        }
+    }
+    if (!invs.empty()) m_connman.PushMessage(&node, msgMaker.Make(NetMsgType::INV, invs));
+}
+
 void PeerManagerImpl::ProcessGetData(CNode& pfrom, Peer& peer, const std::atomic<bool>& interruptMsgProc)
 {
     AssertLockNotHeld(cs_main);
 
     auto tx_relay = peer.GetTxRelay();
 
+    if (peer.m_pending_block) {
+        // Nothing else is served until the block being read is sent
+        if (!peer.m_pending_block->done) return;
+        SendPendingBlock(pfrom, peer);
+    }
+
     std::deque<CInv>::iterator it = peer.m_getdata_requests.begin();
     std::vector<CInv> vNotFound;
     const CNetMsgMaker msgMaker(pfrom.GetCommonVersion());
@@ -2434,6 +2769,51 @@ void PeerManagerImpl::SendBlockTransactions(CNode& pfrom, Peer& peer, const CBlo
     m_connman.PushMessage(&pfrom, msgMaker.Make(NetMsgType::BLOCKTXN, resp));
 }
 
+void PeerManagerImpl::ProcessReceivedHeaders(CNode& pfrom, Peer& peer, std::vector<CBlockHeader>&& headers)
+{
+    ProcessHeadersMessage(pfrom, peer, std::move(headers), /*via_compact_block=*/false);
+
+    // Check if the headers presync progress needs to be reported to validation.
+    // This needs to be done without holding the m_headers_presync_mutex lock.
+    if (m_headers_presync_should_signal.exchange(false)) {
+        HeadersPresyncStats stats;
+        {
+            LOCK(m_headers_presync_mutex);
+            auto it = m_headers_presync_stats.find(m_headers_presync_bestpeer);
+            if (it != m_headers_presync_stats.end()) stats = it->second;
+        }
+        if (stats.second) {
+            m_chainman.ReportHeadersPresync(stats.first, stats.second->first, stats.second->second);
+        }
+    }
+}
+
+void PeerManagerImpl::HashHeadersPoW(Peer& peer, std::vector<CBlockHeader>&& headers)
+{
+    auto pending{std::make_shared<Peer::PendingHeaders>()};
+    pending->headers = std::move(headers);
+    const size_t num_headers{pending->headers.size()};
+    const size_t num_tasks{std::min<size_t>(m_peer_work.NumThreads(), num_headers)};
+    pending->remaining = num_tasks;
+    peer.m_pending_headers = pending;
+
+    // Each task hashes a contiguous range, stopping early once any header is found invalid
+    for (size_t task = 0; task < num_tasks; ++task) {
+        const size_t begin{num_headers * task / num_tasks};
+        const size_t end{num_headers * (task + 1) / num_tasks};
+        m_peer_work.Submit([this, pending, begin, end] {
+            const Consensus::Params& consensus_params{m_chainparams.GetConsensus()};
+            for (size_t i = begin; i < end && !pending->invalid; ++i) {
+                const CBlockHeader& header{pending->headers[i]};
+                if (!CheckProofOfWork(header.GetPoWHash_cached(), header.nBits, consensus_params)) {
+                    pending->invalid = true;
+                }
+            }
+            if (--pending->remaining == 0) m_connman.WakeMessageHandler();
+        });
+    }
+}
+
 bool PeerManagerImpl::CheckHeadersPoW(const std::vector<CBlockHeader>& headers, const Consensus::Params& consensusParams, Peer& peer)
 {
     // Do these headers have proof-of-work matching what's claimed?
@@ -3757,6 +4137,7 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
                 LogPrint(BCLog::NET, "got inv: %s  %s peer=%d\n", inv.ToString(), fAlreadyHave ? "have" : "new", pfrom.GetId());
 
                 AddKnownTx(*peer, inv.hash);
+                if (m_txreconciliation && inv.IsMsgWtx()) m_txreconciliation->TryRemovingFromSet(pfrom.GetId(), inv.hash);
                 if (!fAlreadyHave && !m_chainman.ActiveChainstate().IsInitialBlockDownload()) {
                     AddTxAnnouncement(pfrom, gtxid, current_time);
                 }
@@ -4048,6 +4429,7 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
             // ProcessGetData().
             AddKnownTx(*peer, txid);
         }
+        if (m_txreconciliation) m_txreconciliation->TryRemovingFromSet(pfrom.GetId(), wtxid);
 
         LOCK(cs_main);
 
@@ -4254,6 +4636,7 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
 
         if (!m_chainman.m_blockman.LookupBlockIndex(blockhash)) {
             received_new_header = true;
+            BlockFirstSeen(blockhash, pfrom.GetId(), time_received);
         }
         }
 
@@ -4597,22 +4980,20 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
             ReadCompactSize(vRecv); // ignore tx count; assume it is 0.
         }
 
-        ProcessHeadersMessage(pfrom, *peer, std::move(headers), /*via_compact_block=*/false);
-
-        // Check if the headers presync progress needs to be reported to validation.
-        // This needs to be done without holding the m_headers_presync_mutex lock.
-        if (m_headers_presync_should_signal.exchange(false)) {
-            HeadersPresyncStats stats;
-            {
-                LOCK(m_headers_presync_mutex);
-                auto it = m_headers_presync_stats.find(m_headers_presync_bestpeer);
-                if (it != m_headers_presync_stats.end()) stats = it->second;
-            }
-            if (stats.second) {
-                m_chainman.ReportHeadersPresync(stats.first, stats.second->first, stats.second->second);
+        if (!headers.empty() && headers.size() <= MAX_BLOCKS_TO_ANNOUNCE) {
+            // A new block announced by headers
+            const uint256 hash{headers.back().GetHash()};
+            LOCK(cs_main);
+            if (!m_chainman.m_blockman.LookupBlockIndex(hash)) {
+                BlockFirstSeen(hash, pfrom.GetId(), time_received);
             }
         }
 
+        if (headers.size() >= MIN_HEADERS_FOR_PEER_WORK && m_peer_work.NumThreads() > 0) {
+            HashHeadersPoW(*peer, std::move(headers));
+        } else {
+            ProcessReceivedHeaders(pfrom, *peer, std::move(headers));
+        }
         return;
     }
 
@@ -4642,6 +5023,9 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
             // which peers send us compact blocks, so the race between here and
             // cs_main in ProcessNewBlock is fine.
             mapBlockSource.emplace(hash, std::make_pair(pfrom.GetId(), true));
+            if (!m_chainman.m_blockman.LookupBlockIndex(hash)) {
+                BlockFirstSeen(hash, pfrom.GetId(), time_received);
+            }
 
             // Check work on this block against our anti-dos thresholds.
             const CBlockIndex* prev_block = m_chainman.m_blockman.LookupBlockIndex(pblock->hashPrevBlock);
@@ -4877,6 +5261,78 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
         return;
     }
 
+    if (msg_type == NetMsgType::REQRECON) {
+        if (!m_txreconciliation || !m_txreconciliation->IsPeerRegistered(pfrom.GetId())) {
+            LogPrint(BCLog::NET, "reqrecon from peer=%d we don't reconcile with; ignoring\n", pfrom.GetId());
+            return;
+        }
+        uint16_t peer_recon_set_size, peer_q;
+        vRecv >> peer_recon_set_size >> peer_q;
+        std::vector<uint8_t> skdata;
+        if (!m_txreconciliation->HandleReconciliationRequest(pfrom.GetId(), peer_recon_set_size, peer_q, skdata)) {
+            LogPrintLevel(BCLog::NET, BCLog::Level::Debug, "txreconciliation protocol violation from peer=%d (unexpected reqrecon); disconnecting\n", pfrom.GetId());
+            pfrom.fDisconnect = true;
+            return;
+        }
+        m_connman.PushMessage(&pfrom, msgMaker.Make(NetMsgType::SKETCH, skdata));
+        return;
+    }
+
+    if (msg_type == NetMsgType::REQSKETCHEXT) {
+        if (!m_txreconciliation || !m_txreconciliation->IsPeerRegistered(pfrom.GetId())) {
+            LogPrint(BCLog::NET, "reqsketchext from peer=%d we don't reconcile with; ignoring\n", pfrom.GetId());
+            return;
+        }
+        std::vector<uint8_t> skdata;
+        if (!m_txreconciliation->HandleExtensionRequest(pfrom.GetId(), skdata)) {
+            LogPrintLevel(BCLog::NET, BCLog::Level::Debug, "txreconciliation protocol violation from peer=%d (unexpected reqsketchext); disconnecting\n", pfrom.GetId());
+            pfrom.fDisconnect = true;
+            return;
+        }
+        m_connman.PushMessage(&pfrom, msgMaker.Make(NetMsgType::SKETCH, skdata));
+        return;
+    }
+
+    if (msg_type == NetMsgType::SKETCH) {
+        if (!m_txreconciliation || !m_txreconciliation->IsPeerRegistered(pfrom.GetId())) {
+            LogPrint(BCLog::NET, "sketch from peer=%d we don't reconcile with; ignoring\n", pfrom.GetId());
+            return;
+        }
+        std::vector<uint8_t> skdata;
+        vRecv >> skdata;
+        ReconciliationSketchResult result;
+        if (!m_txreconciliation->HandleSketch(pfrom.GetId(), skdata, result)) {
+            LogPrintLevel(BCLog::NET, BCLog::Level::Debug, "txreconciliation protocol violation from peer=%d (unexpected sketch); disconnecting\n", pfrom.GetId());
+            pfrom.fDisconnect = true;
+            return;
+        }
+        if (!result.success) {
+            m_connman.PushMessage(&pfrom, msgMaker.Make(NetMsgType::REQSKETCHEXT));
+            return;
+        }
+        m_connman.PushMessage(&pfrom, msgMaker.Make(NetMsgType::RECONCILDIFF, uint8_t{*result.success}, result.ask_shortids));
+        AnnounceReconciledTxs(pfrom, *peer, result.announce);
+        return;
+    }
+
+    if (msg_type == NetMsgType::RECONCILDIFF) {
+        if (!m_txreconciliation || !m_txreconciliation->IsPeerRegistered(pfrom.GetId())) {
+            LogPrint(BCLog::NET, "reconcildiff from peer=%d we don't reconcile with; ignoring\n", pfrom.GetId());
+            return;
+        }
+        uint8_t success;
+        std::vector<uint32_t> ask_shortids;
+        vRecv >> success >> ask_shortids;
+        std::vector<uint256> announce;
+        if (!m_txreconciliation->HandleReconciliationDifference(pfrom.GetId(), success != 0, ask_shortids, announce)) {
+            LogPrintLevel(BCLog::NET, BCLog::Level::Debug, "txreconciliation protocol violation from peer=%d (unexpected reconcildiff); disconnecting\n", pfrom.GetId());
+            pfrom.fDisconnect = true;
+            return;
+        }
+        AnnounceReconciledTxs(pfrom, *peer, announce);
+        return;
+    }
+
     if (msg_type == NetMsgType::GETCFILTERS) {
         ProcessGetCFilters(pfrom, *peer, vRecv);
         return;
@@ -4961,7 +5417,7 @@ bool PeerManagerImpl::ProcessMessages(CNode* pfrom, std::atomic<bool>& interrupt
 
     {
         LOCK(peer->m_getdata_requests_mutex);
-        if (!peer->m_getdata_requests.empty()) {
+        if (!peer->m_getdata_requests.empty() || peer->m_pending_block) {
             ProcessGetData(*pfrom, *peer, interruptMsgProc);
         }
     }
@@ -4973,6 +5429,10 @@ bool PeerManagerImpl::ProcessMessages(CNode* pfrom, std::atomic<bool>& interrupt
 
     if (processed_orphan) return true;
 
+    // A block still being read keeps the order of responses as well. The
+    // block serving thread wakes the message handler once it is read.
+    if (peer->m_pending_block) return false;
+
     // this maintains the order of responses
     // and prevents m_getdata_requests to grow unbounded
     {
@@ -4983,6 +5443,19 @@ bool PeerManagerImpl::ProcessMessages(CNode* pfrom, std::atomic<bool>& interrupt
     // Don't bother if send buffer is too full to respond anyway
     if (pfrom->fPauseSend) return false;
 
+    if (peer->m_pending_headers) {
+        // Later messages of the peer wait until all headers are hashed
+        if (peer->m_pending_headers->remaining > 0) return false;
+        const auto pending{std::move(peer->m_pending_headers)};
+        if (pending->invalid) {
+            Misbehaving(*peer, 100, "header with invalid proof of work");
+        } else {
+            // The proof of work hashes are cached in the headers now
+            ProcessReceivedHeaders(*pfrom, *peer, std::move(pending->headers));
+        }
+        return true;
+    }
+
     auto poll_result{pfrom->PollMessage()};
     if (!poll_result) {
         // No message to process
@@ -5612,15 +6085,18 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
                     LogPrint(BCLog::NET, "%s sending header-and-ids %s to peer=%d\n", __func__,
                             vHeaders.front().GetHash().ToString(), pto->GetId());
 
-                    std::optional<CSerializedNetMsg> cached_cmpctblock_msg;
+                    std::optional<SharedNetMsg> cached_cmpctblock_msg;
                     {
                         LOCK(m_most_recent_block_mutex);
                         if (m_most_recent_block_hash == pBestIndex->GetBlockHash()) {
-                            cached_cmpctblock_msg = msgMaker.Make(NetMsgType::CMPCTBLOCK, *m_most_recent_compact_block);
+                            if (!m_most_recent_compact_block_msg) {
+                                m_most_recent_compact_block_msg.emplace(msgMaker.Make(NetMsgType::CMPCTBLOCK, *m_most_recent_compact_block));
+                            }
+                            cached_cmpctblock_msg = m_most_recent_compact_block_msg;
                         }
                     }
                     if (cached_cmpctblock_msg.has_value()) {
-                        m_connman.PushMessage(pto, std::move(cached_cmpctblock_msg.value()));
+                        m_connman.PushMessage(pto, *cached_cmpctblock_msg);
                     } else {
                         CBlock block;
                         bool ret = ReadBlockFromDisk(block, pBestIndex, consensusParams);
@@ -5629,6 +6105,7 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
                         m_connman.PushMessage(pto, msgMaker.Make(NetMsgType::CMPCTBLOCK, cmpctblock));
                     }
                     state.pindexBestHeaderSent = pBestIndex;
+                    BlockAnnounced(pBestIndex->GetBlockHash());
                 } else if (peer->m_prefers_headers) {
                     if (vHeaders.size() > 1) {
                         LogPrint(BCLog::NET, "%s: %u headers, range (%s, %s), to peer=%d\n", __func__,
@@ -5641,6 +6118,7 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
                     }
                     m_connman.PushMessage(pto, msgMaker.Make(NetMsgType::HEADERS, vHeaders));
                     state.pindexBestHeaderSent = pBestIndex;
+                    BlockAnnounced(pBestIndex->GetBlockHash());
                 } else
                     fRevertToInv = true;
             }
@@ -5666,6 +6144,7 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
                         peer->m_blocks_for_inv_relay.push_back(hashToAnnounce);
                         LogPrint(BCLog::NET, "%s: sending inv peer=%d hash=%s\n", __func__,
                             pto->GetId(), hashToAnnounce.ToString());
+                        BlockAnnounced(hashToAnnounce);
                     }
                 }
             }
@@ -5756,6 +6235,7 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
                     // No reason to drain out at many times the network's capacity,
                     // especially since we have many peers and some will draw much shorter delays.
                     unsigned int nRelayedTransactions = 0;
+                    const bool reconciles_txs{m_txreconciliation && m_txreconciliation->IsPeerRegistered(pto->GetId())};
                     LOCK(tx_relay->m_bloom_filter_mutex);
                     size_t broadcast_max{INVENTORY_BROADCAST_MAX + (tx_relay->m_tx_inventory_to_send.size()/1000)*5};
                     broadcast_max = std::min<size_t>(1000, broadcast_max);
@@ -5777,54 +6257,41 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
                         if (!txinfo.tx) {
                             continue;
                         }
-                        auto txid = txinfo.tx->GetHash();
                         auto wtxid = txinfo.tx->GetWitnessHash();
                         // Peer told you to not send transactions at that feerate? Don't bother sending it.
                         if (txinfo.fee < filterrate.GetFee(txinfo.vsize)) {
                             continue;
                         }
                         if (tx_relay->m_bloom_filter && !tx_relay->m_bloom_filter->IsRelevantAndUpdate(*txinfo.tx)) continue;
+                        // Reconcile instead of announcing, unless the peer is one we keep flooding
+                        // this transaction to. If the set can't take it, fall back to flooding.
+                        if (reconciles_txs && !m_txreconciliation->ShouldFanoutTo(wtxid, pto->GetId()) &&
+                            m_txreconciliation->AddToSet(pto->GetId(), wtxid)) {
+                            continue;
+                        }
                         // Send
-                        tx_relay->m_recently_announced_invs.insert(hash);
                         vInv.push_back(inv);
                         nRelayedTransactions++;
-                        {
-                            // Expire old relay messages
-                            while (!g_relay_expiration.empty() && g_relay_expiration.front().first < current_time)
-                            {
-                                mapRelay.erase(g_relay_expiration.front().second);
-                                g_relay_expiration.pop_front();
-                            }
-
-                            auto ret = mapRelay.emplace(txid, std::move(txinfo.tx));
-                            if (ret.second) {
-                                g_relay_expiration.emplace_back(current_time + RELAY_TX_CACHE_TIME, ret.first);
-                            }
-                            // Add wtxid-based lookup into mapRelay as well, so that peers can request by wtxid
-                            auto ret2 = mapRelay.emplace(wtxid, ret.first->second);
-                            if (ret2.second) {
-                                g_relay_expiration.emplace_back(current_time + RELAY_TX_CACHE_TIME, ret2.first);
-                            }
-                        }
+                        RecordTxAnnouncement(*tx_relay, std::move(txinfo.tx), hash, current_time);
                         if (vInv.size() == MAX_INV_SZ) {
                             m_connman.PushMessage(pto, msgMaker.Make(NetMsgType::INV, vInv));
                             vInv.clear();
                         }
-                        tx_relay->m_tx_inventory_known_filter.insert(hash);
-                        if (hash != txid) {
-                            // Insert txid into m_tx_inventory_known_filter, even for
-                            // wtxidrelay peers. This prevents re-adding of
-                            // unconfirmed parents to the recently_announced
-                            // filter, when a child tx is requested. See
-                            // ProcessGetData().
-                            tx_relay->m_tx_inventory_known_filter.insert(txid);
-                        }
                     }
                 }
         }
         if (!vInv.empty())
             m_connman.PushMessage(pto, msgMaker.Make(NetMsgType::INV, vInv));
 
+        //
+        // Message: reqrecon
+        //
+        if (m_txreconciliation) {
+            if (const auto request{m_txreconciliation->InitiateReconciliationRequest(pto->GetId(), current_time)}) {
+                m_connman.PushMessage(pto, msgMaker.Make(NetMsgType::REQRECON, request->first, request->second));
+            }
+        }
+
         // Detect whether we're stalling
         auto stalling_timeout = m_block_stalling_timeout.load();
         if (state.m_stalling_since.count() && state.m_stalling_since < current_time - stalling_timeout) {
@@ -9,6 +9,9 @@
 #include <net.h>
 #include <validationinterface.h>
 
+#include <array>
+#include <chrono>
+
 class AddrMan;
 class CChainParams;
 class CTxMemPool;
@@ -24,6 +27,22 @@ static const bool DEFAULT_PEERBLOCKFILTERS = false;
 static const int DISCOURAGEMENT_THRESHOLD{100};
 /** Maximum number of outstanding CMPCTBLOCK requests for the same block. */
 static const unsigned int MAX_CMPCTBLOCKS_INFLIGHT_PER_BLOCK = 3;
+/** Default for -peerworkthreads, threads doing peer-local message work off the message handler thread */
+static constexpr int DEFAULT_PEER_WORK_THREADS{2};
+static constexpr int MAX_PEER_WORK_THREADS{16};
+/** Default for -blockservethreads, threads reading blocks requested by peers from disk */
+static constexpr int DEFAULT_BLOCK_SERVE_THREADS{4};
+static constexpr int MAX_BLOCK_SERVE_THREADS{16};
+
+/** Histogram of the time from receiving the header of a new block to first announcing
+ *  the block to our peers, the delay a block takes through this node. */
+struct BlockRelayLatency {
+    /** Upper bounds of the buckets in milliseconds. The last bucket counts the slower blocks. */
+    static constexpr std::array<int64_t, 12> BUCKETS_MS{1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000};
+    std::array<uint64_t, BUCKETS_MS.size() + 1> m_counts{};
+
+    void Add(std::chrono::microseconds latency);
+};
 
 struct CNodeStateStats {
     int nSyncHeight = -1;
@@ -38,6 +57,8 @@ struct CNodeStateStats {
     bool m_addr_relay_enabled{false};
     ServiceFlags their_services;
     int64_t presync_height{-1};
+    /** Of the blocks whose header this peer sent us first */
+    BlockRelayLatency m_block_relay_latency;
 };
 
 class PeerManager : public CValidationInterface, public NetEventsInterface
@@ -63,6 +84,9 @@ public:
     /** Get statistics from node state */
     virtual bool GetNodeStateStats(NodeId nodeid, CNodeStateStats& stats) const = 0;
 
+    /** Get the relay latency of all blocks received from peers */
+    virtual BlockRelayLatency GetBlockRelayLatency() const = 0;
+
     /** Whether this node ignores txs received over p2p. */
     virtual bool IgnoresIncomingTxs() = 0;
 
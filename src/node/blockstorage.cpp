@@ -7,6 +7,7 @@
 #include <chain.h>
 #include <clientversion.h>
 #include <consensus/validation.h>
+#include <crypto/common.h>
 #include <flatfile.h>
 #include <hash.h>
 #include <logging.h>
@@ -56,6 +57,82 @@ static FILE* OpenUndoFile(const FlatFilePos& pos, bool fReadOnly = false);
 static FlatFileSeq BlockFileSeq();
 static FlatFileSeq UndoFileSeq();
 
+/** Upper bound on the number of blk/rev files kept mapped at the same time. */
+static constexpr size_t MAX_MAPPED_BLOCK_FILES{1024};
+
+/**
+ * Number of leading block files that BlockManager no longer appends blocks to
+ * (everything before its last block file). Only those are memory mapped.
+ */
+static std::atomic<int> g_finalized_block_files{0};
+
+/**
+ * Read-only mappings of the blk?????.dat or rev?????.dat files, used to serve
+ * reads without opening, seeking and reading the file each time (-blockmmap).
+ *
+ * Undo data can still be appended to the rev file of a finalized block file,
+ * and both files are truncated when they are finalized. A mapping therefore
+ * only serves records that lie entirely within it; anything else drops the
+ * mapping and is read through the regular file path, and the mapping of a file
+ * is dropped before it is flushed with finalize or pruned.
+ */
+class BlockFileMappings
+{
+private:
+    FlatFileSeq (*const m_file_seq)();
+    Mutex m_mutex;
+    std::map<int, std::shared_ptr<const FlatFileMapping>> m_mappings GUARDED_BY(m_mutex);
+
+public:
+    explicit BlockFileMappings(FlatFileSeq (*file_seq)()) : m_file_seq{file_seq} {}
+
+    /**
+     * Look up the record whose data starts at pos, including its serialization
+     * header and trailer_size bytes following the data. Returns an empty span
+     * if the record cannot be served from a mapping; otherwise the span stays
+     * valid for as long as mapping is held.
+     */
+    Span<const unsigned char> Record(const FlatFilePos& pos, size_t trailer_size, std::shared_ptr<const FlatFileMapping>& mapping) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        if (sizeof(void*) < 8 || pos.IsNull() || pos.nFile >= g_finalized_block_files.load() ||
+            pos.nPos < BLOCK_SERIALIZATION_HEADER_SIZE || !gArgs.GetBoolArg("-blockmmap", DEFAULT_BLOCKMMAP)) {
+            return {};
+        }
+        {
+            LOCK(m_mutex);
+            auto it = m_mappings.find(pos.nFile);
+            if (it == m_mappings.end()) {
+                if (m_mappings.size() >= MAX_MAPPED_BLOCK_FILES) return {};
+                auto new_mapping{m_file_seq().Map(pos)};
+                if (!new_mapping) return {};
+                it = m_mappings.emplace(pos.nFile, std::move(new_mapping)).first;
+            }
+            mapping = it->second;
+        }
+        const Span<const unsigned char> data{mapping->Data()};
+        if (pos.nPos <= data.size()) {
+            const uint64_t data_size{ReadLE32(data.data() + pos.nPos - sizeof(unsigned int))};
+            const uint64_t record_end{pos.nPos + data_size + trailer_size};
+            if (data_size <= MAX_SIZE && record_end <= data.size()) {
+                return data.subspan(pos.nPos - BLOCK_SERIALIZATION_HEADER_SIZE, record_end - pos.nPos + BLOCK_SERIALIZATION_HEADER_SIZE);
+            }
+        }
+        // The file may have grown since it was mapped; map it again on the next read.
+        Invalidate(pos.nFile);
+        mapping.reset();
+        return {};
+    }
+
+    void Invalidate(int file) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        LOCK(m_mutex);
+        m_mappings.erase(file);
+    }
+};
+
+static BlockFileMappings g_block_file_mappings{BlockFileSeq};
+static BlockFileMappings g_undo_file_mappings{UndoFileSeq};
+
 std::vector<CBlockIndex*> BlockManager::GetAllBlockIndices()
 {
     AssertLockHeld(cs_main);
@@ -325,6 +402,7 @@ bool BlockManager::LoadBlockIndexDB(const Consensus::Params& consensus_params)
 
     // Load block file info
     m_block_tree_db->ReadLastBlockFile(m_last_blockfile);
+    g_finalized_block_files = m_last_blockfile;
     m_blockfile_info.resize(m_last_blockfile + 1);
     LogPrintf("%s: last block file = %i\n", __func__, m_last_blockfile);
     for (int nFile = 0; nFile <= m_last_blockfile; nFile++) {
@@ -505,25 +583,14 @@ static bool UndoWriteToDisk(const CBlockUndo& blockundo, FlatFilePos& pos, const
     return true;
 }
 
-bool UndoReadFromDisk(CBlockUndo& blockundo, const CBlockIndex* pindex)
+template <typename Stream>
+static bool ReadUndoRecord(Stream& filein, CBlockUndo& blockundo, const uint256& hash_prev_block)
 {
-    const FlatFilePos pos{WITH_LOCK(::cs_main, return pindex->GetUndoPos())};
-
-    if (pos.IsNull()) {
-        return error("%s: no undo data available", __func__);
-    }
-
-    // Open history file to read
-    AutoFile filein{OpenUndoFile(pos, true)};
-    if (filein.IsNull()) {
-        return error("%s: OpenUndoFile failed", __func__);
-    }
-
     // Read block
     uint256 hashChecksum;
     HashVerifier verifier{filein}; // Use HashVerifier as reserializing may lose data, c.f. commit d342424301013ec47dc146a4beb49d5c9319d80a
     try {
-        verifier << pindex->pprev->GetBlockHash();
+        verifier << hash_prev_block;
         verifier >> blockundo;
         filein >> hashChecksum;
     } catch (const std::exception& e) {
@@ -538,9 +605,33 @@ bool UndoReadFromDisk(CBlockUndo& blockundo, const CBlockIndex* pindex)
     return true;
 }
 
+bool UndoReadFromDisk(CBlockUndo& blockundo, const CBlockIndex* pindex)
+{
+    const FlatFilePos pos{WITH_LOCK(::cs_main, return pindex->GetUndoPos())};
+
+    if (pos.IsNull()) {
+        return error("%s: no undo data available", __func__);
+    }
+
+    std::shared_ptr<const FlatFileMapping> mapping;
+    const auto record{g_undo_file_mappings.Record(pos, /*trailer_size=*/sizeof(uint256), mapping)};
+    if (!record.empty()) {
+        SpanReader filein{SER_DISK, CLIENT_VERSION, record.subspan(BLOCK_SERIALIZATION_HEADER_SIZE)};
+        return ReadUndoRecord(filein, blockundo, pindex->pprev->GetBlockHash());
+    }
+
+    // Open history file to read
+    AutoFile filein{OpenUndoFile(pos, true)};
+    if (filein.IsNull()) {
+        return error("%s: OpenUndoFile failed", __func__);
+    }
+    return ReadUndoRecord(filein, blockundo, pindex->pprev->GetBlockHash());
+}
+
 void BlockManager::FlushUndoFile(int block_file, bool finalize)
 {
     FlatFilePos undo_pos_old(block_file, m_blockfile_info[block_file].nUndoSize);
+    if (finalize) g_undo_file_mappings.Invalidate(block_file);
     if (!UndoFileSeq().Flush(undo_pos_old, finalize)) {
         AbortNode("Flushing undo file to disk failed. This is likely the result of an I/O error.");
     }
@@ -560,6 +651,7 @@ void BlockManager::FlushBlockFile(bool fFinalize, bool finalize_undo)
     assert(static_cast<int>(m_blockfile_info.size()) > m_last_blockfile);
 
     FlatFilePos block_pos_old(m_last_blockfile, m_blockfile_info[m_last_blockfile].nSize);
+    if (fFinalize) g_block_file_mappings.Invalidate(m_last_blockfile);
     if (!BlockFileSeq().Flush(block_pos_old, fFinalize)) {
         AbortNode("Flushing block file to disk failed. This is likely the result of an I/O error.");
     }
@@ -584,6 +676,8 @@ void UnlinkPrunedFiles(const std::set<int>& setFilesToPrune)
     std::error_code ec;
     for (std::set<int>::iterator it = setFilesToPrune.begin(); it != setFilesToPrune.end(); ++it) {
         FlatFilePos pos(*it, 0);
+        g_block_file_mappings.Invalidate(*it);
+        g_undo_file_mappings.Invalidate(*it);
         const bool removed_blockfile{fs::remove(BlockFileSeq().FileName(pos), ec)};
         const bool removed_undofile{fs::remove(UndoFileSeq().FileName(pos), ec)};
         if (removed_blockfile || removed_undofile) {
@@ -649,6 +743,7 @@ bool BlockManager::FindBlockPos(FlatFilePos& pos, unsigned int nAddSize, unsigne
         }
         FlushBlockFile(!fKnown, finalize_undo);
         m_last_blockfile = nFile;
+        g_finalized_block_files = m_last_blockfile;
     }
 
     m_blockfile_info[nFile].AddBlock(nHeight, nTime);
@@ -748,25 +843,30 @@ bool BlockManager::WriteUndoDataForBlock(const CBlockUndo& blockundo, BlockValid
     return true;
 }
 
-bool ReadBlockFromDisk(CBlock& block, const FlatFilePos& pos, const Consensus::Params& consensusParams)
+static bool ReadBlockFromDisk(CBlock& block, const FlatFilePos& pos, const Consensus::Params& consensusParams, bool check_pow)
 {
     block.SetNull();
 
-    // Open history file to read
-    CAutoFile filein(OpenBlockFile(pos, true), SER_DISK, CLIENT_VERSION);
-    if (filein.IsNull()) {
-        return error("ReadBlockFromDisk: OpenBlockFile failed for %s", pos.ToString());
-    }
-
-    // Read block
+    // Read block, directly from the mapped file if possible
     try {
-        filein >> block;
+        std::shared_ptr<const FlatFileMapping> mapping;
+        const auto record{g_block_file_mappings.Record(pos, /*trailer_size=*/0, mapping)};
+        if (!record.empty()) {
+            SpanReader{SER_DISK, CLIENT_VERSION, record.subspan(BLOCK_SERIALIZATION_HEADER_SIZE)} >> block;
+        } else {
+            // Open history file to read
+            CAutoFile filein(OpenBlockFile(pos, true), SER_DISK, CLIENT_VERSION);
+            if (filein.IsNull()) {
+                return error("ReadBlockFromDisk: OpenBlockFile failed for %s", pos.ToString());
+            }
+            filein >> block;
+        }
     } catch (const std::exception& e) {
         return error("%s: Deserialize or I/O error - %s at %s", __func__, e.what(), pos.ToString());
     }
 
     // Check the header
-    if (!CheckProofOfWork(block.GetPoWHash_cached(), block.nBits, consensusParams)) {
+    if (check_pow && !CheckProofOfWork(block.GetPoWHash_cached(), block.nBits, consensusParams)) {
         return error("ReadBlockFromDisk: Errors in block header at %s", pos.ToString());
     }
 
@@ -778,11 +878,18 @@ bool ReadBlockFromDisk(CBlock& block, const FlatFilePos& pos, const Consensus::P
     return true;
 }
 
+bool ReadBlockFromDisk(CBlock& block, const FlatFilePos& pos, const Consensus::Params& consensusParams)
+{
+    return ReadBlockFromDisk(block, pos, consensusParams, /*check_pow=*/true);
+}
+
 bool ReadBlockFromDisk(CBlock& block, const CBlockIndex* pindex, const Consensus::Params& consensusParams)
 {
     const FlatFilePos block_pos{WITH_LOCK(cs_main, return pindex->GetBlockPos())};
 
-    if (!ReadBlockFromDisk(block, block_pos, consensusParams)) {
+    // Blocks are only written after their proof of work was checked, so matching the
+    // hash of the index entry is enough, without computing the proof of work again.
+    if (!ReadBlockFromDisk(block, block_pos, consensusParams, /*check_pow=*/false)) {
         return false;
     }
     if (block.GetHash() != pindex->GetBlockHash()) {
@@ -794,6 +901,17 @@ bool ReadBlockFromDisk(CBlock& block, const CBlockIndex* pindex, const Consensus
 
 bool ReadRawBlockFromDisk(std::vector<uint8_t>& block, const FlatFilePos& pos, const CMessageHeader::MessageStartChars& message_start)
 {
+    std::shared_ptr<const FlatFileMapping> mapping;
+    if (const auto record{g_block_file_mappings.Record(pos, /*trailer_size=*/0, mapping)}; !record.empty()) {
+        if (memcmp(record.data(), message_start, CMessageHeader::MESSAGE_START_SIZE)) {
+            return error("%s: Block magic mismatch for %s: %s versus expected %s", __func__, pos.ToString(),
+                         HexStr(record.first(CMessageHeader::MESSAGE_START_SIZE)),
+                         HexStr(message_start));
+        }
+        block.assign(record.begin() + BLOCK_SERIALIZATION_HEADER_SIZE, record.end());
+        return true;
+    }
+
     FlatFilePos hpos = pos;
     hpos.nPos -= 8; // Seek back 8 bytes for meta header
     AutoFile filein{OpenBlockFile(hpos, true)};
@@ -827,6 +945,28 @@ bool ReadRawBlockFromDisk(std::vector<uint8_t>& block, const FlatFilePos& pos, c
     return true;
 }
 
+bool ReadRawBlockFromDisk(std::vector<uint8_t>& block, const CBlockIndex* pindex, const CMessageHeader::MessageStartChars& message_start, bool check_hash)
+{
+    const FlatFilePos block_pos{WITH_LOCK(cs_main, return pindex->GetBlockPos())};
+
+    if (!ReadRawBlockFromDisk(block, block_pos, message_start)) {
+        return false;
+    }
+    if (check_hash) {
+        CBlockHeaderUncached header;
+        try {
+            SpanReader{SER_DISK, CLIENT_VERSION, block} >> header;
+        } catch (const std::exception& e) {
+            return error("%s: Deserialize error - %s at %s", __func__, e.what(), block_pos.ToString());
+        }
+        if (header.GetHash() != pindex->GetBlockHash()) {
+            return error("%s: GetHash() doesn't match index for %s at %s", __func__,
+                         pindex->ToString(), block_pos.ToString());
+        }
+    }
+    return true;
+}
+
 FlatFilePos BlockManager::SaveBlockToDisk(const CBlock& block, int nHeight, CChain& active_chain, const CChainParams& chainparams, const FlatFilePos* dbp)
 {
     unsigned int nBlockSize = ::GetSerializeSize(block, CLIENT_VERSION);
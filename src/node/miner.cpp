@@ -89,6 +89,33 @@ static BlockAssembler::Options ConfiguredOptions()
 BlockAssembler::BlockAssembler(Chainstate& chainstate, const CTxMemPool* mempool)
     : BlockAssembler(chainstate, mempool, ConfiguredOptions()) {}
 
+/** Create the coinbase transaction and fill in the header of a template whose transactions have been selected */
+static void FinishBlockTemplate(CBlockTemplate& block_template, ChainstateManager& chainman, const CBlockIndex* pindexPrev, const CScript& scriptPubKeyIn, CAmount fees)
+{
+    const Consensus::Params& consensus_params{chainman.GetConsensus()};
+    const int height{pindexPrev->nHeight + 1};
+    CBlock* const pblock = &block_template.block; // pointer for convenience
+
+    // Create coinbase transaction.
+    CMutableTransaction coinbaseTx;
+    coinbaseTx.vin.resize(1);
+    coinbaseTx.vin[0].prevout.SetNull();
+    coinbaseTx.vout.resize(1);
+    coinbaseTx.vout[0].scriptPubKey = scriptPubKeyIn;
+    coinbaseTx.vout[0].nValue = fees + GetBlockSubsidy(height, consensus_params);
+    coinbaseTx.vin[0].scriptSig = CScript() << height << OP_0;
+    pblock->vtx[0] = MakeTransactionRef(std::move(coinbaseTx));
+    block_template.vchCoinbaseCommitment = chainman.GenerateCoinbaseCommitment(*pblock, pindexPrev);
+    block_template.vTxFees[0] = -fees;
+
+    // Fill in header
+    pblock->hashPrevBlock  = pindexPrev->GetBlockHash();
+    UpdateTime(pblock, consensus_params, pindexPrev);
+    pblock->nBits          = GetNextWorkRequired(pindexPrev, pblock, consensus_params);
+    pblock->nNonce         = 0;
+    block_template.vTxSigOpsCost[0] = WITNESS_SCALE_FACTOR * GetLegacySigOpCount(*pblock->vtx[0]);
+}
+
 void BlockAssembler::resetBlock()
 {
     inBlock.clear();
@@ -147,27 +174,10 @@ std::unique_ptr<CBlockTemplate> BlockAssembler::CreateNewBlock(const CScript& sc
     m_last_block_num_txs = nBlockTx;
     m_last_block_weight = nBlockWeight;
 
-    // Create coinbase transaction.
-    CMutableTransaction coinbaseTx;
-    coinbaseTx.vin.resize(1);
-    coinbaseTx.vin[0].prevout.SetNull();
-    coinbaseTx.vout.resize(1);
-    coinbaseTx.vout[0].scriptPubKey = scriptPubKeyIn;
-    coinbaseTx.vout[0].nValue = nFees + GetBlockSubsidy(nHeight, chainparams.GetConsensus());
-    coinbaseTx.vin[0].scriptSig = CScript() << nHeight << OP_0;
-    pblock->vtx[0] = MakeTransactionRef(std::move(coinbaseTx));
-    pblocktemplate->vchCoinbaseCommitment = m_chainstate.m_chainman.GenerateCoinbaseCommitment(*pblock, pindexPrev);
-    pblocktemplate->vTxFees[0] = -nFees;
+    FinishBlockTemplate(*pblocktemplate, m_chainstate.m_chainman, pindexPrev, scriptPubKeyIn, nFees);
 
     LogPrintf("CreateNewBlock(): block weight: %u txs: %u fees: %ld sigops %d\n", GetBlockWeight(*pblock), nBlockTx, nFees, nBlockSigOpsCost);
 
-    // Fill in header
-    pblock->hashPrevBlock  = pindexPrev->GetBlockHash();
-    UpdateTime(pblock, chainparams.GetConsensus(), pindexPrev);
-    pblock->nBits          = GetNextWorkRequired(pindexPrev, pblock, chainparams.GetConsensus());
-    pblock->nNonce         = 0;
-    pblocktemplate->vTxSigOpsCost[0] = WITNESS_SCALE_FACTOR * GetLegacySigOpCount(*pblock->vtx[0]);
-
     BlockValidationState state;
     if (m_options.test_block_validity && !TestBlockValidity(state, chainparams, m_chainstate, *pblock, pindexPrev,
                                                   GetAdjustedTime, /*fCheckPOW=*/false, /*fCheckMerkleRoot=*/false)) {
@@ -427,4 +437,226 @@ void BlockAssembler::addPackageTxs(const CTxMemPool& mempool, int& nPackagesSele
         nDescendantsUpdated += UpdatePackagesForAdded(mempool, ancestors, mapModifiedTx);
     }
 }
+
+BlockTemplateManager::BlockTemplateManager(ChainstateManager& chainman, const CTxMemPool& mempool, const BlockAssembler::Options& options)
+    : m_chainman{chainman},
+      m_mempool{mempool},
+      m_options{ClampOptions(options)}
+{
+}
+
+void BlockTemplateManager::Rebuild(Chainstate& chainstate)
+{
+    AssertLockHeld(::cs_main);
+    AssertLockHeld(m_mempool.cs);
+    AssertLockHeld(m_mutex);
+
+    m_stale = true;
+    m_template = BlockAssembler{chainstate, &m_mempool, m_options}.CreateNewBlock(CScript() << OP_TRUE);
+    m_prev = chainstate.m_chain.Tip();
+    m_mempool_sequence = m_mempool.GetSequence();
+    m_transactions_updated = m_mempool.GetTransactionsUpdated();
+    m_height = m_prev->nHeight + 1;
+    m_lock_time_cutoff = m_prev->GetMedianTimePast();
+
+    const CBlock& block{m_template->block};
+    m_txids.clear();
+    m_block_weight = 4000;
+    m_block_sigops_cost = 400;
+    m_fees = -m_template->vTxFees[0];
+    m_min_feerate = CFeeRate{MAX_MONEY};
+    for (size_t i = 1; i < block.vtx.size(); ++i) {
+        m_txids.insert(block.vtx[i]->GetHash());
+        m_block_weight += GetTransactionWeight(*block.vtx[i]);
+        m_block_sigops_cost += m_template->vTxSigOpsCost[i];
+        if (auto it{m_mempool.GetIter(block.vtx[i]->GetHash())}) {
+            m_min_feerate = std::min(m_min_feerate, CFeeRate{(*it)->GetModifiedFee(), static_cast<uint32_t>((*it)->GetTxSize())});
+        }
+    }
+    m_left_out = m_txids.size() < m_mempool.size();
+    m_stale = false;
+}
+
+bool BlockTemplateManager::ApplySequence(uint64_t mempool_sequence)
+{
+    AssertLockHeld(m_mutex);
+
+    if (!m_template || m_stale || mempool_sequence < m_mempool_sequence) {
+        // Nothing to maintain, or already reflected in the template.
+        return false;
+    }
+    if (mempool_sequence != m_mempool_sequence) {
+        // Notifications were skipped (e.g. for transactions included in a block).
+        m_stale = true;
+        return false;
+    }
+    ++m_mempool_sequence;
+    ++m_transactions_updated;
+    return true;
+}
+
+void BlockTemplateManager::Publish()
+{
+    AssertLockHeld(m_mempool.cs);
+    AssertLockHeld(m_mutex);
+
+    ++m_update_id;
+    m_published_fees = m_fees;
+    m_published_transactions_updated = m_mempool.GetTransactionsUpdated();
+    m_update_cv.notify_all();
+}
+
+void BlockTemplateManager::LeaveOut(const CFeeRate& feerate)
+{
+    AssertLockHeld(m_mempool.cs);
+    AssertLockHeld(m_mutex);
+
+    m_left_out = true;
+    if (!m_stale && m_min_feerate < feerate) {
+        // A rebuild would pay more; let long-polling callers pick it up.
+        m_stale = true;
+        Publish();
+    }
+}
+
+void BlockTemplateManager::TransactionAddedToMempool(const CTransactionRef& tx, uint64_t mempool_sequence)
+{
+    LOCK2(m_mempool.cs, m_mutex);
+    if (!ApplySequence(mempool_sequence)) return;
+
+    const auto it{m_mempool.GetIter(tx->GetHash())};
+    if (!it) return; // Already removed again; the removal is not applied either.
+    const CTxMemPoolEntry& entry{**it};
+
+    const CFeeRate feerate{entry.GetModifiedFee(), static_cast<uint32_t>(entry.GetTxSize())};
+    if (feerate < m_options.blockMinFeeRate) {
+        m_left_out = true;
+        return;
+    }
+    for (const CTxMemPoolEntry& parent : entry.GetMemPoolParentsConst()) {
+        if (!m_txids.count(parent.GetTx().GetHash())) {
+            return LeaveOut(feerate);
+        }
+    }
+    if (m_block_weight + WITNESS_SCALE_FACTOR * entry.GetTxSize() >= m_options.nBlockMaxWeight ||
+        m_block_sigops_cost + entry.GetSigOpCost() >= MAX_BLOCK_SIGOPS_COST ||
+        !IsFinalTx(entry.GetTx(), m_height, m_lock_time_cutoff)) {
+        return LeaveOut(feerate);
+    }
+
+    m_template->block.vtx.emplace_back(entry.GetSharedTx());
+    m_template->vTxFees.push_back(entry.GetFee());
+    m_template->vTxSigOpsCost.push_back(entry.GetSigOpCost());
+    m_txids.insert(tx->GetHash());
+    m_block_weight += entry.GetTxWeight();
+    m_block_sigops_cost += entry.GetSigOpCost();
+    m_fees += entry.GetFee();
+    m_min_feerate = std::min(m_min_feerate, feerate);
+
+    if (m_fees - m_published_fees >= std::max<CAmount>(m_published_fees / 100, 1)) {
+        Publish();
+    }
+}
+
+void BlockTemplateManager::TransactionRemovedFromMempool(const CTransactionRef& tx, MemPoolRemovalReason reason, uint64_t mempool_sequence)
+{
+    LOCK(m_mutex);
+    if (!ApplySequence(mempool_sequence)) return;
+    if (!m_txids.erase(tx->GetHash())) return;
+
+    // Descendants are removed from the mempool as well, with their own notifications.
+    auto& vtx{m_template->block.vtx};
+    const auto pos{std::find_if(vtx.begin() + 1, vtx.end(), [&](const CTransactionRef& block_tx) { return block_tx->GetHash() == tx->GetHash(); }) - vtx.begin()};
+    assert(pos < static_cast<ptrdiff_t>(vtx.size()));
+    m_block_weight -= GetTransactionWeight(*tx);
+    m_block_sigops_cost -= m_template->vTxSigOpsCost[pos];
+    m_fees -= m_template->vTxFees[pos];
+    vtx.erase(vtx.begin() + pos);
+    m_template->vTxFees.erase(m_template->vTxFees.begin() + pos);
+    m_template->vTxSigOpsCost.erase(m_template->vTxSigOpsCost.begin() + pos);
+
+    // The freed space could be used by a transaction that was left out.
+    if (m_left_out) m_stale = true;
+}
+
+std::unique_ptr<CBlockTemplate> BlockTemplateManager::GetTemplate(const CScript& scriptPubKeyIn)
+{
+    LOCK2(::cs_main, m_mempool.cs);
+    LOCK(m_mutex);
+
+    Chainstate& chainstate{m_chainman.ActiveChainstate()};
+    const CBlockIndex* pindexPrev{chainstate.m_chain.Tip()};
+    assert(pindexPrev != nullptr);
+    if (!m_template || m_stale || m_prev != pindexPrev ||
+        (m_mempool_sequence == m_mempool.GetSequence() && m_transactions_updated != m_mempool.GetTransactionsUpdated())) {
+        Rebuild(chainstate);
+    }
+
+    auto block_template{std::make_unique<CBlockTemplate>(*m_template)};
+    block_template->block.nTime = TicksSinceEpoch<std::chrono::seconds>(GetAdjustedTime());
+    FinishBlockTemplate(*block_template, m_chainman, pindexPrev, scriptPubKeyIn, m_fees);
+
+    BlockAssembler::m_last_block_num_txs = block_template->block.vtx.size() - 1;
+    BlockAssembler::m_last_block_weight = m_block_weight;
+    m_published_fees = m_fees;
+
+    return block_template;
+}
+
+void BlockTemplateManager::UpdatedBlockTip(const CBlockIndex* pindexNew, const CBlockIndex* pindexFork, bool fInitialDownload)
+{
+    if (fInitialDownload || WITH_LOCK(m_mutex, return m_template == nullptr)) {
+        // Nobody mines on top of this tip yet; waiters build their own template.
+        LOCK2(m_mempool.cs, m_mutex);
+        Publish();
+        return;
+    }
+
+    LOCK2(::cs_main, m_mempool.cs);
+    LOCK(m_mutex);
+    Chainstate& chainstate{m_chainman.ActiveChainstate()};
+    if (m_stale || m_prev != chainstate.m_chain.Tip()) {
+        try {
+            Rebuild(chainstate);
+        } catch (const std::runtime_error& e) {
+            // Left stale, so the next request retries and reports the error.
+            LogPrintf("%s: failed to rebuild block template: %s\n", __func__, e.what());
+        }
+    }
+    Publish();
+}
+
+uint64_t BlockTemplateManager::GetUpdateId()
+{
+    return WITH_LOCK(m_mutex, return m_update_id);
+}
+
+bool BlockTemplateManager::WaitForUpdate(uint64_t update_id)
+{
+    auto checktxtime{std::chrono::steady_clock::now() + std::chrono::minutes(1)};
+    while (true) {
+        {
+            WAIT_LOCK(m_mutex, lock);
+            while (m_update_id == update_id && !m_interrupted) {
+                if (m_update_cv.wait_until(lock, checktxtime) == std::cv_status::timeout) break;
+            }
+            if (m_update_id != update_id || m_interrupted) return !m_interrupted;
+        }
+        // Timeout: publish any mempool change since the last update. This
+        // needs the mempool lock, which is acquired before m_mutex.
+        LOCK2(m_mempool.cs, m_mutex);
+        if (m_update_id == update_id && m_mempool.GetTransactionsUpdated() != m_published_transactions_updated) {
+            Publish();
+            return true;
+        }
+        checktxtime += std::chrono::seconds(10);
+    }
+}
+
+void BlockTemplateManager::Interrupt()
+{
+    LOCK(m_mutex);
+    m_interrupted = true;
+    m_update_cv.notify_all();
+}
 } // namespace node
@@ -8,11 +8,17 @@
 
 #include <policy/policy.h>
 #include <primitives/block.h>
+#include <sync.h>
 #include <txmempool.h>
+#include <util/hasher.h>
+#include <validationinterface.h>
 
+#include <atomic>
+#include <condition_variable>
 #include <memory>
 #include <optional>
 #include <stdint.h>
+#include <unordered_set>
 
 #include <boost/multi_index/ordered_index.hpp>
 #include <boost/multi_index_container.hpp>
@@ -195,6 +201,102 @@ private:
     void SortForBlock(const CTxMemPool::setEntries& package, std::vector<CTxMemPool::txiter>& sortedEntries);
 };
 
+/**
+ * Maintains a block template on top of the active chain tip and keeps it up to
+ * date with mempool additions and removals, so that a template can be handed
+ * out without running the package selection of BlockAssembler again.
+ *
+ * A transaction entering the mempool is appended to the template when all its
+ * in-mempool parents are already in it and it fits. A transaction leaving the
+ * mempool is taken out of the template. When a delta could change which
+ * packages are selected (a better paying transaction that doesn't fit or
+ * depends on a transaction left out, or freed space while transactions were
+ * left out), the template is rebuilt from scratch on the next request instead,
+ * as it is when the tip changes. Fee deltas from prioritisetransaction are
+ * picked up by a rebuild as well.
+ *
+ * BlockAssembler::Options::test_block_validity only applies to the rebuilds;
+ * transactions appended afterwards were accepted to the mempool on top of the
+ * same tip as the rest of the template.
+ *
+ * Changes that matter to miners (a new tip, or fees growing by at least 1%) are
+ * published under a new update id, waking up all long-polling callers at once.
+ * Once a template is in use, it is rebuilt for a new tip before the update is
+ * published, so that the woken callers share that template.
+ */
+class BlockTemplateManager final : public CValidationInterface
+{
+private:
+    ChainstateManager& m_chainman;
+    const CTxMemPool& m_mempool;
+    const BlockAssembler::Options m_options;
+
+    Mutex m_mutex;
+    //! Template with a placeholder coinbase; nullptr until the first request
+    std::unique_ptr<CBlockTemplate> m_template GUARDED_BY(m_mutex);
+    //! Block the template builds on
+    const CBlockIndex* m_prev GUARDED_BY(m_mutex){nullptr};
+    //! Set when the template has to be rebuilt before it is handed out again
+    bool m_stale GUARDED_BY(m_mutex){true};
+    //! Mempool sequence number of the next add or remove notification to apply
+    uint64_t m_mempool_sequence GUARDED_BY(m_mutex){0};
+    //! Expected CTxMemPool::GetTransactionsUpdated(), to detect fee deltas
+    unsigned int m_transactions_updated GUARDED_BY(m_mutex){0};
+    std::unordered_set<uint256, SaltedTxidHasher> m_txids GUARDED_BY(m_mutex);
+    uint64_t m_block_weight GUARDED_BY(m_mutex){0};
+    int64_t m_block_sigops_cost GUARDED_BY(m_mutex){0};
+    CAmount m_fees GUARDED_BY(m_mutex){0};
+    //! Lowest feerate of a transaction in the template
+    CFeeRate m_min_feerate GUARDED_BY(m_mutex);
+    //! Whether mempool transactions were left out of the template
+    bool m_left_out GUARDED_BY(m_mutex){false};
+    int m_height GUARDED_BY(m_mutex){0};
+    int64_t m_lock_time_cutoff GUARDED_BY(m_mutex){0};
+
+    //! Incremented whenever an update is published to long-polling callers
+    uint64_t m_update_id GUARDED_BY(m_mutex){0};
+    //! Template fees as of the last published update or handed out template
+    CAmount m_published_fees GUARDED_BY(m_mutex){0};
+    //! CTxMemPool::GetTransactionsUpdated() as of the last published update
+    unsigned int m_published_transactions_updated GUARDED_BY(m_mutex){0};
+    std::condition_variable m_update_cv;
+    std::atomic<bool> m_interrupted{false};
+
+    void Rebuild(Chainstate& chainstate) EXCLUSIVE_LOCKS_REQUIRED(::cs_main, m_mempool.cs, m_mutex);
+    /** Wake up callers waiting for an update */
+    void Publish() EXCLUSIVE_LOCKS_REQUIRED(m_mempool.cs, m_mutex);
+    /** Whether a notification with this sequence number is the next one to apply */
+    bool ApplySequence(uint64_t mempool_sequence) EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+    /** A transaction that could not be appended has the given feerate */
+    void LeaveOut(const CFeeRate& feerate) EXCLUSIVE_LOCKS_REQUIRED(m_mempool.cs, m_mutex);
+
+protected:
+    void TransactionAddedToMempool(const CTransactionRef& tx, uint64_t mempool_sequence) override;
+    void TransactionRemovedFromMempool(const CTransactionRef& tx, MemPoolRemovalReason reason, uint64_t mempool_sequence) override;
+    void UpdatedBlockTip(const CBlockIndex* pindexNew, const CBlockIndex* pindexFork, bool fInitialDownload) override;
+
+public:
+    BlockTemplateManager(ChainstateManager& chainman, const CTxMemPool& mempool, const BlockAssembler::Options& options);
+
+    /** Return a copy of the current template with a coinbase paying to scriptPubKeyIn */
+    std::unique_ptr<CBlockTemplate> GetTemplate(const CScript& scriptPubKeyIn) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /** Id of the last published update; read it before GetTemplate() to not miss updates */
+    uint64_t GetUpdateId() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /**
+     * Wait until an update newer than update_id is published. After a minute
+     * without one, return as soon as the mempool has changed at all. Must be
+     * called without holding cs_main or the mempool lock.
+     *
+     * @returns false if interrupted
+     */
+    bool WaitForUpdate(uint64_t update_id) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /** Wake up and return from all current and future WaitForUpdate() calls */
+    void Interrupt() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+};
+
 int64_t UpdateTime(CBlockHeader* pblock, const Consensus::Params& consensusParams, const CBlockIndex* pindexPrev);
 
 /** Update an old GenerateCoinbaseCommitment from CreateNewBlock after the block txs have changed */
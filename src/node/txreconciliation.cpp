@@ -4,9 +4,13 @@
 
 #include <node/txreconciliation.h>
 
+#include <crypto/siphash.h>
+#include <node/minisketchwrapper.h>
+#include <random.h>
 #include <util/check.h>
 #include <util/system.h>
 
+#include <algorithm>
 #include <unordered_map>
 #include <variant>
 
@@ -28,6 +32,23 @@ uint256 ComputeSalt(uint64_t salt1, uint64_t salt2)
     return (HashWriter(RECON_SALT_HASHER) << std::min(salt1, salt2) << std::max(salt1, salt2)).GetSHA256();
 }
 
+/** Phases of a reconciliation round, from the point of view of either role. */
+enum class Phase {
+    NONE,
+    /** Initiator: REQRECON sent, waiting for the initial sketch. */
+    INIT_REQUESTED,
+    /** Responder: initial sketch sent, waiting for RECONCILDIFF or REQSKETCHEXT. */
+    INIT_RESPONDED,
+    /** Initiator: REQSKETCHEXT sent, waiting for the sketch extension. */
+    EXT_REQUESTED,
+    /** Responder: sketch extension sent, waiting for RECONCILDIFF. */
+    EXT_RESPONDED,
+};
+
+/** Size of a short ID as stored in a sketch, see BIP-330. */
+constexpr uint32_t RECON_FIELD_SIZE{32};
+constexpr size_t RECON_FIELD_BYTES{RECON_FIELD_SIZE / 8};
+
 /**
  * Keeps track of txreconciliation-related per-peer state.
  */
@@ -35,9 +56,6 @@ class TxReconciliationState
 {
 public:
     /**
-     * TODO: This field is public to ignore -Wunused-private-field. Make private once used in
-     * the following commits.
-     *
      * Reconciliation protocol assumes using one role consistently: either a reconciliation
      * initiator (requesting sketches), or responder (sending sketches). This defines our role,
      * based on the direction of the p2p connection.
@@ -46,16 +64,92 @@ public:
     bool m_we_initiate;
 
     /**
-     * TODO: These fields are public to ignore -Wunused-private-field. Make private once used in
-     * the following commits.
-     *
      * These values are used to salt short IDs, which is necessary for transaction reconciliations.
      */
     uint64_t m_k0, m_k1;
 
+    /** Transactions to reconcile in the next round, by short ID. */
+    std::unordered_map<uint32_t, uint256> m_local_set;
+
+    /**
+     * Transactions of the ongoing round. Both sides must compute their sketches over the same
+     * set for the whole round (including the extension), so the set is frozen when it starts.
+     */
+    std::unordered_map<uint32_t, uint256> m_local_set_snapshot;
+
+    Phase m_phase{Phase::NONE};
+
+    /** Initiator: when the ongoing round started, to time it out. */
+    std::chrono::microseconds m_phase_since{0};
+
+    /** Initiator: when to request the next round. */
+    std::chrono::microseconds m_next_recon_request{0};
+
+    /** Initiator: estimate of the set difference coefficient sent with the next request. */
+    double m_local_q{RECON_Q};
+
+    /** Initiator: the sketch received in the ongoing round, kept to be extended. */
+    std::vector<uint8_t> m_remote_sketch;
+
+    /** Responder: capacity of the initial sketch sent in the ongoing round. */
+    size_t m_sketch_capacity{0};
+
     TxReconciliationState(bool we_initiate, uint64_t k0, uint64_t k1) : m_we_initiate(we_initiate), m_k0(k0), m_k1(k1) {}
+
+    /** Short ID of a transaction as defined by BIP-330. Never zero, as sketches can't hold zero. */
+    uint32_t ComputeShortID(const uint256& wtxid) const
+    {
+        const uint64_t s{SipHashUint256(m_k0, m_k1, wtxid)};
+        return 1 + (s % 0xFFFFFFFF);
+    }
+
+    /** Sketch of the transactions of the ongoing round. */
+    Minisketch ComputeSketch(size_t capacity) const
+    {
+        Minisketch sketch{node::MakeMinisketch32(capacity)};
+        for (const auto& [short_id, wtxid] : m_local_set_snapshot) {
+            sketch.Add(short_id);
+        }
+        return sketch;
+    }
+
+    /** Start a round by freezing the current set. */
+    void StartRound(Phase phase)
+    {
+        m_local_set_snapshot = std::move(m_local_set);
+        m_local_set.clear();
+        m_phase = phase;
+    }
+
+    /** Transactions of the ongoing round, and forget them. */
+    std::vector<uint256> FinishRound()
+    {
+        std::vector<uint256> wtxids;
+        wtxids.reserve(m_local_set_snapshot.size());
+        for (const auto& [short_id, wtxid] : m_local_set_snapshot) {
+            wtxids.push_back(wtxid);
+        }
+        m_local_set_snapshot.clear();
+        m_remote_sketch.clear();
+        m_sketch_capacity = 0;
+        m_phase = Phase::NONE;
+        return wtxids;
+    }
 };
 
+/**
+ * Capacity of the sketch a responder sends for the estimated set difference, see BIP-330. It is
+ * limited so that the extension, which doubles it, still fits in MAX_SKETCH_CAPACITY.
+ */
+size_t ComputeSketchCapacity(size_t local_set_size, size_t remote_set_size, double q)
+{
+    if (local_set_size == 0 && remote_set_size == 0) return 0;
+    const size_t set_size_diff{std::max(local_set_size, remote_set_size) - std::min(local_set_size, remote_set_size)};
+    const size_t estimated_diff{set_size_diff + static_cast<size_t>(q * std::min(local_set_size, remote_set_size)) + 1};
+    const size_t capacity{Minisketch::ComputeCapacity(RECON_FIELD_SIZE, estimated_diff, RECON_FALSE_POSITIVE_COEF)};
+    return std::min(capacity, MAX_SKETCH_CAPACITY / 2);
+}
+
 } // namespace
 
 /** Actual implementation for TxReconciliationTracker's data structure. */
@@ -75,6 +169,16 @@ private:
      */
     std::unordered_map<NodeId, std::variant<uint64_t, TxReconciliationState>> m_states GUARDED_BY(m_txreconciliation_mutex);
 
+    /** Salt used to pick the reconciling peers a transaction is still flooded to. */
+    const uint64_t m_fanout_k0{GetRand<uint64_t>()}, m_fanout_k1{GetRand<uint64_t>()};
+
+    TxReconciliationState* GetRegisteredState(NodeId peer_id) EXCLUSIVE_LOCKS_REQUIRED(m_txreconciliation_mutex)
+    {
+        auto recon_state = m_states.find(peer_id);
+        if (recon_state == m_states.end()) return nullptr;
+        return std::get_if<TxReconciliationState>(&recon_state->second);
+    }
+
 public:
     explicit Impl(uint32_t recon_version) : m_recon_version(recon_version) {}
 
@@ -141,6 +245,213 @@ public:
         return (recon_state != m_states.end() &&
                 std::holds_alternative<TxReconciliationState>(recon_state->second));
     }
+
+    bool ShouldFanoutTo(const uint256& wtxid, NodeId peer_id) const EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        auto recon_state = m_states.find(peer_id);
+        if (recon_state == m_states.end()) return true;
+        const auto* state = std::get_if<TxReconciliationState>(&recon_state->second);
+        if (!state) return true;
+
+        const uint64_t our_hash{SipHashUint256Extra(m_fanout_k0, m_fanout_k1, wtxid, peer_id)};
+        if (!state->m_we_initiate) {
+            return our_hash % 100 < static_cast<uint64_t>(INBOUND_FANOUT_DESTINATIONS_FRACTION * 100);
+        }
+        // Flood to the outbound reconciling peers with the lowest hashes for this transaction.
+        size_t lower{0};
+        for (const auto& [other_id, other_state] : m_states) {
+            const auto* other = std::get_if<TxReconciliationState>(&other_state);
+            if (other_id == peer_id || !other || !other->m_we_initiate) continue;
+            if (SipHashUint256Extra(m_fanout_k0, m_fanout_k1, wtxid, other_id) < our_hash) {
+                if (++lower >= OUTBOUND_FANOUT_DESTINATIONS) return false;
+            }
+        }
+        return true;
+    }
+
+    bool AddToSet(NodeId peer_id, const uint256& wtxid) EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        auto* state = GetRegisteredState(peer_id);
+        if (!state) return false;
+
+        const uint32_t short_id{state->ComputeShortID(wtxid)};
+        if (const auto it = state->m_local_set_snapshot.find(short_id); it != state->m_local_set_snapshot.end()) {
+            return it->second == wtxid;
+        }
+        if (state->m_local_set.size() >= MAX_RECONSET_SIZE) return false;
+        const auto [it, inserted] = state->m_local_set.emplace(short_id, wtxid);
+        return inserted || it->second == wtxid;
+    }
+
+    bool TryRemovingFromSet(NodeId peer_id, const uint256& wtxid) EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        auto* state = GetRegisteredState(peer_id);
+        if (!state) return false;
+
+        const auto it = state->m_local_set.find(state->ComputeShortID(wtxid));
+        if (it == state->m_local_set.end() || it->second != wtxid) return false;
+        state->m_local_set.erase(it);
+        return true;
+    }
+
+    std::optional<std::pair<uint16_t, uint16_t>> InitiateReconciliationRequest(NodeId peer_id, std::chrono::microseconds now) EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        auto* state = GetRegisteredState(peer_id);
+        if (!state || !state->m_we_initiate) return std::nullopt;
+
+        if (state->m_phase != Phase::NONE) {
+            if (now < state->m_phase_since + RECON_RESPONSE_TIMEOUT) return std::nullopt;
+            LogPrintLevel(BCLog::TXRECONCILIATION, BCLog::Level::Debug, "Reconciliation round with peer=%d timed out\n", peer_id);
+            for (const auto& [short_id, wtxid] : state->m_local_set_snapshot) {
+                if (state->m_local_set.size() >= MAX_RECONSET_SIZE) break;
+                state->m_local_set.emplace(short_id, wtxid);
+            }
+            state->FinishRound();
+        }
+        if (now < state->m_next_recon_request) return std::nullopt;
+
+        state->m_next_recon_request = now + RECON_REQUEST_INTERVAL;
+        state->m_phase_since = now;
+        state->StartRound(Phase::INIT_REQUESTED);
+        const uint16_t set_size{static_cast<uint16_t>(state->m_local_set_snapshot.size())};
+        const uint16_t q{static_cast<uint16_t>(state->m_local_q * RECON_Q_PRECISION)};
+        LogPrintLevel(BCLog::TXRECONCILIATION, BCLog::Level::Debug, "Initiate reconciliation with peer=%d (set size %u)\n", peer_id, set_size);
+        return std::make_pair(set_size, q);
+    }
+
+    bool HandleReconciliationRequest(NodeId peer_id, uint16_t peer_recon_set_size, uint16_t peer_q,
+                                     std::vector<uint8_t>& skdata) EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        auto* state = GetRegisteredState(peer_id);
+        if (!state || state->m_we_initiate || state->m_phase != Phase::NONE) return false;
+
+        state->StartRound(Phase::INIT_RESPONDED);
+        const double q{static_cast<double>(peer_q) / RECON_Q_PRECISION};
+        state->m_sketch_capacity = ComputeSketchCapacity(state->m_local_set_snapshot.size(), peer_recon_set_size, q);
+        skdata.clear();
+        if (state->m_sketch_capacity > 0) skdata = state->ComputeSketch(state->m_sketch_capacity).Serialize();
+        LogPrintLevel(BCLog::TXRECONCILIATION, BCLog::Level::Debug, "Respond to reconciliation request from peer=%d (set sizes %u/%u, capacity %u)\n",
+                      peer_id, state->m_local_set_snapshot.size(), peer_recon_set_size, state->m_sketch_capacity);
+        return true;
+    }
+
+    bool HandleExtensionRequest(NodeId peer_id, std::vector<uint8_t>& skdata) EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        auto* state = GetRegisteredState(peer_id);
+        if (!state || state->m_we_initiate || state->m_phase != Phase::INIT_RESPONDED || state->m_sketch_capacity == 0) return false;
+
+        // The lower half of a sketch is the sketch of the same set at half the capacity, which
+        // the peer already has.
+        const std::vector<uint8_t> extended{state->ComputeSketch(state->m_sketch_capacity * 2).Serialize()};
+        skdata.assign(extended.begin() + state->m_sketch_capacity * RECON_FIELD_BYTES, extended.end());
+        state->m_phase = Phase::EXT_RESPONDED;
+        return true;
+    }
+
+    bool HandleSketch(NodeId peer_id, const std::vector<uint8_t>& skdata, ReconciliationSketchResult& result) EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        auto* state = GetRegisteredState(peer_id);
+        if (!state || !state->m_we_initiate) return false;
+
+        if (state->m_phase == Phase::INIT_REQUESTED) {
+            if (skdata.size() % RECON_FIELD_BYTES != 0 || skdata.size() / RECON_FIELD_BYTES > MAX_SKETCH_CAPACITY / 2) return false;
+            state->m_remote_sketch = skdata;
+        } else if (state->m_phase == Phase::EXT_REQUESTED) {
+            if (skdata.size() != state->m_remote_sketch.size()) return false;
+            state->m_remote_sketch.insert(state->m_remote_sketch.end(), skdata.begin(), skdata.end());
+        } else {
+            return false;
+        }
+
+        result = {};
+        const size_t capacity{state->m_remote_sketch.size() / RECON_FIELD_BYTES};
+        std::optional<std::vector<uint64_t>> differences;
+        if (capacity == 0) {
+            // The peer's set is empty, and so was ours when the round started.
+            if (state->m_local_set_snapshot.empty()) differences.emplace();
+        } else {
+            Minisketch remote_sketch{node::MakeMinisketch32(capacity)};
+            remote_sketch.Deserialize(state->m_remote_sketch);
+            differences = state->ComputeSketch(capacity).Merge(remote_sketch).DecodeFP(RECON_FALSE_POSITIVE_COEF);
+        }
+
+        if (!differences) {
+            if (state->m_phase == Phase::INIT_REQUESTED && capacity > 0) {
+                LogPrintLevel(BCLog::TXRECONCILIATION, BCLog::Level::Debug, "Request sketch extension from peer=%d\n", peer_id);
+                state->m_phase = Phase::EXT_REQUESTED;
+                return true;
+            }
+            LogPrintLevel(BCLog::TXRECONCILIATION, BCLog::Level::Debug, "Reconciliation with peer=%d failed, announcing %u transactions\n",
+                          peer_id, state->m_local_set_snapshot.size());
+            result.success = false;
+            result.announce = state->FinishRound();
+            return true;
+        }
+
+        for (const uint64_t difference : *differences) {
+            const uint32_t short_id{static_cast<uint32_t>(difference)};
+            if (const auto it = state->m_local_set_snapshot.find(short_id); it != state->m_local_set_snapshot.end()) {
+                result.announce.push_back(it->second);
+            } else {
+                result.ask_shortids.push_back(short_id);
+            }
+        }
+
+        // Update q for the next round from the actual difference, see BIP-330.
+        const size_t local_set_size{state->m_local_set_snapshot.size()};
+        const size_t remote_set_size{local_set_size - result.announce.size() + result.ask_shortids.size()};
+        const size_t min_set_size{std::min(local_set_size, remote_set_size)};
+        if (min_set_size > 0) {
+            const size_t set_size_diff{std::max(local_set_size, remote_set_size) - min_set_size};
+            state->m_local_q = std::clamp(static_cast<double>(differences->size() - set_size_diff) / min_set_size, 0.0, 2.0);
+        }
+
+        LogPrintLevel(BCLog::TXRECONCILIATION, BCLog::Level::Debug, "Reconciliation with peer=%d succeeded: announce %u, request %u\n",
+                      peer_id, result.announce.size(), result.ask_shortids.size());
+        result.success = true;
+        state->FinishRound();
+        return true;
+    }
+
+    bool HandleReconciliationDifference(NodeId peer_id, bool success, const std::vector<uint32_t>& ask_shortids,
+                                        std::vector<uint256>& announce) EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        auto* state = GetRegisteredState(peer_id);
+        if (!state || state->m_we_initiate) return false;
+        if (state->m_phase != Phase::INIT_RESPONDED && state->m_phase != Phase::EXT_RESPONDED) return false;
+        if (ask_shortids.size() > MAX_SKETCH_CAPACITY) return false;
+
+        announce.clear();
+        if (success) {
+            for (const uint32_t short_id : ask_shortids) {
+                if (const auto it = state->m_local_set_snapshot.find(short_id); it != state->m_local_set_snapshot.end()) {
+                    announce.push_back(it->second);
+                }
+            }
+            state->FinishRound();
+        } else {
+            announce = state->FinishRound();
+        }
+        LogPrintLevel(BCLog::TXRECONCILIATION, BCLog::Level::Debug, "Reconciliation with peer=%d finished (success=%i), announcing %u transactions\n",
+                      peer_id, success, announce.size());
+        return true;
+    }
 };
 
 TxReconciliationTracker::TxReconciliationTracker(uint32_t recon_version) : m_impl{std::make_unique<TxReconciliationTracker::Impl>(recon_version)} {}
@@ -167,3 +478,45 @@ bool TxReconciliationTracker::IsPeerRegistered(NodeId peer_id) const
 {
     return m_impl->IsPeerRegistered(peer_id);
 }
+
+bool TxReconciliationTracker::ShouldFanoutTo(const uint256& wtxid, NodeId peer_id) const
+{
+    return m_impl->ShouldFanoutTo(wtxid, peer_id);
+}
+
+bool TxReconciliationTracker::AddToSet(NodeId peer_id, const uint256& wtxid)
+{
+    return m_impl->AddToSet(peer_id, wtxid);
+}
+
+bool TxReconciliationTracker::TryRemovingFromSet(NodeId peer_id, const uint256& wtxid)
+{
+    return m_impl->TryRemovingFromSet(peer_id, wtxid);
+}
+
+std::optional<std::pair<uint16_t, uint16_t>> TxReconciliationTracker::InitiateReconciliationRequest(NodeId peer_id, std::chrono::microseconds now)
+{
+    return m_impl->InitiateReconciliationRequest(peer_id, now);
+}
+
+bool TxReconciliationTracker::HandleReconciliationRequest(NodeId peer_id, uint16_t peer_recon_set_size, uint16_t peer_q,
+                                                          std::vector<uint8_t>& skdata)
+{
+    return m_impl->HandleReconciliationRequest(peer_id, peer_recon_set_size, peer_q, skdata);
+}
+
+bool TxReconciliationTracker::HandleExtensionRequest(NodeId peer_id, std::vector<uint8_t>& skdata)
+{
+    return m_impl->HandleExtensionRequest(peer_id, skdata);
+}
+
+bool TxReconciliationTracker::HandleSketch(NodeId peer_id, const std::vector<uint8_t>& skdata, ReconciliationSketchResult& result)
+{
+    return m_impl->HandleSketch(peer_id, skdata, result);
+}
+
+bool TxReconciliationTracker::HandleReconciliationDifference(NodeId peer_id, bool success, const std::vector<uint32_t>& ask_shortids,
+                                                             std::vector<uint256>& announce)
+{
+    return m_impl->HandleReconciliationDifference(peer_id, success, ask_shortids, announce);
+}
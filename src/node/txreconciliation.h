@@ -7,14 +7,39 @@
 
 #include <net.h>
 #include <sync.h>
+#include <uint256.h>
 
+#include <chrono>
 #include <memory>
+#include <optional>
 #include <tuple>
+#include <vector>
 
 /** Whether transaction reconciliation protocol should be enabled by default. */
 static constexpr bool DEFAULT_TXRECONCILIATION_ENABLE{false};
 /** Supported transaction reconciliation protocol version */
 static constexpr uint32_t TXRECONCILIATION_VERSION{1};
+/** How often we request a sketch from each peer we initiate reconciliations with. */
+static constexpr auto RECON_REQUEST_INTERVAL{8s};
+/** How long we wait for a peer to finish a reconciliation round before giving up on it. */
+static constexpr auto RECON_RESPONSE_TIMEOUT{60s};
+/**
+ * Maximum number of transactions we keep in a per-peer reconciliation set. Transactions that
+ * don't fit are announced by flooding instead.
+ */
+static constexpr size_t MAX_RECONSET_SIZE{3000};
+/** Maximum capacity of a sketch we send or accept, including the extension. */
+static constexpr size_t MAX_SKETCH_CAPACITY{2 << 12};
+/** Coefficient used to estimate the set difference at the start of a reconciliation, see BIP-330. */
+static constexpr double RECON_Q{0.25};
+/** q is sent over the wire as a uint16_t with this precision. */
+static constexpr uint16_t RECON_Q_PRECISION{(2 << 14) - 1};
+/** False positive bits used when sizing and decoding sketches. */
+static constexpr uint32_t RECON_FALSE_POSITIVE_COEF{16};
+/** Number of outbound reconciling peers every transaction is still flooded to. */
+static constexpr size_t OUTBOUND_FANOUT_DESTINATIONS{1};
+/** Fraction of inbound reconciling peers every transaction is still flooded to. */
+static constexpr double INBOUND_FANOUT_DESTINATIONS_FRACTION{0.1};
 
 enum class ReconciliationRegisterResult {
     NOT_FOUND,
@@ -23,6 +48,16 @@ enum class ReconciliationRegisterResult {
     PROTOCOL_VIOLATION,
 };
 
+/** What the initiator should send after processing a sketch from the peer. */
+struct ReconciliationSketchResult {
+    /** Whether the set difference was found. Unset if a sketch extension should be requested. */
+    std::optional<bool> success;
+    /** Short IDs of the transactions the peer should announce to us (sent in RECONCILDIFF). */
+    std::vector<uint32_t> ask_shortids;
+    /** Transactions we should announce to the peer. */
+    std::vector<uint256> announce;
+};
+
 /**
  * Transaction reconciliation is a way for nodes to efficiently announce transactions.
  * This object keeps track of all txreconciliation-related communications with the peers.
@@ -86,6 +121,62 @@ public:
      * Check if a peer is registered to reconcile transactions with us.
      */
     bool IsPeerRegistered(NodeId peer_id) const;
+
+    /**
+     * Step 1. Whether a transaction should still be flooded to a registered peer, so that it
+     * keeps propagating quickly through the network. Every transaction is flooded to
+     * OUTBOUND_FANOUT_DESTINATIONS of our outbound reconciling peers and to
+     * INBOUND_FANOUT_DESTINATIONS_FRACTION of our inbound ones, picked per transaction.
+     */
+    bool ShouldFanoutTo(const uint256& wtxid, NodeId peer_id) const;
+
+    /**
+     * Step 1. Add a transaction to the set we reconcile with the peer instead of announcing it.
+     * Returns false if the peer is not registered, the set is full, or the short ID of the
+     * transaction collides with one already in the set; the caller should flood it then.
+     */
+    bool AddToSet(NodeId peer_id, const uint256& wtxid);
+
+    /**
+     * Remove a transaction from the set we reconcile with the peer, e.g. because the peer
+     * announced it to us. Returns whether it was there.
+     */
+    bool TryRemovingFromSet(NodeId peer_id, const uint256& wtxid);
+
+    /**
+     * Step 2. If we initiate reconciliations with the peer and it is time for the next round,
+     * return the local set size and q to send in REQRECON. The current set is snapshotted for
+     * the round, new transactions go into the next one. A round the peer did not complete
+     * within RECON_RESPONSE_TIMEOUT is abandoned and its transactions moved to the next round.
+     */
+    std::optional<std::pair<uint16_t, uint16_t>> InitiateReconciliationRequest(NodeId peer_id, std::chrono::microseconds now);
+
+    /**
+     * Step 2 (responder). Handle REQRECON from the peer: snapshot our set and fill the sketch
+     * to send back in SKETCH. Returns false on a protocol violation.
+     */
+    bool HandleReconciliationRequest(NodeId peer_id, uint16_t peer_recon_set_size, uint16_t peer_q,
+                                     std::vector<uint8_t>& skdata);
+
+    /**
+     * Step 4b (responder). Handle REQSKETCHEXT from the peer: fill the upper half of a sketch of
+     * twice the initial capacity to send in SKETCH. Returns false on a protocol violation.
+     */
+    bool HandleExtensionRequest(NodeId peer_id, std::vector<uint8_t>& skdata);
+
+    /**
+     * Step 3 (initiator). Handle SKETCH from the peer (initial or extension) and try to find the
+     * set difference. Returns false on a protocol violation.
+     */
+    bool HandleSketch(NodeId peer_id, const std::vector<uint8_t>& skdata, ReconciliationSketchResult& result);
+
+    /**
+     * Step 5 (responder). Handle RECONCILDIFF from the peer, finishing the round. Fills the
+     * transactions to announce: the requested ones on success, the whole snapshot on failure.
+     * Returns false on a protocol violation.
+     */
+    bool HandleReconciliationDifference(NodeId peer_id, bool success, const std::vector<uint32_t>& ask_shortids,
+                                        std::vector<uint256>& announce);
 };
 
 #endif // BITCOIN_NODE_TXRECONCILIATION_H
@@ -15,6 +15,46 @@
 #include <stdlib.h> // exit()
 #include <sync.h>
 
+#include <optional>
+#include <vector>
+
+namespace {
+/** Proof of work hashes of recently seen headers, by block hash. The same header is
+ *  checked along several paths (HEADERS, compact blocks, the full block, blocks read
+ *  back from disk), each with its own copy of the header and of its cache, so the
+ *  yespower result is shared between them here. */
+class PoWHashCache
+{
+private:
+    static constexpr size_t SIZE{1 << 14};
+    struct Entry {
+        uint256 block_hash;
+        uint256 pow_hash;
+    };
+
+    Mutex m_mutex;
+    /** Direct mapped by the low bits of the block hash */
+    std::vector<Entry> m_entries GUARDED_BY(m_mutex) = std::vector<Entry>(SIZE);
+
+public:
+    std::optional<uint256> Get(const uint256& block_hash) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        LOCK(m_mutex);
+        const Entry& entry{m_entries[block_hash.GetUint64(0) & (SIZE - 1)]};
+        if (entry.block_hash != block_hash) return std::nullopt;
+        return entry.pow_hash;
+    }
+
+    void Insert(const uint256& block_hash, const uint256& pow_hash) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        LOCK(m_mutex);
+        m_entries[block_hash.GetUint64(0) & (SIZE - 1)] = {block_hash, pow_hash};
+    }
+};
+
+PoWHashCache g_pow_hash_cache;
+} // namespace
+
 uint256 CBlockHeaderUncached::GetHash() const
 {
     return SerializeHash(*this);
@@ -54,7 +94,12 @@ uint256 CBlockHeader::GetPoWHash_cached() const
         /* yespower PoW cache log: O (cyan) = HIT */
         // printf("\033[36;1mO\033[0m block = %s PoW = %s\n", cache_block_hash.ToString().c_str(), cache_PoW_hash.ToString().c_str());
     } else {
-        cache_PoW_hash = GetPoWHash();
+        if (const auto pow_hash{g_pow_hash_cache.Get(block_hash)}) {
+            cache_PoW_hash = *pow_hash;
+        } else {
+            cache_PoW_hash = GetPoWHash();
+            g_pow_hash_cache.Insert(block_hash, cache_PoW_hash);
+        }
         cache_block_hash = block_hash;
         cache_init = true;
         /* yespower PoW cache log: x = MISS */
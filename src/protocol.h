@@ -264,6 +264,28 @@ extern const char* WTXIDRELAY;
  * txreconciliation, as described by BIP 330.
  */
 extern const char* SENDTXRCNCL;
+/**
+ * Requests a sketch of the peer's reconciliation set. Contains the size of the
+ * requester's set (uint16_t) and the coefficient q (uint16_t) used to estimate
+ * the set difference, as described by BIP 330.
+ */
+extern const char* REQRECON;
+/**
+ * Contains a sketch of the sender's reconciliation set, sent in response to a
+ * reqrecon or reqsketchext message, as described by BIP 330.
+ */
+extern const char* SKETCH;
+/**
+ * Requests an extension of the sketch previously sent, after the set
+ * difference could not be decoded from it, as described by BIP 330.
+ */
+extern const char* REQSKETCHEXT;
+/**
+ * Finishes a reconciliation round. Contains whether it succeeded (uint8_t) and
+ * the short IDs of the transactions the sender wants announced, as described
+ * by BIP 330.
+ */
+extern const char* RECONCILDIFF;
 }; // namespace NetMsgType
 
 /* Get a vector of all valid message types (see above) */
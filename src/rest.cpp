@@ -17,6 +17,8 @@
 #include <primitives/block.h>
 #include <primitives/transaction.h>
 #include <rpc/blockchain.h>
+#include <rpc/index.h>
+#include <rpc/jsonstream.h>
 #include <rpc/mempool.h>
 #include <rpc/protocol.h>
 #include <rpc/server.h>
@@ -29,7 +31,10 @@
 #include <validation.h>
 #include <version.h>
 
+#include <algorithm>
 #include <any>
+#include <optional>
+#include <set>
 #include <string>
 
 #include <univalue.h>
@@ -37,9 +42,18 @@
 using node::GetTransaction;
 using node::NodeContext;
 using node::ReadBlockFromDisk;
+using node::ReadRawBlockFromDisk;
 
 static const size_t MAX_GETUTXOS_OUTPOINTS = 15; //allow a max of 15 outpoints to be queried at once
 static constexpr unsigned int MAX_REST_HEADERS_RESULTS = 2000;
+static constexpr size_t MAX_REST_INDEX_ADDRESSES{100};
+static constexpr size_t MAX_REST_SPENTINFO_OUTPOINTS{1000};
+//! Bytes of index records serialized before they are passed to the reply
+static constexpr size_t REST_INDEX_CHUNK_SIZE{64 * 1024};
+//! Bytes of a streamed chain range collected before they are sent as a chunk
+static constexpr size_t REST_STREAM_CHUNK_SIZE{1024 * 1024};
+//! Block index entries looked up at once while streaming a chain range
+static constexpr size_t REST_STREAM_INDEX_BATCH{1000};
 
 static const struct {
     RESTResponseFormat rf;
@@ -181,6 +195,63 @@ static bool CheckWarmup(HTTPRequest* req)
     return true;
 }
 
+/**
+ * Stream the entries of count blocks of the active chain, starting at first,
+ * with chunked transfer encoding. serialize(pindex, data) appends the entry of
+ * a block to data, and is called without holding cs_main. Each chunk waits for
+ * the client to read the previous ones (see HTTPRequest::WriteReplyChunk()),
+ * so the reply is produced no faster than it is consumed.
+ *
+ * The status is sent before the first entry, so the reply ends early, without
+ * an error, if the blocks are reorganized out of the active chain or an entry
+ * cannot be serialized.
+ */
+template <typename Serializer>
+static void StreamChainRange(const ChainstateManager& chainman, HTTPRequest* req, RESTResponseFormat rf,
+                             const CBlockIndex* first, size_t count, Serializer serialize)
+{
+    assert(rf == RESTResponseFormat::BINARY || rf == RESTResponseFormat::HEX);
+    req->WriteHeader("Content-Type", rf == RESTResponseFormat::HEX ? "text/plain" : "application/octet-stream");
+    req->StartChunkedReply(HTTP_OK);
+
+    std::vector<uint8_t> data;
+    const auto send_chunk = [&]() {
+        const bool sent{rf == RESTResponseFormat::HEX ? req->WriteReplyChunk(MakeByteSpan(HexStr(data))) :
+                                                        req->WriteReplyChunk(MakeByteSpan(data))};
+        data.clear();
+        return sent;
+    };
+
+    std::vector<const CBlockIndex*> batch;
+    size_t streamed{0};
+    bool ok{true};
+    while (ok && streamed < count) {
+        {
+            LOCK(cs_main);
+            const CChain& active_chain{chainman.ActiveChain()};
+            const CBlockIndex* pindex{batch.empty() ? first : active_chain.Next(batch.back())};
+            batch.clear();
+            while (pindex && active_chain.Contains(pindex) && batch.size() < std::min(REST_STREAM_INDEX_BATCH, count - streamed)) {
+                batch.push_back(pindex);
+                pindex = active_chain.Next(pindex);
+            }
+        }
+        if (batch.empty()) break;
+        for (const CBlockIndex* pindex : batch) {
+            ok = serialize(pindex, data);
+            if (!ok) break;
+            ++streamed;
+            if (data.size() >= REST_STREAM_CHUNK_SIZE) {
+                ok = send_chunk();
+                if (!ok) break;
+            }
+        }
+    }
+    if (ok && !data.empty()) ok = send_chunk();
+    if (ok && rf == RESTResponseFormat::HEX) req->WriteReplyChunk(MakeByteSpan(std::string{"\n"}));
+    req->EndChunkedReply();
+}
+
 static bool rest_headers(const std::any& context,
                          HTTPRequest* req,
                          const std::string& strURIPart)
@@ -209,8 +280,11 @@ static bool rest_headers(const std::any& context,
         return RESTERR(req, HTTP_BAD_REQUEST, "Invalid URI format. Expected /rest/headers/<hash>.<ext>?count=<count>");
     }
 
+    // Binary and hex replies of more than MAX_REST_HEADERS_RESULTS headers are
+    // streamed, so their count is not limited.
+    const bool stream_binary{rf == RESTResponseFormat::BINARY || rf == RESTResponseFormat::HEX};
     const auto parsed_count{ToIntegral<size_t>(raw_count)};
-    if (!parsed_count.has_value() || *parsed_count < 1 || *parsed_count > MAX_REST_HEADERS_RESULTS) {
+    if (!parsed_count.has_value() || *parsed_count < 1 || (*parsed_count > MAX_REST_HEADERS_RESULTS && !stream_binary)) {
         return RESTERR(req, HTTP_BAD_REQUEST, strprintf("Header count is invalid or out of acceptable range (1-%u): %s", MAX_REST_HEADERS_RESULTS, raw_count));
     }
 
@@ -218,13 +292,25 @@ static bool rest_headers(const std::any& context,
     if (!ParseHashStr(hashStr, hash))
         return RESTERR(req, HTTP_BAD_REQUEST, "Invalid hash: " + hashStr);
 
+    ChainstateManager* maybe_chainman = GetChainman(context, req);
+    if (!maybe_chainman) return false;
+    ChainstateManager& chainman = *maybe_chainman;
+
+    if (*parsed_count > MAX_REST_HEADERS_RESULTS) {
+        const CBlockIndex* first{WITH_LOCK(cs_main, return chainman.m_blockman.LookupBlockIndex(hash))};
+        if (first) {
+            StreamChainRange(chainman, req, rf, first, *parsed_count, [](const CBlockIndex* pindex, std::vector<uint8_t>& data) {
+                CVectorWriter{SER_NETWORK, PROTOCOL_VERSION, data, data.size(), pindex->GetBlockHeader()};
+                return true;
+            });
+            return true;
+        }
+    }
+
     const CBlockIndex* tip = nullptr;
     std::vector<const CBlockIndex*> headers;
-    headers.reserve(*parsed_count);
+    headers.reserve(std::min<size_t>(*parsed_count, MAX_REST_HEADERS_RESULTS));
     {
-        ChainstateManager* maybe_chainman = GetChainman(context, req);
-        if (!maybe_chainman) return false;
-        ChainstateManager& chainman = *maybe_chainman;
         LOCK(cs_main);
         CChain& active_chain = chainman.ActiveChain();
         tip = active_chain.Tip();
@@ -278,6 +364,25 @@ static bool rest_headers(const std::any& context,
     }
 }
 
+/**
+ * Read the block as served by the binary and hex formats. Blocks are stored
+ * with witness serialization, so unless RPCSerializationFlags() asks for
+ * something else the bytes on disk are returned without deserializing them.
+ */
+static bool ReadSerializedBlock(const ChainstateManager& chainman, const CBlockIndex* pblockindex, std::vector<uint8_t>& block_data)
+{
+    if (RPCSerializationFlags() == 0) {
+        return ReadRawBlockFromDisk(block_data, pblockindex, chainman.GetParams().MessageStart());
+    }
+
+    CBlock block;
+    if (!ReadBlockFromDisk(block, pblockindex, chainman.GetParams().GetConsensus())) {
+        return false;
+    }
+    CVectorWriter{SER_NETWORK, PROTOCOL_VERSION | RPCSerializationFlags(), block_data, 0, block};
+    return true;
+}
+
 static bool rest_block(const std::any& context,
                        HTTPRequest* req,
                        const std::string& strURIPart,
@@ -292,7 +397,6 @@ static bool rest_block(const std::any& context,
     if (!ParseHashStr(hashStr, hash))
         return RESTERR(req, HTTP_BAD_REQUEST, "Invalid hash: " + hashStr);
 
-    CBlock block;
     const CBlockIndex* pblockindex = nullptr;
     const CBlockIndex* tip = nullptr;
     ChainstateManager* maybe_chainman = GetChainman(context, req);
@@ -311,30 +415,33 @@ static bool rest_block(const std::any& context,
 
     }
 
-    if (!ReadBlockFromDisk(block, pblockindex, chainman.GetParams().GetConsensus())) {
-        return RESTERR(req, HTTP_NOT_FOUND, hashStr + " not found");
-    }
-
     switch (rf) {
     case RESTResponseFormat::BINARY: {
-        CDataStream ssBlock(SER_NETWORK, PROTOCOL_VERSION | RPCSerializationFlags());
-        ssBlock << block;
-        std::string binaryBlock = ssBlock.str();
+        std::vector<uint8_t> block_data;
+        if (!ReadSerializedBlock(chainman, pblockindex, block_data)) {
+            return RESTERR(req, HTTP_NOT_FOUND, hashStr + " not found");
+        }
         req->WriteHeader("Content-Type", "application/octet-stream");
-        req->WriteReply(HTTP_OK, binaryBlock);
+        req->WriteReply(HTTP_OK, MakeByteSpan(block_data));
         return true;
     }
 
     case RESTResponseFormat::HEX: {
-        CDataStream ssBlock(SER_NETWORK, PROTOCOL_VERSION | RPCSerializationFlags());
-        ssBlock << block;
-        std::string strHex = HexStr(ssBlock) + "\n";
+        std::vector<uint8_t> block_data;
+        if (!ReadSerializedBlock(chainman, pblockindex, block_data)) {
+            return RESTERR(req, HTTP_NOT_FOUND, hashStr + " not found");
+        }
+        std::string strHex = HexStr(block_data) + "\n";
         req->WriteHeader("Content-Type", "text/plain");
         req->WriteReply(HTTP_OK, strHex);
         return true;
     }
 
     case RESTResponseFormat::JSON: {
+        CBlock block;
+        if (!ReadBlockFromDisk(block, pblockindex, chainman.GetParams().GetConsensus())) {
+            return RESTERR(req, HTTP_NOT_FOUND, hashStr + " not found");
+        }
         UniValue objBlock = blockToJSON(chainman.m_blockman, block, tip, pblockindex, tx_verbosity);
         std::string strJSON = objBlock.write() + "\n";
         req->WriteHeader("Content-Type", "application/json");
@@ -358,6 +465,53 @@ static bool rest_block_notxdetails(const std::any& context, HTTPRequest* req, co
     return rest_block(context, req, strURIPart, TxVerbosity::SHOW_TXID);
 }
 
+static bool rest_blockrange(const std::any& context, HTTPRequest* req, const std::string& strURIPart)
+{
+    if (!CheckWarmup(req)) return false;
+    std::string param;
+    const RESTResponseFormat rf = ParseDataFormat(param, strURIPart);
+    if (rf != RESTResponseFormat::BINARY && rf != RESTResponseFormat::HEX) {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: bin, hex)");
+    }
+
+    std::vector<std::string> path = SplitString(param, '/');
+    if (path.size() != 2) {
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid URI format. Expected /rest/blockrange/<height>/<count>.<bin|hex>");
+    }
+    int32_t height{-1};
+    if (!ParseInt32(path[0], &height) || height < 0) {
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid height: " + SanitizeString(path[0]));
+    }
+    const auto count{ToIntegral<size_t>(path[1])};
+    if (!count.has_value() || *count < 1) {
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid count: " + SanitizeString(path[1]));
+    }
+
+    ChainstateManager* maybe_chainman = GetChainman(context, req);
+    if (!maybe_chainman) return false;
+    ChainstateManager& chainman = *maybe_chainman;
+    const CBlockIndex* first = nullptr;
+    {
+        LOCK(cs_main);
+        const CChain& active_chain = chainman.ActiveChain();
+        if (height > active_chain.Height()) {
+            return RESTERR(req, HTTP_NOT_FOUND, "Block height out of range");
+        }
+        first = active_chain[height];
+        if (chainman.m_blockman.IsBlockPruned(first)) {
+            return RESTERR(req, HTTP_NOT_FOUND, first->GetBlockHash().GetHex() + " not available (pruned data)");
+        }
+    }
+
+    std::vector<uint8_t> block_data;
+    StreamChainRange(chainman, req, rf, first, *count, [&](const CBlockIndex* pindex, std::vector<uint8_t>& data) {
+        if (!ReadSerializedBlock(chainman, pindex, block_data)) return false;
+        data.insert(data.end(), block_data.begin(), block_data.end());
+        return true;
+    });
+    return true;
+}
+
 static bool rest_filter_header(const std::any& context, HTTPRequest* req, const std::string& strURIPart)
 {
     if (!CheckWarmup(req)) return false;
@@ -1001,6 +1155,286 @@ static bool rest_blockhash_by_height(const std::any& context, HTTPRequest* req,
     }
 }
 
+/**
+ * Reply with index records. The binary format is the serialization of
+ * std::vector<T> and the hex format its hex encoding; both are passed to the
+ * reply in chunks while the records are serialized. The JSON format is an
+ * array of to_json(record), written with a JSONStreamWriter.
+ */
+template <typename T, typename ToJSON>
+static bool WriteIndexRecords(HTTPRequest* req, RESTResponseFormat rf, const std::vector<T>& records, ToJSON to_json)
+{
+    switch (rf) {
+    case RESTResponseFormat::BINARY:
+    case RESTResponseFormat::HEX: {
+        req->WriteHeader("Content-Type", rf == RESTResponseFormat::BINARY ? "application/octet-stream" : "text/plain");
+        DataStream ss{};
+        const auto flush = [&] {
+            if (rf == RESTResponseFormat::BINARY) {
+                req->WriteReplyBody(ss);
+            } else {
+                req->WriteReplyBody(MakeByteSpan(HexStr(ss)));
+            }
+            ss.clear();
+        };
+        WriteCompactSize(ss, records.size());
+        for (const T& record : records) {
+            ss << record;
+            if (ss.size() >= REST_INDEX_CHUNK_SIZE) flush();
+        }
+        flush();
+        req->WriteReply(HTTP_OK, rf == RESTResponseFormat::HEX ? "\n" : "");
+        return true;
+    }
+    case RESTResponseFormat::JSON: {
+        req->WriteHeader("Content-Type", "application/json");
+        {
+            JSONStreamWriter writer{[req](Span<const char> data) { req->WriteReplyBody(MakeByteSpan(data)); }, REST_INDEX_CHUNK_SIZE};
+            writer.BeginArray();
+            for (size_t i = 0; i < records.size(); ++i) {
+                writer.Value(to_json(i));
+            }
+            writer.EndArray();
+            writer.Raw("\n");
+        }
+        req->WriteReply(HTTP_OK);
+        return true;
+    }
+    default: {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: " + AvailableDataFormatsString() + ")");
+    }
+    }
+}
+
+/** Parse the comma separated addresses of an address index query */
+static bool ParseIndexAddresses(HTTPRequest* req, const std::string& param, std::vector<std::pair<uint256, int>>& addresses)
+{
+    const std::vector<std::string> address_strs{SplitString(param, ',')};
+    if (address_strs.size() > MAX_REST_INDEX_ADDRESSES) {
+        return RESTERR(req, HTTP_BAD_REQUEST, strprintf("Error: max addresses exceeded (max %d, got %d)", MAX_REST_INDEX_ADDRESSES, address_strs.size()));
+    }
+    for (const std::string& address_str : address_strs) {
+        uint256 hash_bytes;
+        int type{0};
+        if (!getIndexKey(address_str, hash_bytes, type)) {
+            return RESTERR(req, HTTP_BAD_REQUEST, "Invalid address: " + SanitizeString(address_str));
+        }
+        addresses.emplace_back(hash_bytes, type);
+    }
+    return true;
+}
+
+/** Parse the optional start and end heights of an address index query */
+static bool ParseIndexRange(HTTPRequest* req, int& start, int& end)
+{
+    std::optional<std::string> start_str, end_str;
+    try {
+        start_str = req->GetQueryParameter("start");
+        end_str = req->GetQueryParameter("end");
+    } catch (const std::runtime_error& e) {
+        return RESTERR(req, HTTP_BAD_REQUEST, e.what());
+    }
+    if (!start_str && !end_str) return true;
+    if (!start_str || !end_str || !ParseInt32(*start_str, &start) || !ParseInt32(*end_str, &end) || start <= 0 || end < start) {
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid range, expected 0 < start <= end");
+    }
+    return true;
+}
+
+/** Encode the addresses of index records, which the JSON format includes */
+template <typename Key, typename Value>
+static bool GetIndexRecordAddresses(HTTPRequest* req, RESTResponseFormat rf, const std::vector<std::pair<Key, Value>>& records, std::vector<std::string>& addresses)
+{
+    if (rf != RESTResponseFormat::JSON) return true;
+    addresses.reserve(records.size());
+    for (const auto& record : records) {
+        std::string address;
+        if (!getAddressFromIndex(record.first.type, record.first.hashBytes, address)) {
+            return RESTERR(req, HTTP_INTERNAL_SERVER_ERROR, "Unknown address type");
+        }
+        addresses.push_back(std::move(address));
+    }
+    return true;
+}
+
+static bool rest_addressdeltas(const std::any& context, HTTPRequest* req, const std::string& str_uri_part)
+{
+    if (!CheckWarmup(req)) return false;
+    std::string param;
+    const RESTResponseFormat rf = ParseDataFormat(param, str_uri_part);
+
+    std::vector<std::pair<uint256, int>> addresses;
+    int start{0}, end{0};
+    if (!ParseIndexAddresses(req, param, addresses) || !ParseIndexRange(req, start, end)) return false;
+    if (!fAddressIndex) return RESTERR(req, HTTP_NOT_FOUND, "Address index is not enabled");
+    ChainstateManager* maybe_chainman = GetChainman(context, req);
+    if (!maybe_chainman) return false;
+
+    std::vector<std::pair<CAddressIndexKey, CAmount>> deltas;
+    for (const auto& [hash_bytes, type] : addresses) {
+        if (!GetAddressIndex(*maybe_chainman, hash_bytes, type, deltas, start, end)) {
+            return RESTERR(req, HTTP_NOT_FOUND, "No information available for address");
+        }
+    }
+    std::vector<std::string> delta_addresses;
+    if (!GetIndexRecordAddresses(req, rf, deltas, delta_addresses)) return false;
+
+    return WriteIndexRecords(req, rf, deltas, [&](size_t i) { return AddressDeltaToJSON(delta_addresses[i], deltas[i]); });
+}
+
+static bool rest_addressutxos(const std::any& context, HTTPRequest* req, const std::string& str_uri_part)
+{
+    if (!CheckWarmup(req)) return false;
+    std::string param;
+    const RESTResponseFormat rf = ParseDataFormat(param, str_uri_part);
+
+    std::vector<std::pair<uint256, int>> addresses;
+    if (!ParseIndexAddresses(req, param, addresses)) return false;
+    if (!fAddressIndex) return RESTERR(req, HTTP_NOT_FOUND, "Address index is not enabled");
+    ChainstateManager* maybe_chainman = GetChainman(context, req);
+    if (!maybe_chainman) return false;
+
+    std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue>> utxos;
+    for (const auto& [hash_bytes, type] : addresses) {
+        if (!GetAddressUnspent(*maybe_chainman, hash_bytes, type, utxos)) {
+            return RESTERR(req, HTTP_NOT_FOUND, "No information available for address");
+        }
+    }
+    std::sort(utxos.begin(), utxos.end(), heightSort);
+    std::vector<std::string> utxo_addresses;
+    if (!GetIndexRecordAddresses(req, rf, utxos, utxo_addresses)) return false;
+
+    return WriteIndexRecords(req, rf, utxos, [&](size_t i) { return AddressUtxoToJSON(utxo_addresses[i], utxos[i]); });
+}
+
+static bool rest_addresstxids(const std::any& context, HTTPRequest* req, const std::string& str_uri_part)
+{
+    if (!CheckWarmup(req)) return false;
+    std::string param;
+    const RESTResponseFormat rf = ParseDataFormat(param, str_uri_part);
+
+    std::vector<std::pair<uint256, int>> addresses;
+    int start{0}, end{0};
+    if (!ParseIndexAddresses(req, param, addresses) || !ParseIndexRange(req, start, end)) return false;
+    if (!fAddressIndex) return RESTERR(req, HTTP_NOT_FOUND, "Address index is not enabled");
+    ChainstateManager* maybe_chainman = GetChainman(context, req);
+    if (!maybe_chainman) return false;
+
+    std::vector<std::pair<CAddressIndexKey, CAmount>> deltas;
+    for (const auto& [hash_bytes, type] : addresses) {
+        if (!GetAddressIndex(*maybe_chainman, hash_bytes, type, deltas, start, end)) {
+            return RESTERR(req, HTTP_NOT_FOUND, "No information available for address");
+        }
+    }
+    // Like getaddresstxids: each transaction once, ordered by height
+    std::set<std::pair<int, uint256>> seen;
+    std::vector<uint256> txids;
+    for (const auto& [key, amount] : deltas) {
+        if (seen.emplace(key.blockHeight, key.txhash).second && addresses.size() == 1) {
+            txids.push_back(key.txhash);
+        }
+    }
+    if (addresses.size() > 1) {
+        for (const auto& [height, txid] : seen) {
+            txids.push_back(txid);
+        }
+    }
+
+    return WriteIndexRecords(req, rf, txids, [&](size_t i) { return UniValue{txids[i].GetHex()}; });
+}
+
+/** Result of a spent index lookup: whether the output is spent, followed by where if it is */
+struct SpentInfoRecord {
+    bool spent{false};
+    CSpentIndexValue value;
+
+    SERIALIZE_METHODS(SpentInfoRecord, obj)
+    {
+        READWRITE(obj.spent);
+        if (obj.spent) READWRITE(obj.value);
+    }
+};
+
+static bool rest_spentinfo(const std::any& context, HTTPRequest* req, const std::string& str_uri_part)
+{
+    if (!CheckWarmup(req)) return false;
+    std::string param;
+    const RESTResponseFormat rf = ParseDataFormat(param, str_uri_part);
+
+    std::vector<CSpentIndexKey> outpoints;
+    for (const std::string& outpoint_str : SplitString(param, '/')) {
+        const size_t pos{outpoint_str.find('-')};
+        uint256 txid;
+        uint32_t n;
+        if (pos == std::string::npos || !ParseHashStr(outpoint_str.substr(0, pos), txid) || !ParseUInt32(outpoint_str.substr(pos + 1), &n)) {
+            return RESTERR(req, HTTP_BAD_REQUEST, "Parse error");
+        }
+        outpoints.emplace_back(txid, n);
+    }
+    if (outpoints.size() > MAX_REST_SPENTINFO_OUTPOINTS) {
+        return RESTERR(req, HTTP_BAD_REQUEST, strprintf("Error: max outpoints exceeded (max %d, got %d)", MAX_REST_SPENTINFO_OUTPOINTS, outpoints.size()));
+    }
+    if (!fSpentIndex) return RESTERR(req, HTTP_NOT_FOUND, "Spent index is not enabled");
+    ChainstateManager* maybe_chainman = GetChainman(context, req);
+    if (!maybe_chainman) return false;
+    const CTxMemPool* mempool = GetMemPool(context, req);
+    if (!mempool) return false;
+
+    std::vector<SpentInfoRecord> records(outpoints.size());
+    for (size_t i = 0; i < outpoints.size(); ++i) {
+        records[i].spent = GetSpentIndex(*maybe_chainman, outpoints[i], records[i].value, mempool);
+    }
+
+    return WriteIndexRecords(req, rf, records, [&](size_t i) {
+        // Same fields as getspentinfo, or null for unspent outputs
+        UniValue obj;
+        if (records[i].spent) {
+            obj.setObject();
+            obj.pushKV("txid", records[i].value.txid.GetHex());
+            obj.pushKV("index", int(records[i].value.inputIndex));
+            obj.pushKV("height", records[i].value.blockHeight);
+        }
+        return obj;
+    });
+}
+
+static bool rest_blockhashes(const std::any& context, HTTPRequest* req, const std::string& str_uri_part)
+{
+    if (!CheckWarmup(req)) return false;
+    std::string param;
+    const RESTResponseFormat rf = ParseDataFormat(param, str_uri_part);
+
+    const std::vector<std::string> path{SplitString(param, '/')};
+    uint32_t high, low;
+    if (path.size() != 2 || !ParseUInt32(path[0], &high) || !ParseUInt32(path[1], &low)) {
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid URI format. Expected /rest/blockhashes/<high>/<low>.<ext>");
+    }
+    bool active_only{false};
+    try {
+        active_only = req->GetQueryParameter("noorphans").value_or("0") == "1";
+    } catch (const std::runtime_error& e) {
+        return RESTERR(req, HTTP_BAD_REQUEST, e.what());
+    }
+    if (!fTimestampIndex) return RESTERR(req, HTTP_NOT_FOUND, "Timestamp index is not enabled");
+    ChainstateManager* maybe_chainman = GetChainman(context, req);
+    if (!maybe_chainman) return false;
+
+    std::vector<std::pair<uint256, unsigned int>> hashes;
+    {
+        LOCK(cs_main);
+        if (!GetTimestampIndex(*maybe_chainman, high, low, active_only, hashes)) {
+            return RESTERR(req, HTTP_NOT_FOUND, "No information available for block hashes");
+        }
+    }
+
+    return WriteIndexRecords(req, rf, hashes, [&](size_t i) {
+        UniValue item(UniValue::VOBJ);
+        item.pushKV("blockhash", hashes[i].first.GetHex());
+        item.pushKV("logicalts", int(hashes[i].second));
+        return item;
+    });
+}
+
 static const struct {
     const char* prefix;
     bool (*handler)(const std::any& context, HTTPRequest* req, const std::string& strReq);
@@ -1008,6 +1442,7 @@ static const struct {
       {"/rest/tx/", rest_tx},
       {"/rest/block/notxdetails/", rest_block_notxdetails},
       {"/rest/block/", rest_block_extended},
+      {"/rest/blockrange/", rest_blockrange},
       {"/rest/blockfilter/", rest_block_filter},
       {"/rest/blockfilterheaders/", rest_filter_header},
       {"/rest/chaininfo", rest_chaininfo},
@@ -1017,6 +1452,11 @@ static const struct {
       {"/rest/deploymentinfo/", rest_deploymentinfo},
       {"/rest/deploymentinfo", rest_deploymentinfo},
       {"/rest/blockhashbyheight/", rest_blockhash_by_height},
+      {"/rest/addressdeltas/", rest_addressdeltas},
+      {"/rest/addressutxos/", rest_addressutxos},
+      {"/rest/addresstxids/", rest_addresstxids},
+      {"/rest/spentinfo/", rest_spentinfo},
+      {"/rest/blockhashes/", rest_blockhashes},
 };
 
 void StartREST(const std::any& context)
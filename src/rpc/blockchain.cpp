@@ -27,6 +27,7 @@
 #include <node/transaction.h>
 #include <node/utxo_snapshot.h>
 #include <primitives/transaction.h>
+#include <rpc/jsonstream.h>
 #include <rpc/server.h>
 #include <rpc/server_util.h>
 #include <rpc/util.h>
@@ -59,6 +60,7 @@ using kernel::CoinStatsHashType;
 using node::BlockManager;
 using node::NodeContext;
 using node::ReadBlockFromDisk;
+using node::ReadRawBlockFromDisk;
 using node::SnapshotMetadata;
 using node::UndoReadFromDisk;
 
@@ -163,13 +165,37 @@ UniValue blockheaderToJSON(const CBlockIndex* tip, const CBlockIndex* blockindex
     return result;
 }
 
-UniValue blockToJSON(BlockManager& blockman, const CBlock& block, const CBlockIndex* tip, const CBlockIndex* blockindex, TxVerbosity verbosity)
+/** The fields of the getblock result other than "tx" */
+static UniValue blockInfoToJSON(const CBlock& block, const CBlockIndex* tip, const CBlockIndex* blockindex)
 {
     UniValue result = blockheaderToJSON(tip, blockindex);
 
     result.pushKV("strippedsize", (int)::GetSerializeSize(block, PROTOCOL_VERSION | SERIALIZE_TRANSACTION_NO_WITNESS));
     result.pushKV("size", (int)::GetSerializeSize(block, PROTOCOL_VERSION));
     result.pushKV("weight", (int)::GetBlockWeight(block));
+    return result;
+}
+
+/** Pass the objects describing the transactions of a block in detail to fn, one at a time */
+static void ForEachBlockTxToJSON(BlockManager& blockman, const CBlock& block, const CBlockIndex* blockindex, TxVerbosity verbosity, const std::function<void(UniValue&&)>& fn)
+{
+    CBlockUndo blockUndo;
+    const bool is_not_pruned{WITH_LOCK(::cs_main, return !blockman.IsBlockPruned(blockindex))};
+    const bool have_undo{is_not_pruned && UndoReadFromDisk(blockUndo, blockindex)};
+
+    for (size_t i = 0; i < block.vtx.size(); ++i) {
+        const CTransactionRef& tx = block.vtx.at(i);
+        // coinbase transaction (i.e. i == 0) doesn't have undo data
+        const CTxUndo* txundo = (have_undo && i > 0) ? &blockUndo.vtxundo.at(i - 1) : nullptr;
+        UniValue objTx(UniValue::VOBJ);
+        TxToUniv(*tx, /*block_hash=*/uint256(), /*entry=*/objTx, /*include_hex=*/true, RPCSerializationFlags(), txundo, verbosity);
+        fn(std::move(objTx));
+    }
+}
+
+UniValue blockToJSON(BlockManager& blockman, const CBlock& block, const CBlockIndex* tip, const CBlockIndex* blockindex, TxVerbosity verbosity)
+{
+    UniValue result = blockInfoToJSON(block, tip, blockindex);
     UniValue txs(UniValue::VARR);
 
     switch (verbosity) {
@@ -181,18 +207,7 @@ UniValue blockToJSON(BlockManager& blockman, const CBlock& block, const CBlockIn
 
         case TxVerbosity::SHOW_DETAILS:
         case TxVerbosity::SHOW_DETAILS_AND_PREVOUT:
-            CBlockUndo blockUndo;
-            const bool is_not_pruned{WITH_LOCK(::cs_main, return !blockman.IsBlockPruned(blockindex))};
-            const bool have_undo{is_not_pruned && UndoReadFromDisk(blockUndo, blockindex)};
-
-            for (size_t i = 0; i < block.vtx.size(); ++i) {
-                const CTransactionRef& tx = block.vtx.at(i);
-                // coinbase transaction (i.e. i == 0) doesn't have undo data
-                const CTxUndo* txundo = (have_undo && i > 0) ? &blockUndo.vtxundo.at(i - 1) : nullptr;
-                UniValue objTx(UniValue::VOBJ);
-                TxToUniv(*tx, /*block_hash=*/uint256(), /*entry=*/objTx, /*include_hex=*/true, RPCSerializationFlags(), txundo, verbosity);
-                txs.push_back(objTx);
-            }
+            ForEachBlockTxToJSON(blockman, block, blockindex, verbosity, [&](UniValue&& objTx) { txs.push_back(std::move(objTx)); });
             break;
     }
 
@@ -201,6 +216,28 @@ UniValue blockToJSON(BlockManager& blockman, const CBlock& block, const CBlockIn
     return result;
 }
 
+void blockToJSON(JSONStreamWriter& writer, BlockManager& blockman, const CBlock& block, const CBlockIndex* tip, const CBlockIndex* blockindex, TxVerbosity verbosity)
+{
+    writer.BeginObject();
+    writer.Members(blockInfoToJSON(block, tip, blockindex));
+    writer.Key("tx");
+    writer.BeginArray();
+    switch (verbosity) {
+        case TxVerbosity::SHOW_TXID:
+            for (const CTransactionRef& tx : block.vtx) {
+                writer.Value(tx->GetHash().GetHex());
+            }
+            break;
+
+        case TxVerbosity::SHOW_DETAILS:
+        case TxVerbosity::SHOW_DETAILS_AND_PREVOUT:
+            ForEachBlockTxToJSON(blockman, block, blockindex, verbosity, [&](UniValue&& objTx) { writer.Value(objTx); });
+            break;
+    }
+    writer.EndArray();
+    writer.EndObject();
+}
+
 static RPCHelpMan getblockcount()
 {
     return RPCHelpMan{"getblockcount",
@@ -597,6 +634,23 @@ static CBlock GetBlockChecked(BlockManager& blockman, const CBlockIndex* pblocki
     return block;
 }
 
+static std::vector<uint8_t> GetRawBlockChecked(BlockManager& blockman, const CBlockIndex* pblockindex)
+{
+    std::vector<uint8_t> data;
+    {
+        LOCK(cs_main);
+        if (blockman.IsBlockPruned(pblockindex)) {
+            throw JSONRPCError(RPC_MISC_ERROR, "Block not available (pruned data)");
+        }
+    }
+
+    if (!ReadRawBlockFromDisk(data, pblockindex, Params().MessageStart())) {
+        throw JSONRPCError(RPC_MISC_ERROR, "Block not found on disk");
+    }
+
+    return data;
+}
+
 static CBlockUndo GetUndoChecked(BlockManager& blockman, const CBlockIndex* pblockindex)
 {
     CBlockUndo blockUndo;
@@ -642,6 +696,19 @@ const RPCResult getblock_vin{
     }
 };
 
+static int ParseGetBlockVerbosity(const UniValue& param)
+{
+    int verbosity = 1;
+    if (!param.isNull()) {
+        if (param.isBool()) {
+            verbosity = param.get_bool() ? 1 : 0;
+        } else {
+            verbosity = param.getInt<int>();
+        }
+    }
+    return verbosity;
+}
+
 static RPCHelpMan getblock()
 {
     return RPCHelpMan{"getblock",
@@ -715,14 +782,7 @@ static RPCHelpMan getblock()
 {
     uint256 hash(ParseHashV(request.params[0], "blockhash"));
 
-    int verbosity = 1;
-    if (!request.params[1].isNull()) {
-        if (request.params[1].isBool()) {
-            verbosity = request.params[1].get_bool() ? 1 : 0;
-        } else {
-            verbosity = request.params[1].getInt<int>();
-        }
-    }
+    const int verbosity{ParseGetBlockVerbosity(request.params[1])};
 
     const CBlockIndex* pblockindex;
     const CBlockIndex* tip;
@@ -737,16 +797,22 @@ static RPCHelpMan getblock()
         }
     }
 
-    const CBlock block{GetBlockChecked(chainman.m_blockman, pblockindex)};
-
     if (verbosity <= 0)
     {
+        // Blocks are stored with witness serialization, so unless that is
+        // disabled the bytes on disk can be returned as they are.
+        if (RPCSerializationFlags() == 0) {
+            return HexStr(GetRawBlockChecked(chainman.m_blockman, pblockindex));
+        }
+        const CBlock block{GetBlockChecked(chainman.m_blockman, pblockindex)};
         CDataStream ssBlock(SER_NETWORK, PROTOCOL_VERSION | RPCSerializationFlags());
         ssBlock << block;
         std::string strHex = HexStr(ssBlock);
         return strHex;
     }
 
+    const CBlock block{GetBlockChecked(chainman.m_blockman, pblockindex)};
+
     TxVerbosity tx_verbosity;
     if (verbosity == 1) {
         tx_verbosity = TxVerbosity::SHOW_TXID;
@@ -761,6 +827,34 @@ static RPCHelpMan getblock()
     };
 }
 
+/** Stream the results of getblock with transaction details, which can be many times the size of the block */
+static RPCResultWriter getblock_stream(const JSONRPCRequest& request)
+{
+    getblock().CheckRequest(request);
+    uint256 hash(ParseHashV(request.params[0], "blockhash"));
+    const int verbosity{ParseGetBlockVerbosity(request.params[1])};
+    if (verbosity < 2) return nullptr;
+
+    const CBlockIndex* pblockindex;
+    const CBlockIndex* tip;
+    ChainstateManager& chainman = EnsureAnyChainman(request.context);
+    {
+        LOCK(cs_main);
+        pblockindex = chainman.m_blockman.LookupBlockIndex(hash);
+        tip = chainman.ActiveChain().Tip();
+
+        if (!pblockindex) {
+            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Block not found");
+        }
+    }
+
+    auto block{std::make_shared<const CBlock>(GetBlockChecked(chainman.m_blockman, pblockindex))};
+    const TxVerbosity tx_verbosity{verbosity == 2 ? TxVerbosity::SHOW_DETAILS : TxVerbosity::SHOW_DETAILS_AND_PREVOUT};
+    return [&blockman = chainman.m_blockman, block, tip, pblockindex, tx_verbosity](JSONStreamWriter& writer) {
+        blockToJSON(writer, blockman, *block, tip, pblockindex, tx_verbosity);
+    };
+}
+
 static RPCHelpMan pruneblockchain()
 {
     return RPCHelpMan{"pruneblockchain", "",
@@ -2735,4 +2829,5 @@ void RegisterBlockchainRPCCommands(CRPCTable& t)
     for (const auto& c : commands) {
         t.appendCommand(c.name, &c);
     }
+    t.appendStreamHandler("getblock", &getblock_stream);
 }
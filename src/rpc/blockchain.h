@@ -19,6 +19,7 @@
 class CBlock;
 class CBlockIndex;
 class Chainstate;
+class JSONStreamWriter;
 class UniValue;
 namespace node {
 struct NodeContext;
@@ -39,6 +40,8 @@ void RPCNotifyBlockChange(const CBlockIndex*);
 
 /** Block description to JSON */
 UniValue blockToJSON(node::BlockManager& blockman, const CBlock& block, const CBlockIndex* tip, const CBlockIndex* blockindex, TxVerbosity verbosity) LOCKS_EXCLUDED(cs_main);
+/** Block description written to a stream, as blockToJSON(...).write() */
+void blockToJSON(JSONStreamWriter& writer, node::BlockManager& blockman, const CBlock& block, const CBlockIndex* tip, const CBlockIndex* blockindex, TxVerbosity verbosity) LOCKS_EXCLUDED(cs_main);
 
 /** Block header to JSON */
 UniValue blockheaderToJSON(const CBlockIndex* tip, const CBlockIndex* blockindex) LOCKS_EXCLUDED(cs_main);
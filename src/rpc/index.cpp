@@ -3,7 +3,10 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <rpc/index.h>
+
 #include <node/context.h>
+#include <rpc/jsonstream.h>
 #include <rpc/server.h>
 #include <rpc/server_util.h>
 #include <rpc/util.h>
@@ -19,6 +22,7 @@
 #include <condition_variable>
 #include <memory>
 #include <mutex>
+#include <optional>
 
 using node::NodeContext;
 
@@ -54,7 +58,7 @@ bool getAddressFromIndex(const int &type, const uint256 &hash, std::string &addr
     return true;
 }
 
-static bool getIndexKey(const std::string& str, uint256& hashBytes, int& type)
+bool getIndexKey(const std::string& str, uint256& hashBytes, int& type)
 {
     CTxDestination dest = DecodeDestination(str);
     if (!IsValidDestination(dest)) {
@@ -147,7 +151,7 @@ bool GetSpentIndex(ChainstateManager &chainman, const CSpentIndexKey &key, CSpen
 };
 
 bool GetAddressIndex(ChainstateManager &chainman, const uint256 &addressHash, int type,
-                     std::vector<std::pair<CAddressIndexKey, CAmount> > &addressIndex, int start = 0, int end = 0)
+                     std::vector<std::pair<CAddressIndexKey, CAmount> > &addressIndex, int start, int end)
 {
     auto& pblocktree{chainman.m_blockman.m_block_tree_db};
 
@@ -349,47 +353,16 @@ static RPCHelpMan getaddressesbalance()
 }
 
 
-static RPCHelpMan getaddressutxos()
+/** Outputs requested by getaddressutxos, sorted by height, with their addresses */
+struct AddressUtxos
 {
-return RPCHelpMan{"getaddressutxos",
-                "\nReturns all unspent outputs for an address (requires addressindex to be enabled).\n",
-                {
-                    {"addresses", RPCArg::Type::ARR, RPCArg::Optional::NO, "A json array with addresses.\n",
-                        {
-                            {"address", RPCArg::Type::STR, RPCArg::Optional::NO, "The base58check encoded address."},
-                        },
-                    RPCArgOptions{.skip_type_check = true}},
-                    {"chainInfo", RPCArg::Type::BOOL, RPCArg::Default{false}, "Include chain info in results, only applies if start and end specified."},
-                },
-                {
-                    RPCResult{"Default",
-                        RPCResult::Type::ARR, "", "", {
-                            {RPCResult::Type::OBJ, "", "", {
-                                {RPCResult::Type::STR, "address", "The base58check encoded address"},
-                                {RPCResult::Type::STR_HEX, "txid", "The output txid"},
-                                {RPCResult::Type::NUM, "height", "The block height"},
-                                {RPCResult::Type::NUM, "outputIndex", "The output index"},
-                                {RPCResult::Type::STR_HEX, "script", "The script hex encoded"},
-                                {RPCResult::Type::NUM, "satoshis", "The number of satoshis of the output"},
-                            }}
-                        }
-                    },
-                    RPCResult{"With chainInfo", RPCResult::Type::OBJ, "", "", {
-                        {RPCResult::Type::STR_HEX, "hash", "Start hash"},
-                        {RPCResult::Type::NUM, "height", "Chain height"},
-                        {RPCResult::Type::ARR, "utxos", "", {
-                            {RPCResult::Type::OBJ, "", "", {
-                                {RPCResult::Type::ELISION, "", "Same as Default"},
-                            }}
-                        }}
-                    }}
-                },
-                RPCExamples{
-            HelpExampleCli("getaddressutxos", "'{\"addresses\": [\"Pb7FLL3DyaAVP2eGfRiEkj4U8ZJ3RHLY9g\"]}'") +
-            "\nAs a JSON-RPC call\n"
-            + HelpExampleRpc("getaddressutxos", "{\"addresses\": [\"Pb7FLL3DyaAVP2eGfRiEkj4U8ZJ3RHLY9g\"]}")
-                },
-        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+    std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > outputs;
+    std::vector<std::string> addresses;
+    //! Tip hash and height, if chain info was requested
+    std::optional<std::pair<uint256, int> > chain_info;
+};
+
+static AddressUtxos LookupAddressUtxos(const JSONRPCRequest& request)
 {
     ChainstateManager &chainman = EnsureAnyChainman(request.context);
 
@@ -410,98 +383,137 @@ return RPCHelpMan{"getaddressutxos",
         throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Invalid address");
     }
 
-    std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > unspentOutputs;
+    AddressUtxos result;
     for (std::vector<std::pair<uint256, int> >::iterator it = addresses.begin(); it != addresses.end(); it++) {
-        if (!GetAddressUnspent(chainman, it->first, it->second, unspentOutputs)) {
+        if (!GetAddressUnspent(chainman, it->first, it->second, result.outputs)) {
             throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
         }
     }
 
-    std::sort(unspentOutputs.begin(), unspentOutputs.end(), heightSort);
-
-    UniValue utxos(UniValue::VARR);
+    std::sort(result.outputs.begin(), result.outputs.end(), heightSort);
 
-    for (std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> >::const_iterator it=unspentOutputs.begin(); it!=unspentOutputs.end(); it++) {
-        UniValue output(UniValue::VOBJ);
+    for (std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> >::const_iterator it=result.outputs.begin(); it!=result.outputs.end(); it++) {
         std::string address;
         if (!getAddressFromIndex(it->first.type, it->first.hashBytes, address)) {
             throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Unknown address type");
         }
-
-        output.pushKV("address", address);
-        output.pushKV("txid", it->first.txhash.GetHex());
-        output.pushKV("outputIndex", int(it->first.index));
-        output.pushKV("script", HexStr(it->second.script));
-        output.pushKV("satoshis", it->second.satoshis);
-        output.pushKV("height", it->second.blockHeight);
-        utxos.push_back(output);
+        result.addresses.push_back(std::move(address));
     }
 
     if (includeChainInfo) {
-        UniValue result(UniValue::VOBJ);
-        result.pushKV("utxos", utxos);
-
         LOCK(cs_main);
-        result.pushKV("hash", chainman.ActiveChain().Tip()->GetBlockHash().GetHex());
-        result.pushKV("height", int(chainman.ActiveChain().Height()));
-        return result;
-    } else {
-        return utxos;
+        result.chain_info.emplace(chainman.ActiveChain().Tip()->GetBlockHash(), chainman.ActiveChain().Height());
     }
-},
-    };
+    return result;
 }
 
+UniValue AddressUtxoToJSON(const std::string& address, const std::pair<CAddressUnspentKey, CAddressUnspentValue>& utxo)
+{
+    UniValue output(UniValue::VOBJ);
+    output.pushKV("address", address);
+    output.pushKV("txid", utxo.first.txhash.GetHex());
+    output.pushKV("outputIndex", int(utxo.first.index));
+    output.pushKV("script", HexStr(utxo.second.script));
+    output.pushKV("satoshis", utxo.second.satoshis);
+    output.pushKV("height", utxo.second.blockHeight);
+    return output;
+}
 
-static RPCHelpMan getaddressdeltas()
+static RPCHelpMan getaddressutxos()
 {
-    return RPCHelpMan{"getaddressdeltas",
-                "\nReturns all changes for an address (requires addressindex to be enabled).\n",
+return RPCHelpMan{"getaddressutxos",
+                "\nReturns all unspent outputs for an address (requires addressindex to be enabled).\n",
                 {
                     {"addresses", RPCArg::Type::ARR, RPCArg::Optional::NO, "A json array with addresses.\n",
                         {
                             {"address", RPCArg::Type::STR, RPCArg::Optional::NO, "The base58check encoded address."},
                         },
                     RPCArgOptions{.skip_type_check = true}},
-                    {"start", RPCArg::Type::NUM, RPCArg::Default{0}, "The start block height."},
-                    {"end", RPCArg::Type::NUM, RPCArg::Default{0}, "The end block height."},
                     {"chainInfo", RPCArg::Type::BOOL, RPCArg::Default{false}, "Include chain info in results, only applies if start and end specified."},
                 },
                 {
                     RPCResult{"Default",
                         RPCResult::Type::ARR, "", "", {
                             {RPCResult::Type::OBJ, "", "", {
-                                {RPCResult::Type::NUM, "satoshis", "The difference of satoshis"},
-                                {RPCResult::Type::STR_HEX, "txid", "The related txid"},
-                                {RPCResult::Type::NUM, "index", "The block height"},
-                                {RPCResult::Type::NUM, "blockindex", "The index of the transaction in the block"},
-                                {RPCResult::Type::NUM, "height", "The block height"},
                                 {RPCResult::Type::STR, "address", "The base58check encoded address"},
+                                {RPCResult::Type::STR_HEX, "txid", "The output txid"},
+                                {RPCResult::Type::NUM, "height", "The block height"},
+                                {RPCResult::Type::NUM, "outputIndex", "The output index"},
+                                {RPCResult::Type::STR_HEX, "script", "The script hex encoded"},
+                                {RPCResult::Type::NUM, "satoshis", "The number of satoshis of the output"},
                             }}
                         }
                     },
                     RPCResult{"With chainInfo", RPCResult::Type::OBJ, "", "", {
-                        {RPCResult::Type::ARR, "deltas", "", {
+                        {RPCResult::Type::STR_HEX, "hash", "Start hash"},
+                        {RPCResult::Type::NUM, "height", "Chain height"},
+                        {RPCResult::Type::ARR, "utxos", "", {
                             {RPCResult::Type::OBJ, "", "", {
-                                {RPCResult::Type::ELISION, "", "Same output as Default output"},
+                                {RPCResult::Type::ELISION, "", "Same as Default"},
                             }}
-                        }},
-                        {RPCResult::Type::OBJ, "start", "", {
-                            {RPCResult::Type::STR_HEX, "hash", "Start hash"},
-                            {RPCResult::Type::NUM, "height", "Start height"},
-                        }},
-                        {RPCResult::Type::OBJ, "end", "", {
-                            {RPCResult::Type::STR_HEX, "hash", "End hash"},
-                            {RPCResult::Type::NUM, "height", "End height"},
-                        }},
+                        }}
                     }}
                 },
                 RPCExamples{
-            HelpExampleCli("getaddressdeltas", "'{\"addresses\": [\"Pb7FLL3DyaAVP2eGfRiEkj4U8ZJ3RHLY9g\"]}'") +
+            HelpExampleCli("getaddressutxos", "'{\"addresses\": [\"Pb7FLL3DyaAVP2eGfRiEkj4U8ZJ3RHLY9g\"]}'") +
             "\nAs a JSON-RPC call\n"
-            + HelpExampleRpc("getaddressdeltas", "{\"addresses\": [\"Pb7FLL3DyaAVP2eGfRiEkj4U8ZJ3RHLY9g\"]}")
+            + HelpExampleRpc("getaddressutxos", "{\"addresses\": [\"Pb7FLL3DyaAVP2eGfRiEkj4U8ZJ3RHLY9g\"]}")
                 },
         [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+{
+    const AddressUtxos utxos{LookupAddressUtxos(request)};
+
+    UniValue outputs(UniValue::VARR);
+    for (size_t i = 0; i < utxos.outputs.size(); ++i) {
+        outputs.push_back(AddressUtxoToJSON(utxos.addresses[i], utxos.outputs[i]));
+    }
+
+    if (utxos.chain_info) {
+        UniValue result(UniValue::VOBJ);
+        result.pushKV("utxos", outputs);
+        result.pushKV("hash", utxos.chain_info->first.GetHex());
+        result.pushKV("height", utxos.chain_info->second);
+        return result;
+    } else {
+        return outputs;
+    }
+},
+    };
+}
+
+/** Stream the results of getaddressutxos, which for busy addresses list many outputs */
+static RPCResultWriter getaddressutxos_stream(const JSONRPCRequest& request)
+{
+    getaddressutxos().CheckRequest(request);
+    auto utxos{std::make_shared<const AddressUtxos>(LookupAddressUtxos(request))};
+    return [utxos](JSONStreamWriter& writer) {
+        if (utxos->chain_info) {
+            writer.BeginObject();
+            writer.Key("utxos");
+        }
+        writer.BeginArray();
+        for (size_t i = 0; i < utxos->outputs.size(); ++i) {
+            writer.Value(AddressUtxoToJSON(utxos->addresses[i], utxos->outputs[i]));
+        }
+        writer.EndArray();
+        if (utxos->chain_info) {
+            writer.KeyValue("hash", utxos->chain_info->first.GetHex());
+            writer.KeyValue("height", utxos->chain_info->second);
+            writer.EndObject();
+        }
+    };
+}
+
+/** Balance changes requested by getaddressdeltas, with their addresses */
+struct AddressDeltas
+{
+    std::vector<std::pair<CAddressIndexKey, CAmount> > deltas;
+    std::vector<std::string> addresses;
+    //! Start and end of the range, if chain info was requested for one
+    std::optional<std::pair<UniValue, UniValue> > chain_info;
+};
+
+static AddressDeltas LookupAddressDeltas(const JSONRPCRequest& request)
 {
     if (!fAddressIndex) {
         throw JSONRPCError(RPC_MISC_ERROR, "Address index is not enabled.");
@@ -537,40 +549,27 @@ static RPCHelpMan getaddressdeltas()
         throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Invalid address");
     }
 
-    std::vector<std::pair<CAddressIndexKey, CAmount> > addressIndex;
-
+    AddressDeltas result;
     for (std::vector<std::pair<uint256, int> >::iterator it = addresses.begin(); it != addresses.end(); it++) {
         if (start > 0 && end > 0) {
-            if (!GetAddressIndex(chainman, it->first, it->second, addressIndex, start, end)) {
+            if (!GetAddressIndex(chainman, it->first, it->second, result.deltas, start, end)) {
                 throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
             }
         } else {
-            if (!GetAddressIndex(chainman, it->first, it->second, addressIndex)) {
+            if (!GetAddressIndex(chainman, it->first, it->second, result.deltas)) {
                 throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
             }
         }
     }
 
-    UniValue deltas(UniValue::VARR);
-
-    for (std::vector<std::pair<CAddressIndexKey, CAmount> >::const_iterator it=addressIndex.begin(); it!=addressIndex.end(); it++) {
+    for (std::vector<std::pair<CAddressIndexKey, CAmount> >::const_iterator it=result.deltas.begin(); it!=result.deltas.end(); it++) {
         std::string address;
         if (!getAddressFromIndex(it->first.type, it->first.hashBytes, address)) {
             throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Unknown address type");
         }
-
-        UniValue delta(UniValue::VOBJ);
-        delta.pushKV("satoshis", it->second);
-        delta.pushKV("txid", it->first.txhash.GetHex());
-        delta.pushKV("index", int(it->first.index));
-        delta.pushKV("blockindex", int(it->first.txindex));
-        delta.pushKV("height", it->first.blockHeight);
-        delta.pushKV("address", address);
-        deltas.push_back(delta);
+        result.addresses.push_back(std::move(address));
     }
 
-    UniValue result(UniValue::VOBJ);
-
     if (includeChainInfo && start > 0 && end > 0) {
         LOCK(cs_main);
         const int tip_height = chainman.ActiveChain().Height();
@@ -590,10 +589,85 @@ static RPCHelpMan getaddressdeltas()
         endInfo.pushKV("hash", endIndex->GetBlockHash().GetHex());
         endInfo.pushKV("height", end);
 
-        result.pushKV("deltas", deltas);
-        result.pushKV("start", startInfo);
-        result.pushKV("end", endInfo);
+        result.chain_info.emplace(std::move(startInfo), std::move(endInfo));
+    }
+    return result;
+}
+
+UniValue AddressDeltaToJSON(const std::string& address, const std::pair<CAddressIndexKey, CAmount>& index)
+{
+    UniValue delta(UniValue::VOBJ);
+    delta.pushKV("satoshis", index.second);
+    delta.pushKV("txid", index.first.txhash.GetHex());
+    delta.pushKV("index", int(index.first.index));
+    delta.pushKV("blockindex", int(index.first.txindex));
+    delta.pushKV("height", index.first.blockHeight);
+    delta.pushKV("address", address);
+    return delta;
+}
+
+static RPCHelpMan getaddressdeltas()
+{
+    return RPCHelpMan{"getaddressdeltas",
+                "\nReturns all changes for an address (requires addressindex to be enabled).\n",
+                {
+                    {"addresses", RPCArg::Type::ARR, RPCArg::Optional::NO, "A json array with addresses.\n",
+                        {
+                            {"address", RPCArg::Type::STR, RPCArg::Optional::NO, "The base58check encoded address."},
+                        },
+                    RPCArgOptions{.skip_type_check = true}},
+                    {"start", RPCArg::Type::NUM, RPCArg::Default{0}, "The start block height."},
+                    {"end", RPCArg::Type::NUM, RPCArg::Default{0}, "The end block height."},
+                    {"chainInfo", RPCArg::Type::BOOL, RPCArg::Default{false}, "Include chain info in results, only applies if start and end specified."},
+                },
+                {
+                    RPCResult{"Default",
+                        RPCResult::Type::ARR, "", "", {
+                            {RPCResult::Type::OBJ, "", "", {
+                                {RPCResult::Type::NUM, "satoshis", "The difference of satoshis"},
+                                {RPCResult::Type::STR_HEX, "txid", "The related txid"},
+                                {RPCResult::Type::NUM, "index", "The block height"},
+                                {RPCResult::Type::NUM, "blockindex", "The index of the transaction in the block"},
+                                {RPCResult::Type::NUM, "height", "The block height"},
+                                {RPCResult::Type::STR, "address", "The base58check encoded address"},
+                            }}
+                        }
+                    },
+                    RPCResult{"With chainInfo", RPCResult::Type::OBJ, "", "", {
+                        {RPCResult::Type::ARR, "deltas", "", {
+                            {RPCResult::Type::OBJ, "", "", {
+                                {RPCResult::Type::ELISION, "", "Same output as Default output"},
+                            }}
+                        }},
+                        {RPCResult::Type::OBJ, "start", "", {
+                            {RPCResult::Type::STR_HEX, "hash", "Start hash"},
+                            {RPCResult::Type::NUM, "height", "Start height"},
+                        }},
+                        {RPCResult::Type::OBJ, "end", "", {
+                            {RPCResult::Type::STR_HEX, "hash", "End hash"},
+                            {RPCResult::Type::NUM, "height", "End height"},
+                        }},
+                    }}
+                },
+                RPCExamples{
+            HelpExampleCli("getaddressdeltas", "'{\"addresses\": [\"Pb7FLL3DyaAVP2eGfRiEkj4U8ZJ3RHLY9g\"]}'") +
+            "\nAs a JSON-RPC call\n"
+            + HelpExampleRpc("getaddressdeltas", "{\"addresses\": [\"Pb7FLL3DyaAVP2eGfRiEkj4U8ZJ3RHLY9g\"]}")
+                },
+        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+{
+    const AddressDeltas index{LookupAddressDeltas(request)};
+
+    UniValue deltas(UniValue::VARR);
+    for (size_t i = 0; i < index.deltas.size(); ++i) {
+        deltas.push_back(AddressDeltaToJSON(index.addresses[i], index.deltas[i]));
+    }
 
+    if (index.chain_info) {
+        UniValue result(UniValue::VOBJ);
+        result.pushKV("deltas", deltas);
+        result.pushKV("start", index.chain_info->first);
+        result.pushKV("end", index.chain_info->second);
         return result;
     } else {
         return deltas;
@@ -602,6 +676,28 @@ static RPCHelpMan getaddressdeltas()
     };
 }
 
+/** Stream the results of getaddressdeltas, which for busy addresses list many changes */
+static RPCResultWriter getaddressdeltas_stream(const JSONRPCRequest& request)
+{
+    getaddressdeltas().CheckRequest(request);
+    auto index{std::make_shared<const AddressDeltas>(LookupAddressDeltas(request))};
+    return [index](JSONStreamWriter& writer) {
+        if (index->chain_info) {
+            writer.BeginObject();
+            writer.Key("deltas");
+        }
+        writer.BeginArray();
+        for (size_t i = 0; i < index->deltas.size(); ++i) {
+            writer.Value(AddressDeltaToJSON(index->addresses[i], index->deltas[i]));
+        }
+        writer.EndArray();
+        if (index->chain_info) {
+            writer.KeyValue("start", index->chain_info->first);
+            writer.KeyValue("end", index->chain_info->second);
+            writer.EndObject();
+        }
+    };
+}
 
 static RPCHelpMan getaddresstxids()
 {
@@ -927,4 +1023,6 @@ void RegisterIndexRPCCommands(CRPCTable& t)
     for (const auto& c : commands) {
         t.appendCommand(c.name, &c);
     }
+    t.appendStreamHandler("getaddressdeltas", &getaddressdeltas_stream);
+    t.appendStreamHandler("getaddressutxos", &getaddressutxos_stream);
 }
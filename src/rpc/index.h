@@ -0,0 +1,40 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_RPC_INDEX_H
+#define BITCOIN_RPC_INDEX_H
+
+#include <consensus/amount.h>
+#include <spentindex.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+class ChainstateManager;
+class CTxMemPool;
+class UniValue;
+class uint256;
+
+/** Encode the address of an address index entry */
+bool getAddressFromIndex(const int &type, const uint256 &hash, std::string &address);
+/** Decode an address into the hash and type used by the address index */
+bool getIndexKey(const std::string& str, uint256& hashBytes, int& type);
+
+bool heightSort(std::pair<CAddressUnspentKey, CAddressUnspentValue> a,
+                std::pair<CAddressUnspentKey, CAddressUnspentValue> b);
+
+bool GetSpentIndex(ChainstateManager &chainman, const CSpentIndexKey &key, CSpentIndexValue &value, const CTxMemPool *pmempool);
+bool GetAddressIndex(ChainstateManager &chainman, const uint256 &addressHash, int type,
+                     std::vector<std::pair<CAddressIndexKey, CAmount> > &addressIndex, int start = 0, int end = 0);
+bool GetAddressUnspent(ChainstateManager &chainman, const uint256 &addressHash, int type,
+                       std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > &unspentOutputs);
+/** Requires cs_main if fActiveOnly is set */
+bool GetTimestampIndex(ChainstateManager &chainman, const unsigned int &high, const unsigned int &low, const bool fActiveOnly, std::vector<std::pair<uint256, unsigned int> > &hashes);
+
+/** Address index entries to JSON, as listed by getaddressdeltas and getaddressutxos */
+UniValue AddressDeltaToJSON(const std::string& address, const std::pair<CAddressIndexKey, CAmount>& index);
+UniValue AddressUtxoToJSON(const std::string& address, const std::pair<CAddressUnspentKey, CAddressUnspentValue>& utxo);
+
+#endif // BITCOIN_RPC_INDEX_H
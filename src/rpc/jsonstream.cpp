@@ -0,0 +1,104 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <rpc/jsonstream.h>
+
+#include <util/check.h>
+
+#include <utility>
+
+JSONStreamWriter::JSONStreamWriter(Sink sink, size_t flush_size)
+    : m_sink{std::move(sink)}, m_flush_size{flush_size}
+{
+    m_buffer.reserve(m_flush_size);
+}
+
+JSONStreamWriter::~JSONStreamWriter()
+{
+    Flush();
+}
+
+void JSONStreamWriter::Separate()
+{
+    if (m_need_comma) m_buffer += ',';
+    m_need_comma = true;
+}
+
+void JSONStreamWriter::MaybeFlush()
+{
+    if (m_buffer.size() >= m_flush_size) Flush();
+}
+
+void JSONStreamWriter::BeginObject()
+{
+    Separate();
+    m_buffer += '{';
+    m_need_comma = false;
+}
+
+void JSONStreamWriter::EndObject()
+{
+    m_buffer += '}';
+    m_need_comma = true;
+    MaybeFlush();
+}
+
+void JSONStreamWriter::BeginArray()
+{
+    Separate();
+    m_buffer += '[';
+    m_need_comma = false;
+}
+
+void JSONStreamWriter::EndArray()
+{
+    m_buffer += ']';
+    m_need_comma = true;
+    MaybeFlush();
+}
+
+void JSONStreamWriter::Key(std::string_view key)
+{
+    Separate();
+    m_buffer += UniValue{std::string{key}}.write();
+    m_buffer += ':';
+    // The value completes the member
+    m_need_comma = false;
+}
+
+void JSONStreamWriter::Value(const UniValue& value)
+{
+    Separate();
+    m_buffer += value.write();
+    MaybeFlush();
+}
+
+void JSONStreamWriter::KeyValue(std::string_view key, const UniValue& value)
+{
+    Key(key);
+    Value(value);
+}
+
+void JSONStreamWriter::Members(const UniValue& object)
+{
+    CHECK_NONFATAL(object.isObject());
+    const std::vector<std::string>& keys{object.getKeys()};
+    const std::vector<UniValue>& values{object.getValues()};
+    for (size_t i = 0; i < keys.size(); ++i) {
+        KeyValue(keys[i], values[i]);
+    }
+}
+
+void JSONStreamWriter::Raw(std::string_view text)
+{
+    m_buffer += text;
+    MaybeFlush();
+}
+
+void JSONStreamWriter::Flush()
+{
+    if (m_buffer.empty()) return;
+    m_sink(m_buffer);
+    m_buffer.clear();
+}
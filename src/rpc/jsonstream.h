@@ -0,0 +1,66 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_RPC_JSONSTREAM_H
+#define BITCOIN_RPC_JSONSTREAM_H
+
+#include <span.h>
+
+#include <functional>
+#include <string>
+#include <string_view>
+
+#include <univalue.h>
+
+/**
+ * Writes JSON to a sink while it is being generated, so that a large result
+ * never has to exist as a whole UniValue tree or string. The output is the
+ * same as UniValue::write() without indentation.
+ *
+ * Structure is written with Begin/End calls; complete values, such as the
+ * object describing one transaction, can be passed as UniValue.
+ */
+class JSONStreamWriter
+{
+public:
+    using Sink = std::function<void(Span<const char> data)>;
+
+    //! Number of bytes collected before they are passed on to the sink
+    static constexpr size_t DEFAULT_FLUSH_SIZE{64 * 1024};
+
+    explicit JSONStreamWriter(Sink sink, size_t flush_size = DEFAULT_FLUSH_SIZE);
+    //! Passes the remaining output on to the sink
+    ~JSONStreamWriter();
+
+    JSONStreamWriter(const JSONStreamWriter&) = delete;
+    JSONStreamWriter& operator=(const JSONStreamWriter&) = delete;
+
+    void BeginObject();
+    void EndObject();
+    void BeginArray();
+    void EndArray();
+    //! Write the key of the next member of the current object
+    void Key(std::string_view key);
+    void Value(const UniValue& value);
+    //! Write a member of the current object
+    void KeyValue(std::string_view key, const UniValue& value);
+    //! Write all members of an object as members of the current object
+    void Members(const UniValue& object);
+    //! Write text as is, e.g. the newline terminating a reply
+    void Raw(std::string_view text);
+    void Flush();
+
+private:
+    //! Write a separator if the current object or array already has a member
+    void Separate();
+    void MaybeFlush();
+
+    Sink m_sink;
+    const size_t m_flush_size;
+    std::string m_buffer;
+    //! Whether the next member needs a separator
+    bool m_need_comma{false};
+};
+
+#endif // BITCOIN_RPC_JSONSTREAM_H
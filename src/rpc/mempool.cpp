@@ -14,6 +14,7 @@
 #include <policy/rbf.h>
 #include <policy/settings.h>
 #include <primitives/transaction.h>
+#include <rpc/jsonstream.h>
 #include <rpc/server.h>
 #include <rpc/server_util.h>
 #include <rpc/util.h>
@@ -378,6 +379,19 @@ UniValue MempoolToJSON(const CTxMemPool& pool, bool verbose, bool include_mempoo
     }
 }
 
+/** Verbose MempoolToJSON() written to a stream */
+static void MempoolToJSON(JSONStreamWriter& writer, const CTxMemPool& pool)
+{
+    LOCK(pool.cs);
+    writer.BeginObject();
+    for (const CTxMemPoolEntry& e : pool.mapTx) {
+        UniValue info(UniValue::VOBJ);
+        entryToJSON(pool, info, e);
+        writer.KeyValue(e.GetTx().GetHash().ToString(), info);
+    }
+    writer.EndObject();
+}
+
 static RPCHelpMan getrawmempool()
 {
     return RPCHelpMan{"getrawmempool",
@@ -428,6 +442,18 @@ static RPCHelpMan getrawmempool()
     };
 }
 
+/** Stream the verbose results of getrawmempool, which describe every transaction of the mempool */
+static RPCResultWriter getrawmempool_stream(const JSONRPCRequest& request)
+{
+    getrawmempool().CheckRequest(request);
+    const bool verbose{!request.params[0].isNull() && request.params[0].get_bool()};
+    const bool include_mempool_sequence{!request.params[1].isNull() && request.params[1].get_bool()};
+    if (!verbose || include_mempool_sequence) return nullptr;
+
+    const CTxMemPool& pool{EnsureAnyMemPool(request.context)};
+    return [&pool](JSONStreamWriter& writer) { MempoolToJSON(writer, pool); };
+}
+
 static RPCHelpMan getmempoolancestors()
 {
     return RPCHelpMan{"getmempoolancestors",
@@ -927,4 +953,5 @@ void RegisterMempoolRPCCommands(CRPCTable& t)
     for (const auto& c : commands) {
         t.appendCommand(c.name, &c);
     }
+    t.appendStreamHandler("getrawmempool", &getrawmempool_stream);
 }
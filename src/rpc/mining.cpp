@@ -42,10 +42,10 @@
 #include <stdint.h>
 
 using node::BlockAssembler;
+using node::BlockTemplateManager;
 using node::CBlockTemplate;
 using node::NodeContext;
 using node::RegenerateCommitments;
-using node::UpdateTime;
 
 /**
  * Return average network hashes per second based on the last 'lookup' blocks,
@@ -677,33 +677,41 @@ static RPCHelpMan getblocktemplate()
 
     static unsigned int nTransactionsUpdatedLast;
     const CTxMemPool& mempool = EnsureMemPool(node);
+    BlockTemplateManager* const template_manager{node.block_template_manager.get()};
 
     if (!lpval.isNull())
     {
-        // Wait to respond until either the best block changes, OR a minute has passed and there are more transactions
+        // Wait to respond until either the best block changes, the template
+        // fees grow, OR a minute has passed and there are more transactions
         uint256 hashWatchedChain;
-        std::chrono::steady_clock::time_point checktxtime;
-        unsigned int nTransactionsUpdatedLastLP;
+        uint64_t update_id;
 
         if (lpval.isStr())
         {
-            // Format: <hashBestChain><nTransactionsUpdatedLast>
+            // Format: <hashBestChain><update id, or nTransactionsUpdatedLast without a template manager>
             const std::string& lpstr = lpval.get_str();
 
             hashWatchedChain = ParseHashV(lpstr.substr(0, 64), "longpollid");
-            nTransactionsUpdatedLastLP = LocaleIndependentAtoi<int64_t>(lpstr.substr(64));
+            update_id = LocaleIndependentAtoi<uint64_t>(lpstr.substr(64));
         }
         else
         {
             // NOTE: Spec does not specify behaviour for non-string longpollid, but this makes testing easier
             hashWatchedChain = active_chain.Tip()->GetBlockHash();
-            nTransactionsUpdatedLastLP = nTransactionsUpdatedLast;
+            update_id = template_manager ? template_manager->GetUpdateId() : nTransactionsUpdatedLast;
         }
 
+        // A tip change after the lock is released is a new update as well
+        const bool tip_changed{hashWatchedChain != active_chain.Tip()->GetBlockHash()};
+
         // Release lock while waiting
         LEAVE_CRITICAL_SECTION(cs_main);
-        {
-            checktxtime = std::chrono::steady_clock::now() + std::chrono::minutes(1);
+        if (template_manager) {
+            // All waiters are woken up by the same update and share the
+            // template that was prepared for it.
+            if (!tip_changed) template_manager->WaitForUpdate(update_id);
+        } else {
+            std::chrono::steady_clock::time_point checktxtime = std::chrono::steady_clock::now() + std::chrono::minutes(1);
 
             WAIT_LOCK(g_best_block_mutex, lock);
             while (g_best_block == hashWatchedChain && IsRPCRunning())
@@ -712,7 +720,7 @@ static RPCHelpMan getblocktemplate()
                 {
                     // Timeout: Check transactions for update
                     // without holding the mempool lock to avoid deadlocks
-                    if (mempool.GetTransactionsUpdated() != nTransactionsUpdatedLastLP)
+                    if (mempool.GetTransactionsUpdated() != update_id)
                         break;
                     checktxtime += std::chrono::seconds(10);
                 }
@@ -738,36 +746,25 @@ static RPCHelpMan getblocktemplate()
     }
 
     // Update block
-    static CBlockIndex* pindexPrev;
-    static int64_t time_start;
-    static std::unique_ptr<CBlockTemplate> pblocktemplate;
-    if (pindexPrev != active_chain.Tip() ||
-        (mempool.GetTransactionsUpdated() != nTransactionsUpdatedLast && GetTime() - time_start > 5))
-    {
-        // Clear pindexPrev so future calls make a new block, despite any failures from here on
-        pindexPrev = nullptr;
-
-        // Store the pindexBest used before CreateNewBlock, to avoid races
-        nTransactionsUpdatedLast = mempool.GetTransactionsUpdated();
-        CBlockIndex* pindexPrevNew = active_chain.Tip();
-        time_start = GetTime();
+    // Store the nTransactionsUpdated and update id seen before fetching the template, to avoid races
+    nTransactionsUpdatedLast = mempool.GetTransactionsUpdated();
+    const uint64_t update_id{template_manager ? template_manager->GetUpdateId() : nTransactionsUpdatedLast};
+    const CBlockIndex* const pindexPrev = active_chain.Tip();
+    CHECK_NONFATAL(pindexPrev);
 
-        // Create new block
-        CScript scriptDummy = CScript() << OP_TRUE;
+    CScript scriptDummy = CScript() << OP_TRUE;
+    std::unique_ptr<CBlockTemplate> pblocktemplate;
+    if (template_manager) {
+        // The template is kept up to date with the mempool, so this doesn't
+        // run the transaction selection again unless it has to.
+        pblocktemplate = template_manager->GetTemplate(scriptDummy);
+    } else {
         pblocktemplate = BlockAssembler{active_chainstate, &mempool}.CreateNewBlock(scriptDummy);
-        if (!pblocktemplate)
-            throw JSONRPCError(RPC_OUT_OF_MEMORY, "Out of memory");
-
-        // Need to update only after we know CreateNewBlock succeeded
-        pindexPrev = pindexPrevNew;
     }
-    CHECK_NONFATAL(pindexPrev);
+    if (!pblocktemplate)
+        throw JSONRPCError(RPC_OUT_OF_MEMORY, "Out of memory");
     CBlock* pblock = &pblocktemplate->block; // pointer for convenience
 
-    // Update nTime
-    UpdateTime(pblock, consensusParams, pindexPrev);
-    pblock->nNonce = 0;
-
     // NOTE: If at some point we support pre-segwit miners post-segwit-activation, this needs to take segwit support into consideration
     const bool fPreSegWit = !DeploymentActiveAfter(pindexPrev, chainman, Consensus::DEPLOYMENT_SEGWIT);
 
@@ -881,7 +878,7 @@ static RPCHelpMan getblocktemplate()
     result.pushKV("transactions", transactions);
     result.pushKV("coinbaseaux", aux);
     result.pushKV("coinbasevalue", (int64_t)pblock->vtx[0]->vout[0].nValue);
-    result.pushKV("longpollid", active_chain.Tip()->GetBlockHash().GetHex() + ToString(nTransactionsUpdatedLast));
+    result.pushKV("longpollid", active_chain.Tip()->GetBlockHash().GetHex() + ToString(update_id));
     result.pushKV("target", hashTarget.GetHex());
     result.pushKV("mintime", (int64_t)pindexPrev->GetMedianTimePast()+1);
     result.pushKV("mutable", aMutable);
@@ -987,6 +984,14 @@ static RPCHelpMan submitblock()
         }
     }
 
+    // Check the block with the proof of work computed in parallel, before it
+    // is shared and cs_main is taken. On failure, ProcessNewBlock() checks it
+    // again (with the cached proof of work hash) to report the result.
+    {
+        BlockValidationState state;
+        CheckBlockConcurrentPoW(block, state, chainman.GetConsensus());
+    }
+
     bool new_block;
     auto sc = std::make_shared<submitblock_StateCatcher>(block.GetHash());
     RegisterSharedValidationInterface(sc);
@@ -90,6 +90,24 @@ static RPCHelpMan ping()
     };
 }
 
+static UniValue BlockRelayLatencyToUniv(const BlockRelayLatency& latency)
+{
+    UniValue obj(UniValue::VOBJ);
+    for (size_t i = 0; i < latency.m_counts.size(); ++i) {
+        obj.pushKV(i < BlockRelayLatency::BUCKETS_MS.size() ? ToString(BlockRelayLatency::BUCKETS_MS[i]) : "inf", latency.m_counts[i]);
+    }
+    return obj;
+}
+
+static RPCResult BlockRelayLatencyDoc(const std::string& description, bool optional)
+{
+    return {RPCResult::Type::OBJ_DYN, "block_relay_latency", optional, description,
+    {
+        {RPCResult::Type::NUM, "ms", "The number of blocks announced within this many milliseconds and above the previous bound,\n"
+                                     "or above the largest bound for the key 'inf'"},
+    }};
+}
+
 static RPCHelpMan getpeerinfo()
 {
     return RPCHelpMan{
@@ -139,6 +157,8 @@ static RPCHelpMan getpeerinfo()
                     {
                         {RPCResult::Type::NUM, "n", "The heights of blocks we're currently asking from this peer"},
                     }},
+                    BlockRelayLatencyDoc("Histogram of the time from receiving the header of a new block from this peer first\n"
+                                         "to announcing the block to our peers", /*optional=*/false),
                     {RPCResult::Type::BOOL, "addr_relay_enabled", "Whether we participate in address relay with this peer"},
                     {RPCResult::Type::NUM, "addr_processed", "The total number of addresses processed, excluding those dropped due to rate limiting"},
                     {RPCResult::Type::NUM, "addr_rate_limited", "The total number of addresses dropped due to rate limiting"},
@@ -243,6 +263,7 @@ static RPCHelpMan getpeerinfo()
             heights.push_back(height);
         }
         obj.pushKV("inflight", heights);
+        obj.pushKV("block_relay_latency", BlockRelayLatencyToUniv(statestats.m_block_relay_latency));
         obj.pushKV("addr_relay_enabled", statestats.m_addr_relay_enabled);
         obj.pushKV("addr_processed", statestats.m_addr_processed);
         obj.pushKV("addr_rate_limited", statestats.m_addr_rate_limited);
@@ -622,6 +643,8 @@ static RPCHelpMan getnetworkinfo()
                                 {RPCResult::Type::NUM, "score", "relative score"},
                             }},
                         }},
+                        BlockRelayLatencyDoc("histogram of the time from receiving the header of a new block from a peer\n"
+                                             "to announcing the block to our peers", /*optional=*/true),
                         {RPCResult::Type::STR, "warnings", "any network and blockchain warnings"},
                     }
                 },
@@ -671,6 +694,9 @@ static RPCHelpMan getnetworkinfo()
         }
     }
     obj.pushKV("localaddresses", localAddresses);
+    if (node.peerman) {
+        obj.pushKV("block_relay_latency", BlockRelayLatencyToUniv(node.peerman->GetBlockRelayLatency()));
+    }
     obj.pushKV("warnings",       GetWarnings(false).original);
     return obj;
 },
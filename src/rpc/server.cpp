@@ -5,21 +5,26 @@
 
 #include <rpc/server.h>
 
+#include <httpserver.h>
 #include <rpc/util.h>
 #include <shutdown.h>
 #include <sync.h>
 #include <util/strencodings.h>
 #include <util/string.h>
 #include <util/system.h>
+#include <util/threadpool.h>
 #include <util/time.h>
 
 #include <boost/signals2/signal.hpp>
 
 #include <cassert>
 #include <chrono>
+#include <condition_variable>
 #include <memory>
 #include <mutex>
+#include <set>
 #include <unordered_map>
+#include <vector>
 
 static GlobalMutex g_rpc_warmup_mutex;
 static std::atomic<bool> g_rpc_running{false};
@@ -46,6 +51,42 @@ struct RPCServerInfo
 
 static RPCServerInfo g_rpc_server_info;
 
+/**
+ * Methods that only read node state. Consecutive batch elements calling them
+ * may be executed in parallel; any other element is a barrier that runs after
+ * all elements before it and before all elements after it.
+ */
+static const std::set<std::string> PARALLEL_BATCH_METHODS{
+    "decoderawtransaction",
+    "decodescript",
+    "getaddressbalance",
+    "getaddressdeltas",
+    "getaddressesbalance",
+    "getaddressmempool",
+    "getaddresstxids",
+    "getaddressutxos",
+    "getbestblockhash",
+    "getblock",
+    "getblockcount",
+    "getblockhash",
+    "getblockhashes",
+    "getblockheader",
+    "getblockstats",
+    "getmempoolancestors",
+    "getmempooldescendants",
+    "getmempoolentry",
+    "getrawtransaction",
+    "getspentinfo",
+    "gettxout",
+    "gettxoutproof",
+    "gettxspendingprevout",
+    "validateaddress",
+    "verifytxoutproof",
+};
+
+/** Threads that execute read-only elements of JSON-RPC batches, shared by all batches */
+static ThreadPool g_rpc_batch_pool;
+
 struct RPCCommandExecution
 {
     std::list<RPCCommandExecutionInfo>::iterator it;
@@ -222,6 +263,20 @@ static RPCHelpMan getrpcinfo()
                             }},
                         }},
                         {RPCResult::Type::STR, "logpath", "The complete file path to the debug log"},
+                        {RPCResult::Type::ARR, "work_queues", "The HTTP work queues: the default one and those added with -rpclane",
+                        {
+                            {RPCResult::Type::OBJ, "", "",
+                            {
+                                {RPCResult::Type::STR, "name", "The name of the work queue"},
+                                {RPCResult::Type::NUM, "threads", "The number of worker threads"},
+                                {RPCResult::Type::NUM, "depth", "The number of queued requests"},
+                                {RPCResult::Type::NUM, "max_depth", "The maximum number of queued requests"},
+                                {RPCResult::Type::NUM, "processed", "The number of requests picked up by a worker"},
+                                {RPCResult::Type::NUM, "rejected", "The number of requests rejected because the queue was full"},
+                                {RPCResult::Type::NUM, "average_wait", "The average time requests were queued, in microseconds"},
+                                {RPCResult::Type::NUM, "max_wait", "The longest time a request was queued, in microseconds"},
+                            }},
+                        }},
                     }
                 },
                 RPCExamples{
@@ -245,6 +300,21 @@ static RPCHelpMan getrpcinfo()
     UniValue log_path(UniValue::VSTR, path);
     result.pushKV("logpath", log_path);
 
+    UniValue work_queues(UniValue::VARR);
+    for (const HTTPWorkQueueStats& stats : GetHTTPWorkQueueStats()) {
+        UniValue entry(UniValue::VOBJ);
+        entry.pushKV("name", stats.name);
+        entry.pushKV("threads", stats.threads);
+        entry.pushKV("depth", (uint64_t)stats.depth);
+        entry.pushKV("max_depth", (uint64_t)stats.max_depth);
+        entry.pushKV("processed", stats.processed);
+        entry.pushKV("rejected", stats.rejected);
+        entry.pushKV("average_wait", stats.processed ? count_microseconds(stats.total_wait) / (int64_t)stats.processed : 0);
+        entry.pushKV("max_wait", count_microseconds(stats.max_wait));
+        work_queues.push_back(entry);
+    }
+    result.pushKV("work_queues", work_queues);
+
     return result;
 }
     };
@@ -272,6 +342,13 @@ void CRPCTable::appendCommand(const std::string& name, const CRPCCommand* pcmd)
     mapCommands[name].push_back(pcmd);
 }
 
+void CRPCTable::appendStreamHandler(const std::string& name, RPCStreamHandler handler)
+{
+    CHECK_NONFATAL(!IsRPCRunning()); // Only add handlers before rpc is running
+
+    m_stream_handlers[name] = std::move(handler);
+}
+
 bool CRPCTable::removeCommand(const std::string& name, const CRPCCommand* pcmd)
 {
     auto it = mapCommands.find(name);
@@ -289,6 +366,7 @@ void StartRPC()
 {
     LogPrint(BCLog::RPC, "Starting RPC\n");
     g_rpc_running = true;
+    g_rpc_batch_pool.Start("rpcbatch", std::max<int>(gArgs.GetIntArg("-rpcbatchthreads", DEFAULT_RPC_BATCH_THREADS), 0));
     g_rpcSignals.Started();
 }
 
@@ -311,6 +389,7 @@ void StopRPC()
     std::call_once(g_rpc_stop_flag, []() {
         LogPrint(BCLog::RPC, "Stopping RPC\n");
         WITH_LOCK(g_deadline_timers_mutex, deadlineTimers.clear());
+        g_rpc_batch_pool.Stop();
         DeleteAuthCookie();
         g_rpcSignals.Stopped();
     });
@@ -377,12 +456,73 @@ static UniValue JSONRPCExecOne(JSONRPCRequest jreq, const UniValue& req)
     return rpc_result;
 }
 
+static bool IsParallelBatchElement(const UniValue& req)
+{
+    if (!req.isObject()) return false;
+    const UniValue& method = find_value(req.get_obj(), "method");
+    return method.isStr() && PARALLEL_BATCH_METHODS.count(method.get_str());
+}
+
+/** Elements [begin, end) of a batch, executed by the calling thread and helpers from the batch thread pool */
+struct BatchRun
+{
+    const JSONRPCRequest& jreq;
+    const UniValue& reqs;
+    std::vector<UniValue>& replies;
+    const size_t end;
+    std::atomic<size_t> next;
+    Mutex mutex;
+    std::condition_variable cv;
+    size_t remaining GUARDED_BY(mutex);
+
+    BatchRun(const JSONRPCRequest& jreq_in, const UniValue& reqs_in, std::vector<UniValue>& replies_in, size_t begin, size_t end_in)
+        : jreq{jreq_in}, reqs{reqs_in}, replies{replies_in}, end{end_in}, next{begin}, remaining{end_in - begin} {}
+
+    /** Execute elements until none are left. Helpers that start late find nothing to do and don't touch the batch. */
+    void Work()
+    {
+        for (size_t idx = next++; idx < end; idx = next++) {
+            replies[idx] = JSONRPCExecOne(jreq, reqs[idx]);
+            LOCK(mutex);
+            if (--remaining == 0) cv.notify_all();
+        }
+    }
+};
+
 std::string JSONRPCExecBatch(const JSONRPCRequest& jreq, const UniValue& vReq)
 {
-    UniValue ret(UniValue::VARR);
-    for (unsigned int reqIdx = 0; reqIdx < vReq.size(); reqIdx++)
-        ret.push_back(JSONRPCExecOne(jreq, vReq[reqIdx]));
+    const int max_parallel{std::min<int>(gArgs.GetIntArg("-rpcbatchparallel", DEFAULT_RPC_BATCH_PARALLEL), g_rpc_batch_pool.NumThreads() + 1)};
+    std::vector<UniValue> replies(vReq.size());
+    size_t reqIdx{0};
+    while (reqIdx < vReq.size()) {
+        size_t run_end{reqIdx};
+        if (max_parallel > 1) {
+            while (run_end < vReq.size() && IsParallelBatchElement(vReq[run_end])) ++run_end;
+        }
+        if (run_end - reqIdx < 2) {
+            replies[reqIdx] = JSONRPCExecOne(jreq, vReq[reqIdx]);
+            ++reqIdx;
+            continue;
+        }
+
+        // Shared with the helpers, which may only get to run after this batch is done
+        auto run{std::make_shared<BatchRun>(jreq, vReq, replies, reqIdx, run_end)};
+        const size_t helpers{std::min<size_t>(max_parallel, run_end - reqIdx) - 1};
+        for (size_t i = 0; i < helpers; ++i) {
+            g_rpc_batch_pool.Submit([run] { run->Work(); });
+        }
+        run->Work();
+        {
+            WAIT_LOCK(run->mutex, lock);
+            run->cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(run->mutex) { return run->remaining == 0; });
+        }
+        reqIdx = run_end;
+    }
 
+    UniValue ret(UniValue::VARR);
+    for (UniValue& reply : replies) {
+        ret.push_back(std::move(reply));
+    }
     return ret.write() + "\n";
 }
 
@@ -494,6 +634,34 @@ UniValue CRPCTable::execute(const JSONRPCRequest &request) const
     throw JSONRPCError(RPC_METHOD_NOT_FOUND, "Method not found");
 }
 
+RPCResultWriter CRPCTable::prepareStream(const JSONRPCRequest& request) const
+{
+    if (request.mode != JSONRPCRequest::EXECUTE) return nullptr;
+    auto handler = m_stream_handlers.find(request.strMethod);
+    auto it = mapCommands.find(request.strMethod);
+    if (handler == m_stream_handlers.end() || it == mapCommands.end() || it->second.empty()) return nullptr;
+
+    {
+        LOCK(g_rpc_warmup_mutex);
+        if (fRPCInWarmup)
+            throw JSONRPCError(RPC_IN_WARMUP, rpcWarmupStatus);
+    }
+
+    try {
+        // The call is active until its result is written
+        auto execution{std::make_shared<RPCCommandExecution>(request.strMethod)};
+        RPCResultWriter writer{request.params.isObject() ?
+                                   handler->second(transformNamedArguments(request, it->second.front()->argNames)) :
+                                   handler->second(request)};
+        if (!writer) return nullptr;
+        return [execution, writer = std::move(writer)](JSONStreamWriter& stream) { writer(stream); };
+    } catch (const UniValue::type_error& e) {
+        throw JSONRPCError(RPC_TYPE_ERROR, e.what());
+    } catch (const std::exception& e) {
+        throw JSONRPCError(RPC_MISC_ERROR, e.what());
+    }
+}
+
 static bool ExecuteCommand(const CRPCCommand& command, const JSONRPCRequest& request, UniValue& result, bool last_handler)
 {
     try {
@@ -17,8 +17,13 @@
 #include <univalue.h>
 
 static const unsigned int DEFAULT_RPC_SERIALIZE_VERSION = 1;
+/** Default number of threads that help execute read-only calls of JSON-RPC batches */
+static const int DEFAULT_RPC_BATCH_THREADS = 4;
+/** Default maximum number of calls of a single JSON-RPC batch executed at the same time */
+static const int DEFAULT_RPC_BATCH_PARALLEL = 4;
 
 class CRPCCommand;
+class JSONStreamWriter;
 
 namespace RPCServer
 {
@@ -119,6 +124,13 @@ public:
     intptr_t unique_id;
 };
 
+//! Writes the result of a call whose request was checked by an RPCStreamHandler
+using RPCResultWriter = std::function<void(JSONStreamWriter& writer)>;
+//! Checks a request like the method does, throwing the same errors, and
+//! loads what the result needs. It returns a writer that must not fail, or
+//! nullptr to leave the call to the method, e.g. for results that are small.
+using RPCStreamHandler = std::function<RPCResultWriter(const JSONRPCRequest& request)>;
+
 /**
  * RPC command dispatcher.
  */
@@ -126,6 +138,7 @@ class CRPCTable
 {
 private:
     std::map<std::string, std::vector<const CRPCCommand*>> mapCommands;
+    std::map<std::string, RPCStreamHandler> m_stream_handlers;
 public:
     CRPCTable();
     std::string help(const std::string& name, const JSONRPCRequest& helpreq) const;
@@ -138,6 +151,15 @@ public:
      */
     UniValue execute(const JSONRPCRequest &request) const;
 
+    /**
+     * Prepare to write the result of a call to a method with a stream
+     * handler directly to a JSONStreamWriter.
+     * @returns The writer of the result, or nullptr if the request has to
+     *          be executed with execute().
+     * @throws an exception (UniValue) like execute() when the call fails.
+     */
+    RPCResultWriter prepareStream(const JSONRPCRequest& request) const;
+
     /**
     * Returns a list of registered commands
     * @returns List of registered commands.
@@ -162,6 +184,14 @@ public:
      * register different names, types, and numbers of parameters.
      */
     void appendCommand(const std::string& name, const CRPCCommand* pcmd);
+
+    /**
+     * Appends a handler streaming the results of a method appended with
+     * appendCommand().
+     *
+     * Precondition: RPC server is not running
+     */
+    void appendStreamHandler(const std::string& name, RPCStreamHandler handler);
     bool removeCommand(const std::string& name, const CRPCCommand* pcmd);
 };
 
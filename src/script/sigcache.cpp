@@ -76,6 +76,15 @@ public:
         std::unique_lock<std::shared_mutex> lock(cs_sigcache);
         setValid.insert(entry);
     }
+
+    template <typename It, typename Pred>
+    void SetMany(It begin, It end, Pred pred)
+    {
+        std::unique_lock<std::shared_mutex> lock(cs_sigcache);
+        for (It it = begin; it != end; ++it) {
+            if (pred(*it)) setValid.insert(it->cache_entry);
+        }
+    }
     std::optional<std::pair<uint32_t, size_t>> setup_bytes(size_t n)
     {
         return setValid.setup_bytes(n);
@@ -122,7 +131,39 @@ bool CachingTransactionSignatureChecker::VerifySchnorrSignature(Span<const unsig
     uint256 entry;
     signatureCache.ComputeEntrySchnorr(entry, sighash, sig, pubkey);
     if (signatureCache.Get(entry, !store)) return true;
+    if (m_batch) {
+        m_batch->Add(sig, pubkey, sighash, entry, store);
+        return true;
+    }
     if (!TransactionSignatureChecker::VerifySchnorrSignature(sig, pubkey, sighash)) return false;
     if (store) signatureCache.Set(entry);
     return true;
 }
+
+void BatchSchnorrVerifier::Add(Span<const unsigned char> sig, const XOnlyPubKey& pubkey, const uint256& sighash, const uint256& cache_entry, bool store)
+{
+    Entry& e{m_entries.emplace_back()};
+    assert(sig.size() == e.sig.size());
+    std::copy(sig.begin(), sig.end(), e.sig.begin());
+    e.pubkey = pubkey;
+    e.sighash = sighash;
+    e.cache_entry = cache_entry;
+    e.store = store;
+}
+
+bool BatchSchnorrVerifier::Verify()
+{
+    // The bundled libsecp256k1 does not provide batch verification yet, so the
+    // signatures are checked one after the other. Only the combined result is
+    // reported, which is all a real batch verifier could tell us.
+    for (const Entry& e : m_entries) {
+        if (!e.pubkey.VerifySchnorr(e.sighash, e.sig)) {
+            Reset();
+            return false;
+        }
+    }
+    // Take the signature cache's write lock once for the whole batch.
+    signatureCache.SetMany(m_entries.begin(), m_entries.end(), [](const Entry& e) { return e.store; });
+    Reset();
+    return true;
+}
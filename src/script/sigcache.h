@@ -6,10 +6,13 @@
 #ifndef BITCOIN_SCRIPT_SIGCACHE_H
 #define BITCOIN_SCRIPT_SIGCACHE_H
 
+#include <pubkey.h>
 #include <script/interpreter.h>
 #include <span.h>
+#include <uint256.h>
 #include <util/hasher.h>
 
+#include <array>
 #include <optional>
 #include <vector>
 
@@ -20,13 +23,54 @@ static constexpr size_t DEFAULT_MAX_SIG_CACHE_BYTES{32 << 20};
 
 class CPubKey;
 
+/**
+ * Schnorr signature verifications that were deferred while running scripts,
+ * so that they can be checked together afterwards.
+ *
+ * Deferring is sound because an invalid (non-empty) Schnorr signature always
+ * fails the script that contains it: if every deferred signature turns out
+ * valid, the scripts succeed exactly as they would have with inline checks.
+ * ECDSA verification stays inline, as it cannot be batched.
+ */
+class BatchSchnorrVerifier
+{
+private:
+    struct Entry {
+        std::array<unsigned char, 64> sig;
+        XOnlyPubKey pubkey;
+        uint256 sighash;
+        //! Signature cache entry to add once the signature is known to be valid.
+        uint256 cache_entry;
+        bool store;
+    };
+    std::vector<Entry> m_entries;
+
+public:
+    void Add(Span<const unsigned char> sig, const XOnlyPubKey& pubkey, const uint256& sighash, const uint256& cache_entry, bool store);
+
+    /**
+     * Verify all deferred signatures and forget them. Valid signatures are
+     * added to the signature cache when their checker asked for it.
+     *
+     * @returns true if every signature is valid.
+     */
+    bool Verify();
+
+    //! Forget all deferred signatures without verifying them.
+    void Reset() { m_entries.clear(); }
+
+    size_t size() const { return m_entries.size(); }
+};
+
 class CachingTransactionSignatureChecker : public TransactionSignatureChecker
 {
 private:
     bool store;
+    //! If set, Schnorr signatures missing from the cache are deferred to this batch.
+    BatchSchnorrVerifier* m_batch;
 
 public:
-    CachingTransactionSignatureChecker(const CTransaction* txToIn, unsigned int nInIn, const CAmount& amountIn, bool storeIn, PrecomputedTransactionData& txdataIn) : TransactionSignatureChecker(txToIn, nInIn, amountIn, txdataIn, MissingDataBehavior::ASSERT_FAIL), store(storeIn) {}
+    CachingTransactionSignatureChecker(const CTransaction* txToIn, unsigned int nInIn, const CAmount& amountIn, bool storeIn, PrecomputedTransactionData& txdataIn, BatchSchnorrVerifier* batch = nullptr) : TransactionSignatureChecker(txToIn, nInIn, amountIn, txdataIn, MissingDataBehavior::ASSERT_FAIL), store(storeIn), m_batch(batch) {}
 
     bool VerifyECDSASignature(const std::vector<unsigned char>& vchSig, const CPubKey& vchPubKey, const uint256& sighash) const override;
     bool VerifySchnorrSignature(Span<const unsigned char> sig, const XOnlyPubKey& pubkey, const uint256& sighash) const override;
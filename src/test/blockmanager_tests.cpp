@@ -5,6 +5,7 @@
 #include <chainparams.h>
 #include <node/blockstorage.h>
 #include <node/context.h>
+#include <util/strencodings.h>
 #include <validation.h>
 
 #include <boost/test/unit_test.hpp>
@@ -14,6 +15,7 @@ using node::BlockManager;
 using node::BLOCK_SERIALIZATION_HEADER_SIZE;
 using node::MAX_BLOCKFILE_SIZE;
 using node::OpenBlockFile;
+using node::ReadRawBlockFromDisk;
 
 // use BasicTestingSetup here for the data directory configuration, setup, and cleanup
 BOOST_FIXTURE_TEST_SUITE(blockmanager_tests, BasicTestingSetup)
@@ -41,6 +43,38 @@ BOOST_AUTO_TEST_CASE(blockmanager_find_block_pos)
     BOOST_CHECK_EQUAL(actual.nPos, BLOCK_SERIALIZATION_HEADER_SIZE + ::GetSerializeSize(params->GenesisBlock(), CLIENT_VERSION) + BLOCK_SERIALIZATION_HEADER_SIZE);
 }
 
+BOOST_AUTO_TEST_CASE(blockmanager_read_raw_block)
+{
+    const auto params {CreateChainParams(ArgsManager{}, CBaseChainParams::MAIN)};
+    const CBlock& genesis{params->GenesisBlock()};
+    BlockManager blockman{{}};
+    CChain chain {};
+    const FlatFilePos pos{blockman.SaveBlockToDisk(genesis, 0, chain, *params, nullptr)};
+
+    const uint256 hash{genesis.GetHash()};
+    CBlockIndex index{genesis};
+    index.phashBlock = &hash;
+    {
+        LOCK(cs_main);
+        index.nFile = pos.nFile;
+        index.nDataPos = pos.nPos;
+        index.nStatus |= BLOCK_HAVE_DATA;
+    }
+
+    // The raw read returns exactly the serialized block
+    CDataStream expected{SER_DISK, CLIENT_VERSION};
+    expected << genesis;
+    std::vector<uint8_t> raw;
+    BOOST_CHECK(ReadRawBlockFromDisk(raw, &index, params->MessageStart()));
+    BOOST_CHECK_EQUAL(HexStr(raw), HexStr(expected));
+
+    // A block that doesn't match the index is only rejected when checking the hash
+    const uint256 other_hash{uint256::ONE};
+    index.phashBlock = &other_hash;
+    BOOST_CHECK(!ReadRawBlockFromDisk(raw, &index, params->MessageStart()));
+    BOOST_CHECK(ReadRawBlockFromDisk(raw, &index, params->MessageStart(), /*check_hash=*/false));
+}
+
 BOOST_FIXTURE_TEST_CASE(blockmanager_scan_unlink_already_pruned_files, TestChain100Setup)
 {
     // Cap last block file size, and mine new block in a new block file.
@@ -134,6 +134,39 @@ struct FrozenCleanupCheck {
     }
 };
 
+struct BatchedCheck {
+    static std::atomic<size_t> n_deferred;
+    static std::atomic<size_t> n_individual;
+    struct Batch {
+        size_t pending{0};
+        bool invalid{false};
+        bool Verify()
+        {
+            n_deferred.fetch_add(pending, std::memory_order_relaxed);
+            const bool ok{!invalid};
+            Reset();
+            return ok;
+        }
+        void Reset()
+        {
+            pending = 0;
+            invalid = false;
+        }
+    };
+    bool fails{false};
+    bool operator()() const
+    {
+        n_individual.fetch_add(1, std::memory_order_relaxed);
+        return !fails;
+    }
+    bool operator()(Batch& batch) const
+    {
+        ++batch.pending;
+        batch.invalid |= fails;
+        return true;
+    }
+};
+
 // Static Allocations
 std::mutex FrozenCleanupCheck::m{};
 std::atomic<uint64_t> FrozenCleanupCheck::nFrozen{0};
@@ -142,6 +175,8 @@ Mutex UniqueCheck::m;
 std::unordered_multiset<size_t> UniqueCheck::results;
 std::atomic<size_t> FakeCheckCheckCompletion::n_calls{0};
 std::atomic<size_t> MemoryCheck::fake_allocated_memory{0};
+std::atomic<size_t> BatchedCheck::n_deferred{0};
+std::atomic<size_t> BatchedCheck::n_individual{0};
 
 // Queue Typedefs
 typedef CCheckQueue<FakeCheckCheckCompletion> Correct_Queue;
@@ -150,6 +185,7 @@ typedef CCheckQueue<FailingCheck> Failing_Queue;
 typedef CCheckQueue<UniqueCheck> Unique_Queue;
 typedef CCheckQueue<MemoryCheck> Memory_Queue;
 typedef CCheckQueue<FrozenCleanupCheck> FrozenCleanup_Queue;
+typedef CCheckQueue<BatchedCheck> Batched_Queue;
 
 
 /** This test case checks that the CCheckQueue works properly
@@ -364,6 +400,37 @@ BOOST_AUTO_TEST_CASE(test_CheckQueue_FrozenCleanup)
 }
 
 
+/** Test that checks declaring a Batch are verified through it, and that a
+ * failing batch falls back to running its checks individually.
+ */
+BOOST_AUTO_TEST_CASE(test_CheckQueue_Batch)
+{
+    auto queue = std::make_unique<Batched_Queue>(QUEUE_BATCH_SIZE);
+    queue->StartWorkerThreads(SCRIPT_CHECK_THREADS);
+
+    for (const bool with_failure : {false, true}) {
+        BatchedCheck::n_deferred = 0;
+        BatchedCheck::n_individual = 0;
+        const size_t COUNT = 1000;
+        CCheckQueueControl<BatchedCheck> control(queue.get());
+        for (size_t total = 0; total < COUNT;) {
+            std::vector<BatchedCheck> vChecks(std::min<size_t>(COUNT - total, 1 + InsecureRandRange(10)));
+            total += vChecks.size();
+            if (with_failure && total == COUNT) vChecks.back().fails = true;
+            control.Add(std::move(vChecks));
+        }
+        BOOST_REQUIRE_EQUAL(control.Wait(), !with_failure);
+        if (with_failure) {
+            // Checks after the failure may be skipped, but the failing batch was rerun.
+            BOOST_CHECK(BatchedCheck::n_individual > 0);
+        } else {
+            BOOST_CHECK_EQUAL(BatchedCheck::n_deferred, COUNT);
+            BOOST_CHECK_EQUAL(BatchedCheck::n_individual, 0U);
+        }
+    }
+    queue->StopWorkerThreads();
+}
+
 /** Test that CCheckQueueControl is threadsafe */
 BOOST_AUTO_TEST_CASE(test_CheckQueueControl_Locks)
 {
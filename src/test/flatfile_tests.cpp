@@ -126,4 +126,33 @@ BOOST_AUTO_TEST_CASE(flatfile_flush)
     BOOST_CHECK_EQUAL(fs::file_size(seq.FileName(FlatFilePos(0, 1))), 1U);
 }
 
+BOOST_AUTO_TEST_CASE(flatfile_map)
+{
+    const auto data_dir = m_args.GetDataDirBase();
+    FlatFileSeq seq(data_dir, "a", 16 * 1024);
+
+    // Files that don't exist or are empty can't be mapped.
+    BOOST_CHECK(!seq.Map(FlatFilePos{}));
+    BOOST_CHECK(!seq.Map(FlatFilePos(0, 0)));
+    AutoFile{seq.Open(FlatFilePos(0, 0))}.fclose();
+    BOOST_CHECK(!seq.Map(FlatFilePos(0, 0)));
+
+    std::string line("Commerce on the Internet has come to rely almost exclusively on financial "
+                     "institutions serving as trusted third parties to process electronic payments.");
+    {
+        AutoFile file{seq.Open(FlatFilePos(0, 0))};
+        file << LIMITED_STRING(line, 256);
+    }
+
+#ifndef WIN32
+    auto mapping{seq.Map(FlatFilePos(0, 0))};
+    BOOST_REQUIRE(mapping);
+    BOOST_CHECK_EQUAL(mapping->Data().size(), GetSerializeSize(line, CLIENT_VERSION));
+
+    std::string read_line;
+    SpanReader{SER_DISK, CLIENT_VERSION, mapping->Data()} >> LIMITED_STRING(read_line, 256);
+    BOOST_CHECK_EQUAL(read_line, line);
+#endif
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -53,6 +53,11 @@ FUZZ_TARGET_INIT(block, initialize_block)
     } else if (valid_incl_merkle || valid_incl_pow) {
         assert(valid_incl_none);
     }
+    CBlock block_concurrent_pow{block};
+    block_concurrent_pow.fChecked = false;
+    BlockValidationState validation_state_concurrent_pow;
+    const bool valid_concurrent_pow = CheckBlockConcurrentPoW(block_concurrent_pow, validation_state_concurrent_pow, consensus_params);
+    assert(valid_concurrent_pow == valid_incl_pow_and_merkle);
     (void)block.GetHash();
     (void)block.ToString();
     (void)BlockMerkleRoot(block);
@@ -129,10 +129,14 @@ FUZZ_TARGET_MSG(merkleblock);
 FUZZ_TARGET_MSG(notfound);
 FUZZ_TARGET_MSG(ping);
 FUZZ_TARGET_MSG(pong);
+FUZZ_TARGET_MSG(reconcildiff);
+FUZZ_TARGET_MSG(reqrecon);
+FUZZ_TARGET_MSG(reqsketchext);
 FUZZ_TARGET_MSG(sendaddrv2);
 FUZZ_TARGET_MSG(sendcmpct);
 FUZZ_TARGET_MSG(sendheaders);
 FUZZ_TARGET_MSG(sendtxrcncl);
+FUZZ_TARGET_MSG(sketch);
 FUZZ_TARGET_MSG(tx);
 FUZZ_TARGET_MSG(verack);
 FUZZ_TARGET_MSG(version);
@@ -108,6 +108,16 @@ ssize_t FuzzedSock::Send(const void* data, size_t len, int flags) const
     return r;
 }
 
+ssize_t FuzzedSock::SendMany(Span<const Span<const unsigned char>> data, int flags) const
+{
+    // Only the length matters to the fuzzed result
+    size_t len{0};
+    for (const auto& buf : data) {
+        len += buf.size();
+    }
+    return Send(data.empty() ? nullptr : data[0].data(), len, flags);
+}
+
 ssize_t FuzzedSock::Recv(void* buf, size_t len, int flags) const
 {
     // Have a permanent error at recv_errnos[0] because when the fuzzed data is exhausted
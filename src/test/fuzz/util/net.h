@@ -53,6 +53,8 @@ public:
 
     ssize_t Send(const void* data, size_t len, int flags) const override;
 
+    ssize_t SendMany(Span<const Span<const unsigned char>> data, int flags) const override;
+
     ssize_t Recv(void* buf, size_t len, int flags) const override;
 
     int Connect(const sockaddr*, socklen_t) const override;
@@ -5,6 +5,7 @@
 #include <consensus/merkle.h>
 #include <test/util/random.h>
 #include <test/util/setup_common.h>
+#include <validation.h>
 
 #include <boost/test/unit_test.hpp>
 
@@ -349,4 +350,34 @@ BOOST_AUTO_TEST_CASE(merkle_test_BlockWitness)
 
     BOOST_CHECK_EQUAL(merkleRootofHashes, blockWitness);
 }
+
+BOOST_AUTO_TEST_CASE(merkle_test_parallel)
+{
+    // Sizes around the parallel threshold and the subtree boundaries, including
+    // a single leaf past a full subtree and an odd number of subtrees.
+    for (const size_t ntx : {4095, 4096, 4097, 5000, 5120, 8191, 8192, 9001}) {
+        CBlock block;
+        block.vtx.resize(ntx);
+        for (size_t j = 0; j < ntx; j++) {
+            CMutableTransaction mtx;
+            mtx.nLockTime = j;
+            mtx.vin.resize(1);
+            mtx.vin[0].scriptWitness.stack.push_back({static_cast<unsigned char>(j)});
+            block.vtx[j] = MakeTransactionRef(std::move(mtx));
+        }
+        bool mutated = true, parallel_mutated = true;
+        BOOST_CHECK_EQUAL(ParallelBlockMerkleRoot(block, &parallel_mutated), BlockMerkleRoot(block, &mutated));
+        BOOST_CHECK_EQUAL(parallel_mutated, mutated);
+        BOOST_CHECK_EQUAL(ParallelBlockWitnessMerkleRoot(block, &parallel_mutated), BlockWitnessMerkleRoot(block, &mutated));
+        BOOST_CHECK_EQUAL(parallel_mutated, mutated);
+
+        // Duplicating the last transaction leaves the root unchanged for an odd
+        // count, but must be reported as a mutation.
+        if (ntx & 1) {
+            block.vtx.push_back(block.vtx.back());
+            BOOST_CHECK_EQUAL(ParallelBlockMerkleRoot(block, &parallel_mutated), BlockMerkleRoot(block, &mutated));
+            BOOST_CHECK(parallel_mutated && mutated);
+        }
+    }
+}
 BOOST_AUTO_TEST_SUITE_END()
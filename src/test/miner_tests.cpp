@@ -27,6 +27,7 @@
 #include <boost/test/unit_test.hpp>
 
 using node::BlockAssembler;
+using node::BlockTemplateManager;
 using node::CBlockTemplate;
 
 namespace miner_tests {
@@ -655,4 +656,86 @@ BOOST_AUTO_TEST_CASE(CreateNewBlock_validity)
     TestPrioritisedMining(scriptPubKey, txFirst);
 }
 
+BOOST_AUTO_TEST_CASE(BlockTemplateManager_deltas)
+{
+    CTxMemPool& tx_mempool{*m_node.mempool};
+    BlockAssembler::Options options;
+    options.blockMinFeeRate = blockMinFeeRate;
+    options.test_block_validity = false;
+    BlockTemplateManager manager{*m_node.chainman, tx_mempool, options};
+    RegisterValidationInterface(&manager);
+
+    const CScript scriptPubKey{CScript() << OP_TRUE};
+    TestMemPoolEntryHelper entry;
+    // Add a transaction to the mempool and notify about it like validation does
+    const auto add_to_mempool{[&](const CMutableTransaction& tx, CAmount fee) {
+        LOCK2(cs_main, tx_mempool.cs);
+        tx_mempool.addUnchecked(entry.Fee(fee).FromTx(tx));
+        GetMainSignals().TransactionAddedToMempool(MakeTransactionRef(tx), tx_mempool.GetAndIncrementSequence());
+    }};
+    const auto template_txids{[&] {
+        SyncWithValidationInterfaceQueue();
+        std::set<uint256> txids;
+        const auto block_template{manager.GetTemplate(scriptPubKey)};
+        for (const auto& tx : block_template->block.vtx) {
+            if (!tx->IsCoinBase()) txids.insert(tx->GetHash());
+        }
+        return txids;
+    }};
+    const auto assembled_txids{[&] {
+        std::set<uint256> txids;
+        const auto block_template{BlockAssembler{m_node.chainman->ActiveChainstate(), &tx_mempool, options}.CreateNewBlock(scriptPubKey)};
+        for (const auto& tx : block_template->block.vtx) {
+            if (!tx->IsCoinBase()) txids.insert(tx->GetHash());
+        }
+        return txids;
+    }};
+
+    CMutableTransaction parent;
+    parent.vin.resize(1);
+    parent.vin[0].prevout = COutPoint{uint256::ONE, 0};
+    parent.vout.resize(1);
+    parent.vout[0].nValue = 10 * COIN;
+    add_to_mempool(parent, 10000);
+    BOOST_CHECK_EQUAL(template_txids().size(), 1U);
+
+    // A child of a transaction in the template, and an unrelated transaction,
+    // are appended to it
+    CMutableTransaction child;
+    child.vin.resize(1);
+    child.vin[0].prevout = COutPoint{parent.GetHash(), 0};
+    child.vout.resize(1);
+    child.vout[0].nValue = 9 * COIN;
+    add_to_mempool(child, 20000);
+    CMutableTransaction other{parent};
+    other.vin[0].prevout = COutPoint{uint256::ONE, 1};
+    const uint64_t update_id{manager.GetUpdateId()};
+    add_to_mempool(other, 30000);
+    BOOST_CHECK_EQUAL(template_txids().size(), 3U);
+    BOOST_CHECK(template_txids() == assembled_txids());
+
+    // The fee increase was published to long-polling callers
+    BOOST_CHECK(manager.GetUpdateId() > update_id);
+    BOOST_CHECK(manager.WaitForUpdate(update_id));
+
+    // The handed out template is complete and pays the fees to the coinbase
+    const auto block_template{manager.GetTemplate(scriptPubKey)};
+    const CBlock& block{block_template->block};
+    BOOST_CHECK(block.vtx[1]->GetHash() == parent.GetHash());
+    BOOST_CHECK(block.vtx[0]->vout[0].scriptPubKey == scriptPubKey);
+    BOOST_CHECK_EQUAL(block_template->vTxFees[0], -60000);
+    BOOST_CHECK(block.hashPrevBlock == WITH_LOCK(cs_main, return m_node.chainman->ActiveChain().Tip()->GetBlockHash()));
+
+    // Removing a transaction takes its descendants out of the template too
+    WITH_LOCK(tx_mempool.cs, tx_mempool.removeRecursive(CTransaction{parent}, MemPoolRemovalReason::EXPIRY));
+    BOOST_CHECK_EQUAL(template_txids().size(), 1U);
+    BOOST_CHECK(template_txids() == assembled_txids());
+
+    // Waiting callers return once interrupted
+    manager.Interrupt();
+    BOOST_CHECK(!manager.WaitForUpdate(manager.GetUpdateId()));
+
+    UnregisterValidationInterface(&manager);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -6,6 +6,7 @@
 #include <clientversion.h>
 #include <compat/compat.h>
 #include <cstdint>
+#include <hash.h>
 #include <net.h>
 #include <net_processing.h>
 #include <netaddress.h>
@@ -14,6 +15,8 @@
 #include <serialize.h>
 #include <span.h>
 #include <streams.h>
+#include <test/util/net.h>
+#include <test/util/random.h>
 #include <test/util/setup_common.h>
 #include <test/util/validation.h>
 #include <timedata.h>
@@ -905,4 +908,86 @@ BOOST_AUTO_TEST_CASE(initial_advertise_from_version_message)
     TestOnlyResetTimeData();
 }
 
+BOOST_AUTO_TEST_CASE(push_shared_message)
+{
+    ConnmanTestMsg connman{0x1337, 0x1337, *m_node.addrman, *m_node.netgroupman};
+    std::vector<std::unique_ptr<CNode>> peers;
+    for (NodeId id{0}; id < 2; ++id) {
+        peers.push_back(std::make_unique<CNode>(id,
+                                                /*sock=*/nullptr,
+                                                CAddress{},
+                                                /*nKeyedNetGroupIn=*/0,
+                                                /*nLocalHostNonceIn=*/0,
+                                                CAddress{},
+                                                /*addrNameIn=*/std::string{},
+                                                ConnectionType::OUTBOUND_FULL_RELAY,
+                                                /*inbound_onion=*/false));
+    }
+
+    const std::vector<unsigned char> payload(1000, 0x42);
+    const SharedNetMsg msg{CNetMsgMaker{PROTOCOL_VERSION}.Make(NetMsgType::BLOCK, payload)};
+    BOOST_CHECK(msg.Hash() == Hash(*msg.Data()));
+    for (const auto& peer : peers) {
+        connman.PushMessage(peer.get(), msg);
+    }
+
+    // Every peer gets its own header, but the payload is not copied.
+    for (const auto& peer : peers) {
+        LOCK(peer->cs_vSend);
+        BOOST_REQUIRE_EQUAL(peer->vSendMsg.size(), 2U);
+        BOOST_CHECK_EQUAL(peer->vSendMsg[0]->size(), CMessageHeader::HEADER_SIZE);
+        BOOST_CHECK_EQUAL(peer->vSendMsg[1], msg.Data());
+        BOOST_CHECK_EQUAL(peer->nSendSize, CMessageHeader::HEADER_SIZE + msg.Data()->size());
+        const auto checksum{Span{*peer->vSendMsg[0]}.subspan(CMessageHeader::HEADER_SIZE - CMessageHeader::CHECKSUM_SIZE)};
+        BOOST_CHECK(std::equal(checksum.begin(), checksum.end(), msg.Hash().begin()));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(receive_reuses_processed_messages)
+{
+    CNode node{/*id=*/0,
+               /*sock=*/nullptr,
+               CAddress{},
+               /*nKeyedNetGroupIn=*/0,
+               /*nLocalHostNonceIn=*/0,
+               CAddress{},
+               /*addrNameIn=*/std::string{},
+               ConnectionType::INBOUND,
+               /*inbound_onion=*/false};
+
+    // Payloads above and below MAX_RECYCLED_MSG_SIZE, so that buffers of earlier,
+    // larger messages are reused for smaller ones and the other way around
+    const std::vector<size_t> sizes{8, MAX_RECYCLED_MSG_SIZE + 1, 100, MAX_RECYCLED_MSG_SIZE, 0, 3000};
+    for (int round = 0; round < 4; ++round) {
+        std::vector<std::vector<unsigned char>> payloads;
+        std::vector<unsigned char> wire;
+        for (const size_t size : sizes) {
+            CSerializedNetMsg ser_msg;
+            ser_msg.m_type = NetMsgType::TX;
+            ser_msg.data = g_insecure_rand_ctx.randbytes(size);
+            payloads.push_back(ser_msg.data);
+            const SharedNetMsg msg{std::move(ser_msg)};
+            std::vector<unsigned char> header;
+            V1TransportSerializer{}.prepareForTransport(msg, header);
+            wire.insert(wire.end(), header.begin(), header.end());
+            wire.insert(wire.end(), msg.Data()->begin(), msg.Data()->end());
+        }
+
+        bool complete{false};
+        BOOST_REQUIRE(node.ReceiveMsgBytes(wire, complete));
+        BOOST_REQUIRE(complete);
+        node.MarkReceivedMsgsForProcessing();
+        for (size_t i = 0; i < payloads.size(); ++i) {
+            const auto poll_result{node.PollMessage()};
+            BOOST_REQUIRE(poll_result);
+            BOOST_CHECK_EQUAL(poll_result->second, i + 1 < payloads.size());
+            const CNetMessage& msg{poll_result->first};
+            BOOST_CHECK_EQUAL(msg.m_type, NetMsgType::TX);
+            BOOST_CHECK_EQUAL(msg.m_message_size, payloads[i].size());
+            BOOST_CHECK(MakeUCharSpan(msg.m_recv) == Span<const unsigned char>{payloads[i]});
+        }
+        BOOST_CHECK(!node.PollMessage());
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
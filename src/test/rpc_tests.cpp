@@ -7,6 +7,7 @@
 #include <node/context.h>
 #include <rpc/blockchain.h>
 #include <rpc/client.h>
+#include <rpc/jsonstream.h>
 #include <rpc/server.h>
 #include <rpc/util.h>
 #include <test/util/setup_common.h>
@@ -14,6 +15,7 @@
 #include <util/time.h>
 
 #include <any>
+#include <optional>
 
 #include <boost/test/unit_test.hpp>
 
@@ -315,6 +317,56 @@ BOOST_AUTO_TEST_CASE(json_parse_errors)
     BOOST_CHECK_THROW(ParseNonRFCJSONValue("3J98t1WpEZ73CNmQviecrnyiWrnqRhWNL"), std::runtime_error);
 }
 
+BOOST_AUTO_TEST_CASE(rpc_json_stream)
+{
+    std::string out;
+    {
+        // Flush often to check that chunks are passed on in order
+        JSONStreamWriter writer{[&](Span<const char> chunk) { out.append(chunk.begin(), chunk.end()); }, /*flush_size=*/4};
+        writer.BeginObject();
+        writer.Key("a");
+        writer.BeginArray();
+        writer.Value(1);
+        writer.Value("x\"y");
+        writer.BeginObject();
+        writer.EndObject();
+        writer.EndArray();
+        writer.Members(JSON(R"({"b":{"c":null,"d":[]},"e":true})"));
+        writer.KeyValue("f\n", JSON(R"([[],{"g":-1.5}])"));
+        writer.EndObject();
+        writer.Raw("\n");
+    }
+    BOOST_CHECK_EQUAL(out, JSON(R"({"a":[1,"x\"y",{}],"b":{"c":null,"d":[]},"e":true,"f\n":[[],{"g":-1.5}]})").write() + "\n");
+
+    // Streamed results are the same as executed ones
+    const auto stream_rpc = [&](const std::string& args) -> std::optional<std::string> {
+        std::vector<std::string> vArgs{SplitString(args, ' ')};
+        JSONRPCRequest request;
+        request.context = &m_node;
+        request.strMethod = vArgs[0];
+        vArgs.erase(vArgs.begin());
+        request.params = RPCConvertValues(request.strMethod, vArgs);
+        if (RPCIsInWarmup(nullptr)) SetRPCWarmupFinished();
+        RPCResultWriter result_writer{tableRPC.prepareStream(request)};
+        if (!result_writer) return std::nullopt;
+        std::string result;
+        {
+            JSONStreamWriter writer{[&](Span<const char> chunk) { result.append(chunk.begin(), chunk.end()); }};
+            result_writer(writer);
+        }
+        return result;
+    };
+    BOOST_CHECK_EQUAL(*stream_rpc("getrawmempool true"), CallRPC("getrawmempool true").write());
+    const std::string genesis{m_node.chainman->ActiveChain().Genesis()->GetBlockHash().GetHex()};
+    BOOST_CHECK_EQUAL(*stream_rpc("getblock " + genesis + " 2"), CallRPC("getblock " + genesis + " 2").write());
+    // Small results are left to the method
+    BOOST_CHECK(!stream_rpc("getrawmempool"));
+    BOOST_CHECK(!stream_rpc("getblock " + genesis));
+    // Errors are thrown before any of the result is written
+    BOOST_CHECK_THROW(stream_rpc("getblock " + std::string(64, '0') + " 2"), UniValue);
+    BOOST_CHECK_THROW(stream_rpc("getrawmempool true false extra"), UniValue);
+}
+
 BOOST_AUTO_TEST_CASE(rpc_ban)
 {
     BOOST_CHECK_NO_THROW(CallRPC(std::string("clearbanned")));
@@ -3,6 +3,7 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <compat/compat.h>
+#include <test/util/net.h>
 #include <test/util/setup_common.h>
 #include <util/sock.h>
 #include <util/system.h>
@@ -69,6 +70,17 @@ BOOST_AUTO_TEST_CASE(move_assignment)
     BOOST_CHECK(SocketIsClosed(s));
 }
 
+BOOST_AUTO_TEST_CASE(event_set_mocked)
+{
+    // Sockets without a file descriptor are waited on with their WaitMany()
+    SockEventSet sock_events;
+    sock_events.Set(std::make_shared<const StaticContentsSock>(""), Sock::RECV);
+    Sock::EventsPerSock occurred;
+    BOOST_REQUIRE(sock_events.Wait(0ms, occurred));
+    BOOST_REQUIRE_EQUAL(occurred.size(), 1U);
+    BOOST_CHECK_EQUAL(occurred.begin()->second.occurred, Sock::RECV);
+}
+
 #ifndef WIN32 // Windows does not have socketpair(2).
 
 static void CreateSocketPair(int s[2])
@@ -157,6 +169,46 @@ BOOST_AUTO_TEST_CASE(recv_until_terminator_limit)
     receiver.join();
 }
 
+BOOST_AUTO_TEST_CASE(event_set)
+{
+    int s[2];
+    CreateSocketPair(s);
+
+    const auto sock0{std::make_shared<const Sock>(s[0])};
+    Sock sock1(s[1]);
+    SockEventSet sock_events;
+    Sock::EventsPerSock occurred;
+
+    BOOST_CHECK(!sock_events.Wait(0ms, occurred));
+
+    sock_events.Set(sock0, Sock::RECV);
+    BOOST_REQUIRE(sock_events.Wait(0ms, occurred));
+    BOOST_CHECK(occurred.empty());
+
+    // Readiness is reported until the data is read
+    BOOST_REQUIRE_EQUAL(sock1.Send("a", 1, 0), 1);
+    for (int i = 0; i < 2; ++i) {
+        BOOST_REQUIRE(sock_events.Wait(1min, occurred));
+        BOOST_REQUIRE_EQUAL(occurred.size(), 1U);
+        BOOST_CHECK(occurred.begin()->first == sock0);
+        BOOST_CHECK_EQUAL(occurred.begin()->second.occurred, Sock::RECV);
+    }
+
+    // Only the newly requested events are reported
+    sock_events.Set(sock0, Sock::SEND);
+    BOOST_REQUIRE(sock_events.Wait(1min, occurred));
+    BOOST_REQUIRE_EQUAL(occurred.size(), 1U);
+    BOOST_CHECK_EQUAL(occurred.begin()->second.occurred, Sock::SEND);
+
+    // Sockets are kept until they are not set between two RemoveUnset() calls
+    sock_events.RemoveUnset();
+    BOOST_CHECK_EQUAL(sock_events.Size(), 1U);
+    sock_events.RemoveUnset();
+    BOOST_CHECK_EQUAL(sock_events.Size(), 0U);
+    BOOST_CHECK(!sock_events.Wait(0ms, occurred));
+    BOOST_CHECK_EQUAL(sock0.use_count(), 1);
+}
+
 #endif /* WIN32 */
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -4,10 +4,78 @@
 
 #include <node/txreconciliation.h>
 
+#include <random.h>
 #include <test/util/setup_common.h>
 
 #include <boost/test/unit_test.hpp>
 
+#include <algorithm>
+
+namespace {
+
+/** Register the same connection with both of its ends, so that they agree on the salt. */
+void RegisterConnection(TxReconciliationTracker& initiator, TxReconciliationTracker& responder, NodeId peer_id)
+{
+    const uint64_t initiator_salt{initiator.PreRegisterPeer(peer_id)};
+    const uint64_t responder_salt{responder.PreRegisterPeer(peer_id)};
+    BOOST_REQUIRE(initiator.RegisterPeer(peer_id, /*is_peer_inbound=*/false, 1, responder_salt) == ReconciliationRegisterResult::SUCCESS);
+    BOOST_REQUIRE(responder.RegisterPeer(peer_id, /*is_peer_inbound=*/true, 1, initiator_salt) == ReconciliationRegisterResult::SUCCESS);
+}
+
+struct RoundResult {
+    bool success{false};
+    bool extended{false};
+    std::vector<uint256> initiator_announce;
+    std::vector<uint256> responder_announce;
+};
+
+/** Run a reconciliation round over the given connection, passing messages between its ends. */
+RoundResult RunRound(TxReconciliationTracker& initiator, TxReconciliationTracker& responder, NodeId peer_id, std::chrono::microseconds now)
+{
+    RoundResult round;
+    const auto request{initiator.InitiateReconciliationRequest(peer_id, now)};
+    BOOST_REQUIRE(request);
+    std::vector<uint8_t> skdata;
+    BOOST_REQUIRE(responder.HandleReconciliationRequest(peer_id, request->first, request->second, skdata));
+    ReconciliationSketchResult result;
+    BOOST_REQUIRE(initiator.HandleSketch(peer_id, skdata, result));
+    if (!result.success) {
+        round.extended = true;
+        BOOST_REQUIRE(responder.HandleExtensionRequest(peer_id, skdata));
+        BOOST_REQUIRE(initiator.HandleSketch(peer_id, skdata, result));
+        BOOST_REQUIRE(result.success);
+    }
+    round.success = *result.success;
+    round.initiator_announce = result.announce;
+    BOOST_REQUIRE(responder.HandleReconciliationDifference(peer_id, round.success, result.ask_shortids, round.responder_announce));
+    std::sort(round.initiator_announce.begin(), round.initiator_announce.end());
+    std::sort(round.responder_announce.begin(), round.responder_announce.end());
+    return round;
+}
+
+/** Add the same number of new transactions to both ends, and then some to each end only. */
+void FillSets(TxReconciliationTracker& initiator, TxReconciliationTracker& responder, NodeId peer_id,
+              size_t common, std::vector<uint256>& initiator_only, std::vector<uint256>& responder_only)
+{
+    for (size_t i = 0; i < common; ++i) {
+        const uint256 wtxid{GetRandHash()};
+        BOOST_REQUIRE(initiator.AddToSet(peer_id, wtxid));
+        BOOST_REQUIRE(responder.AddToSet(peer_id, wtxid));
+    }
+    for (uint256& wtxid : initiator_only) {
+        wtxid = GetRandHash();
+        BOOST_REQUIRE(initiator.AddToSet(peer_id, wtxid));
+    }
+    for (uint256& wtxid : responder_only) {
+        wtxid = GetRandHash();
+        BOOST_REQUIRE(responder.AddToSet(peer_id, wtxid));
+    }
+    std::sort(initiator_only.begin(), initiator_only.end());
+    std::sort(responder_only.begin(), responder_only.end());
+}
+
+} // namespace
+
 BOOST_FIXTURE_TEST_SUITE(txreconciliation_tests, BasicTestingSetup)
 
 BOOST_AUTO_TEST_CASE(RegisterPeerTest)
@@ -81,4 +149,171 @@ BOOST_AUTO_TEST_CASE(IsPeerRegisteredTest)
     BOOST_CHECK(!tracker.IsPeerRegistered(peer_id0));
 }
 
+BOOST_AUTO_TEST_CASE(AddToSetTest)
+{
+    TxReconciliationTracker tracker(TXRECONCILIATION_VERSION);
+    NodeId peer_id0 = 0;
+    const uint256 wtxid{GetRandHash()};
+
+    // Only registered peers have a set.
+    BOOST_CHECK(!tracker.AddToSet(peer_id0, wtxid));
+    tracker.PreRegisterPeer(peer_id0);
+    BOOST_CHECK(!tracker.AddToSet(peer_id0, wtxid));
+    BOOST_REQUIRE_EQUAL(tracker.RegisterPeer(peer_id0, true, 1, 1), ReconciliationRegisterResult::SUCCESS);
+
+    BOOST_CHECK(tracker.AddToSet(peer_id0, wtxid));
+    // Adding twice is fine.
+    BOOST_CHECK(tracker.AddToSet(peer_id0, wtxid));
+    BOOST_CHECK(tracker.TryRemovingFromSet(peer_id0, wtxid));
+    BOOST_CHECK(!tracker.TryRemovingFromSet(peer_id0, wtxid));
+
+    // Transactions that don't fit are left to be flooded.
+    for (size_t i = 0; i < MAX_RECONSET_SIZE; ++i) {
+        BOOST_REQUIRE(tracker.AddToSet(peer_id0, GetRandHash()));
+    }
+    BOOST_CHECK(!tracker.AddToSet(peer_id0, wtxid));
+
+    tracker.ForgetPeer(peer_id0);
+    BOOST_CHECK(!tracker.AddToSet(peer_id0, wtxid));
+}
+
+BOOST_AUTO_TEST_CASE(ShouldFanoutToTest)
+{
+    TxReconciliationTracker tracker(TXRECONCILIATION_VERSION);
+    const std::vector<NodeId> outbound{0, 1, 2, 3};
+    const std::vector<NodeId> inbound{4, 5, 6, 7};
+    for (const NodeId peer_id : outbound) {
+        tracker.PreRegisterPeer(peer_id);
+        BOOST_REQUIRE_EQUAL(tracker.RegisterPeer(peer_id, /*is_peer_inbound=*/false, 1, 1), ReconciliationRegisterResult::SUCCESS);
+    }
+    for (const NodeId peer_id : inbound) {
+        tracker.PreRegisterPeer(peer_id);
+        BOOST_REQUIRE_EQUAL(tracker.RegisterPeer(peer_id, /*is_peer_inbound=*/true, 1, 1), ReconciliationRegisterResult::SUCCESS);
+    }
+
+    // Transactions are always flooded to peers we don't reconcile with.
+    BOOST_CHECK(tracker.ShouldFanoutTo(GetRandHash(), 100));
+
+    constexpr int TXS{1000};
+    int inbound_fanouts{0};
+    for (int i = 0; i < TXS; ++i) {
+        const uint256 wtxid{GetRandHash()};
+        // Each transaction is flooded to exactly one outbound reconciling peer, the same one every time.
+        const size_t fanouts(std::count_if(outbound.begin(), outbound.end(), [&](NodeId peer_id) { return tracker.ShouldFanoutTo(wtxid, peer_id); }));
+        BOOST_CHECK_EQUAL(fanouts, OUTBOUND_FANOUT_DESTINATIONS);
+        for (const NodeId peer_id : outbound) {
+            BOOST_CHECK_EQUAL(tracker.ShouldFanoutTo(wtxid, peer_id), tracker.ShouldFanoutTo(wtxid, peer_id));
+        }
+        inbound_fanouts += std::count_if(inbound.begin(), inbound.end(), [&](NodeId peer_id) { return tracker.ShouldFanoutTo(wtxid, peer_id); });
+    }
+    // About INBOUND_FANOUT_DESTINATIONS_FRACTION of the inbound peers for each transaction.
+    BOOST_CHECK(inbound_fanouts > TXS * inbound.size() * INBOUND_FANOUT_DESTINATIONS_FRACTION / 2);
+    BOOST_CHECK(inbound_fanouts < TXS * inbound.size() * INBOUND_FANOUT_DESTINATIONS_FRACTION * 2);
+}
+
+BOOST_AUTO_TEST_CASE(ReconciliationRoundTest)
+{
+    TxReconciliationTracker initiator(TXRECONCILIATION_VERSION);
+    TxReconciliationTracker responder(TXRECONCILIATION_VERSION);
+    NodeId peer_id0 = 0;
+    RegisterConnection(initiator, responder, peer_id0);
+    std::chrono::microseconds now{1h};
+
+    // Empty sets.
+    RoundResult round{RunRound(initiator, responder, peer_id0, now)};
+    BOOST_CHECK(round.success);
+    BOOST_CHECK(round.initiator_announce.empty());
+    BOOST_CHECK(round.responder_announce.empty());
+
+    // The initial sketch is enough for a small difference; each side learns what the other is missing.
+    std::vector<uint256> initiator_only(3), responder_only(4);
+    FillSets(initiator, responder, peer_id0, 100, initiator_only, responder_only);
+    now += RECON_REQUEST_INTERVAL;
+    round = RunRound(initiator, responder, peer_id0, now);
+    BOOST_CHECK(round.success);
+    BOOST_CHECK(!round.extended);
+    BOOST_CHECK(round.initiator_announce == initiator_only);
+    BOOST_CHECK(round.responder_announce == responder_only);
+
+    // The sets were emptied by the round.
+    now += RECON_REQUEST_INTERVAL;
+    round = RunRound(initiator, responder, peer_id0, now);
+    BOOST_CHECK(round.success);
+    BOOST_CHECK(round.initiator_announce.empty());
+    BOOST_CHECK(round.responder_announce.empty());
+}
+
+BOOST_AUTO_TEST_CASE(SketchExtensionTest)
+{
+    TxReconciliationTracker initiator(TXRECONCILIATION_VERSION);
+    TxReconciliationTracker responder(TXRECONCILIATION_VERSION);
+    NodeId peer_id0 = 0;
+    RegisterConnection(initiator, responder, peer_id0);
+    std::chrono::microseconds now{1h};
+
+    // With equal set sizes the initial sketch only accounts for RECON_Q of the sets differing,
+    // a larger difference is found with the extension.
+    std::vector<uint256> initiator_only(5), responder_only(5);
+    FillSets(initiator, responder, peer_id0, 15, initiator_only, responder_only);
+    RoundResult round{RunRound(initiator, responder, peer_id0, now)};
+    BOOST_CHECK(round.success);
+    BOOST_CHECK(round.extended);
+    BOOST_CHECK(round.initiator_announce == initiator_only);
+    BOOST_CHECK(round.responder_announce == responder_only);
+
+    // If even the extension is not enough, both sides announce their whole sets.
+    initiator_only.assign(60, {});
+    responder_only.assign(60, {});
+    FillSets(initiator, responder, peer_id0, 0, initiator_only, responder_only);
+    now += RECON_REQUEST_INTERVAL;
+    round = RunRound(initiator, responder, peer_id0, now);
+    BOOST_CHECK(!round.success);
+    BOOST_CHECK(round.extended);
+    BOOST_CHECK(round.initiator_announce == initiator_only);
+    BOOST_CHECK(round.responder_announce == responder_only);
+}
+
+BOOST_AUTO_TEST_CASE(ReconciliationProtocolTest)
+{
+    TxReconciliationTracker initiator(TXRECONCILIATION_VERSION);
+    TxReconciliationTracker responder(TXRECONCILIATION_VERSION);
+    NodeId peer_id0 = 0;
+    RegisterConnection(initiator, responder, peer_id0);
+    std::chrono::microseconds now{1h};
+    std::vector<uint8_t> skdata;
+    ReconciliationSketchResult result;
+    std::vector<uint256> announce;
+
+    // Only the initiator requests sketches, only the responder sends them.
+    BOOST_CHECK(!responder.InitiateReconciliationRequest(peer_id0, now));
+    BOOST_CHECK(!initiator.HandleReconciliationRequest(peer_id0, 0, 0, skdata));
+    BOOST_CHECK(!responder.HandleSketch(peer_id0, skdata, result));
+
+    // Messages out of order.
+    BOOST_CHECK(!initiator.HandleSketch(peer_id0, skdata, result));
+    BOOST_CHECK(!responder.HandleExtensionRequest(peer_id0, skdata));
+    BOOST_CHECK(!responder.HandleReconciliationDifference(peer_id0, true, {}, announce));
+
+    // One round at a time, at most every RECON_REQUEST_INTERVAL.
+    const uint256 wtxid{GetRandHash()};
+    BOOST_REQUIRE(initiator.AddToSet(peer_id0, wtxid));
+    const auto request{initiator.InitiateReconciliationRequest(peer_id0, now)};
+    BOOST_REQUIRE(request);
+    BOOST_CHECK_EQUAL(request->first, 1);
+    BOOST_CHECK_EQUAL(request->second, static_cast<uint16_t>(RECON_Q * RECON_Q_PRECISION));
+    BOOST_CHECK(!initiator.InitiateReconciliationRequest(peer_id0, now + RECON_REQUEST_INTERVAL));
+    BOOST_REQUIRE(responder.HandleReconciliationRequest(peer_id0, request->first, request->second, skdata));
+    BOOST_CHECK(!responder.HandleReconciliationRequest(peer_id0, request->first, request->second, skdata));
+
+    // Sketches of an invalid size.
+    BOOST_CHECK(!initiator.HandleSketch(peer_id0, std::vector<uint8_t>(3), result));
+    BOOST_CHECK(!initiator.HandleSketch(peer_id0, std::vector<uint8_t>(MAX_SKETCH_CAPACITY * 4), result));
+
+    // A round the responder never finishes is abandoned, keeping its transactions for the next one.
+    BOOST_CHECK(!initiator.InitiateReconciliationRequest(peer_id0, now + RECON_RESPONSE_TIMEOUT - 1s));
+    const auto next_request{initiator.InitiateReconciliationRequest(peer_id0, now + RECON_RESPONSE_TIMEOUT)};
+    BOOST_REQUIRE(next_request);
+    BOOST_CHECK_EQUAL(next_request->first, 1);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -119,6 +119,15 @@ public:
 
     ssize_t Send(const void*, size_t len, int) const override { return len; }
 
+    ssize_t SendMany(Span<const Span<const unsigned char>> data, int) const override
+    {
+        size_t len{0};
+        for (const auto& buf : data) {
+            len += buf.size();
+        }
+        return len;
+    }
+
     ssize_t Recv(void* buf, size_t len, int flags) const override
     {
         const size_t consume_bytes{std::min(len, m_contents.size() - m_consumed)};
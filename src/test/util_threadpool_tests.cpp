@@ -0,0 +1,58 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <util/threadpool.h>
+
+#include <atomic>
+#include <future>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE(util_threadpool_tests)
+
+BOOST_AUTO_TEST_CASE(run_tasks)
+{
+    ThreadPool pool;
+    pool.Start("test_pool", 3);
+    BOOST_CHECK_EQUAL(pool.NumThreads(), 3);
+
+    std::atomic<int> sum{0};
+    std::vector<std::promise<void>> done(100);
+    for (int i = 0; i < 100; ++i) {
+        pool.Submit([&sum, &done, i] {
+            sum += i;
+            done[i].set_value();
+        });
+    }
+    for (auto& promise : done) {
+        promise.get_future().wait();
+    }
+    BOOST_CHECK_EQUAL(sum, 4950);
+
+    pool.Stop();
+    BOOST_CHECK_EQUAL(pool.NumThreads(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(stop_drops_queued_tasks)
+{
+    ThreadPool pool;
+    pool.Start("test_pool", 1);
+
+    // Keep the only thread busy until the pool is stopping, so that the next task stays queued
+    std::promise<void> started;
+    pool.Submit([&started, &pool] {
+        started.set_value();
+        while (pool.NumThreads() > 0) std::this_thread::yield();
+    });
+    started.get_future().wait();
+    bool ran{false};
+    pool.Submit([&ran] { ran = true; });
+
+    pool.Stop();
+    BOOST_CHECK(!ran);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -51,41 +51,50 @@ bool TestLockPointValidity(CChain& active_chain, const LockPoints& lp)
 void CTxMemPool::UpdateForDescendants(txiter updateIt, cacheMap& cachedDescendants,
                                       const std::set<uint256>& setExclude, std::set<uint256>& descendants_to_remove)
 {
-    CTxMemPoolEntry::Children stageEntries, descendants;
-    stageEntries = updateIt->GetMemPoolChildrenConst();
-
-    while (!stageEntries.empty()) {
-        const CTxMemPoolEntry& descendant = *stageEntries.begin();
-        descendants.insert(descendant);
-        stageEntries.erase(descendant);
-        const CTxMemPoolEntry::Children& children = descendant.GetMemPoolChildrenConst();
-        for (const CTxMemPoolEntry& childEntry : children) {
-            cacheMap::iterator cacheIt = cachedDescendants.find(mapTx.iterator_to(childEntry));
-            if (cacheIt != cachedDescendants.end()) {
-                // We've already calculated this one, just add the entries for this set
-                // but don't traverse again.
-                for (txiter cacheEntry : cacheIt->second) {
-                    descendants.insert(*cacheEntry);
+    std::vector<txiter> descendants;
+    {
+        WITH_FRESH_EPOCH(m_epoch);
+        std::vector<txiter> stage;
+        for (const CTxMemPoolEntry& child : updateIt->GetMemPoolChildrenConst()) {
+            const txiter childIt = mapTx.iterator_to(child);
+            if (!visited(childIt)) stage.push_back(childIt);
+        }
+
+        while (!stage.empty()) {
+            const txiter descendantIt = stage.back();
+            stage.pop_back();
+            descendants.push_back(descendantIt);
+            const CTxMemPoolEntry::Children& children = descendantIt->GetMemPoolChildrenConst();
+            for (const CTxMemPoolEntry& childEntry : children) {
+                const txiter childIt = mapTx.iterator_to(childEntry);
+                cacheMap::iterator cacheIt = cachedDescendants.find(childIt);
+                if (cacheIt != cachedDescendants.end()) {
+                    // We've already calculated this one, just add the entries for this set
+                    // but don't traverse again.
+                    for (txiter cacheEntry : cacheIt->second) {
+                        if (!visited(cacheEntry)) descendants.push_back(cacheEntry);
+                    }
+                } else if (!visited(childIt)) {
+                    // Schedule for later processing
+                    stage.push_back(childIt);
                 }
-            } else if (!descendants.count(childEntry)) {
-                // Schedule for later processing
-                stageEntries.insert(childEntry);
             }
         }
-    }
+    } // release epoch guard
     // descendants now contains all in-mempool descendants of updateIt.
     // Update and add to cached descendant map
     int64_t modifySize = 0;
     CAmount modifyFee = 0;
     int64_t modifyCount = 0;
-    for (const CTxMemPoolEntry& descendant : descendants) {
+    for (const txiter descendantIt : descendants) {
+        const CTxMemPoolEntry& descendant = *descendantIt;
         if (!setExclude.count(descendant.GetTx().GetHash())) {
             modifySize += descendant.GetTxSize();
             modifyFee += descendant.GetModifiedFee();
             modifyCount++;
-            cachedDescendants[updateIt].insert(mapTx.iterator_to(descendant));
+            cachedDescendants[updateIt].insert(descendantIt);
             // Update ancestor state for each descendant
-            mapTx.modify(mapTx.iterator_to(descendant), [=](CTxMemPoolEntry& e) {
+            mapTx.modify(descendantIt, [=](CTxMemPoolEntry& e) {
               e.UpdateAncestorState(updateIt->GetTxSize(), updateIt->GetModifiedFee(), 1, updateIt->GetSigOpCost());
             });
             // Don't directly remove the transaction here -- doing so would
@@ -163,12 +172,21 @@ util::Result<CTxMemPool::setEntries> CTxMemPool::CalculateAncestorsAndCheckLimit
     size_t totalSizeWithAncestors = entry_size;
     setEntries ancestors;
 
-    while (!staged_ancestors.empty()) {
-        const CTxMemPoolEntry& stage = staged_ancestors.begin()->get();
-        txiter stageit = mapTx.iterator_to(stage);
+    // Entries are marked as visited when they are staged, so that each
+    // ancestor is staged exactly once.
+    WITH_FRESH_EPOCH(m_epoch);
+    std::vector<txiter> stage;
+    stage.reserve(staged_ancestors.size());
+    for (const CTxMemPoolEntry& staged : staged_ancestors) {
+        const txiter stageit = mapTx.iterator_to(staged);
+        if (!visited(stageit)) stage.push_back(stageit);
+    }
+
+    while (!stage.empty()) {
+        const txiter stageit = stage.back();
+        stage.pop_back();
 
         ancestors.insert(stageit);
-        staged_ancestors.erase(stage);
         totalSizeWithAncestors += stageit->GetTxSize();
 
         if (stageit->GetSizeWithDescendants() + entry_size > static_cast<uint64_t>(limits.descendant_size_vbytes)) {
@@ -184,10 +202,10 @@ util::Result<CTxMemPool::setEntries> CTxMemPool::CalculateAncestorsAndCheckLimit
             txiter parent_it = mapTx.iterator_to(parent);
 
             // If this is a new ancestor, add it.
-            if (ancestors.count(parent_it) == 0) {
-                staged_ancestors.insert(parent);
+            if (!visited(parent_it)) {
+                stage.push_back(parent_it);
             }
-            if (staged_ancestors.size() + ancestors.size() + entry_count > static_cast<uint64_t>(limits.ancestor_count)) {
+            if (stage.size() + ancestors.size() + entry_count > static_cast<uint64_t>(limits.ancestor_count)) {
                 return util::Error{Untranslated(strprintf("too many unconfirmed ancestors [limit: %u]", limits.ancestor_count))};
             }
         }
@@ -319,15 +337,23 @@ void CTxMemPool::UpdateForRemoveFromMempool(const setEntries &entriesToRemove, b
         // Here we only update statistics and not data in CTxMemPool::Parents
         // and CTxMemPoolEntry::Children (which we need to preserve until we're
         // finished with all operations that need to traverse the mempool).
+        std::vector<txiter> stage;
         for (txiter removeIt : entriesToRemove) {
-            setEntries setDescendants;
-            CalculateDescendants(removeIt, setDescendants);
-            setDescendants.erase(removeIt); // don't update state for self
+            WITH_FRESH_EPOCH(m_epoch);
             int64_t modifySize = -((int64_t)removeIt->GetTxSize());
             CAmount modifyFee = -removeIt->GetModifiedFee();
             int modifySigOps = -removeIt->GetSigOpCost();
-            for (txiter dit : setDescendants) {
-                mapTx.modify(dit, [=](CTxMemPoolEntry& e){ e.UpdateAncestorState(modifySize, modifyFee, -1, modifySigOps); });
+            stage.push_back(removeIt);
+            (void)visited(removeIt); // don't update state for self
+            while (!stage.empty()) {
+                const txiter it = stage.back();
+                stage.pop_back();
+                for (const CTxMemPoolEntry& child : it->GetMemPoolChildrenConst()) {
+                    const txiter dit = mapTx.iterator_to(child);
+                    if (visited(dit)) continue;
+                    mapTx.modify(dit, [=](CTxMemPoolEntry& e){ e.UpdateAncestorState(modifySize, modifyFee, -1, modifySigOps); });
+                    stage.push_back(dit);
+                }
             }
         }
     }
@@ -528,23 +554,24 @@ void CTxMemPool::removeUnchecked(txiter it, MemPoolRemovalReason reason)
 // can save time by not iterating over those entries.
 void CTxMemPool::CalculateDescendants(txiter entryit, setEntries& setDescendants) const
 {
-    setEntries stage;
-    if (setDescendants.count(entryit) == 0) {
-        stage.insert(entryit);
-    }
+    if (setDescendants.count(entryit) != 0) return;
+
+    WITH_FRESH_EPOCH(m_epoch);
+    std::vector<txiter> stage{entryit};
+    (void)visited(entryit);
     // Traverse down the children of entry, only adding children that are not
     // accounted for in setDescendants already (because those children have either
     // already been walked, or will be walked in this iteration).
     while (!stage.empty()) {
-        txiter it = *stage.begin();
+        txiter it = stage.back();
+        stage.pop_back();
         setDescendants.insert(it);
-        stage.erase(it);
 
         const CTxMemPoolEntry::Children& children = it->GetMemPoolChildrenConst();
         for (const CTxMemPoolEntry& child : children) {
             txiter childiter = mapTx.iterator_to(child);
-            if (!setDescendants.count(childiter)) {
-                stage.insert(childiter);
+            if (!visited(childiter) && !setDescendants.count(childiter)) {
+                stage.push_back(childiter);
             }
         }
     }
@@ -11,6 +11,7 @@
 #include <util/threadinterrupt.h>
 #include <util/time.h>
 
+#include <array>
 #include <memory>
 #include <stdexcept>
 #include <string>
@@ -56,6 +57,24 @@ ssize_t Sock::Send(const void* data, size_t len, int flags) const
     return send(m_socket, static_cast<const char*>(data), len, flags);
 }
 
+ssize_t Sock::SendMany(Span<const Span<const unsigned char>> data, int flags) const
+{
+    assert(data.size() <= MAX_SEND_MANY_BUFFERS);
+#ifdef WIN32
+    return data.empty() ? 0 : Send(data[0].data(), data[0].size(), flags);
+#else
+    std::array<iovec, MAX_SEND_MANY_BUFFERS> iov;
+    for (size_t i = 0; i < data.size(); ++i) {
+        iov[i].iov_base = const_cast<unsigned char*>(data[i].data());
+        iov[i].iov_len = data[i].size();
+    }
+    msghdr msg{};
+    msg.msg_iov = iov.data();
+    msg.msg_iovlen = data.size();
+    return sendmsg(m_socket, &msg, flags);
+#endif
+}
+
 ssize_t Sock::Recv(void* buf, size_t len, int flags) const
 {
     return recv(m_socket, static_cast<char*>(buf), len, flags);
@@ -400,6 +419,147 @@ bool Sock::IsConnected(std::string& errmsg) const
     }
 }
 
+#ifdef USE_EPOLL
+static uint32_t EpollEvents(Sock::Event requested)
+{
+    uint32_t events{0};
+    if (requested & Sock::RECV) {
+        events |= EPOLLIN;
+    }
+    if (requested & Sock::SEND) {
+        events |= EPOLLOUT;
+    }
+    return events;
+}
+#endif
+
+SockEventSet::SockEventSet()
+{
+#ifdef USE_EPOLL
+    m_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (m_epoll_fd == -1) {
+        LogPrintf("Failed to create epoll instance, falling back to poll: %s\n", SysErrorString(errno));
+    }
+#endif
+}
+
+SockEventSet::~SockEventSet()
+{
+#ifdef USE_EPOLL
+    StopEpoll();
+#endif
+}
+
+#ifdef USE_EPOLL
+void SockEventSet::StopEpoll()
+{
+    if (m_epoll_fd != -1) {
+        close(m_epoll_fd);
+        m_epoll_fd = -1;
+        m_ready.clear();
+        m_ready.shrink_to_fit();
+    }
+}
+#endif
+
+void SockEventSet::Set(const std::shared_ptr<const Sock>& sock, Sock::Event requested)
+{
+    const auto [it, inserted] = m_socks.try_emplace(sock, Entry{requested, true});
+    if (!inserted) {
+        it->second.set = true;
+        if (it->second.requested == requested) {
+            return;
+        }
+        it->second.requested = requested;
+    }
+#ifdef USE_EPOLL
+    if (m_epoll_fd == -1) {
+        return;
+    }
+    // Elements of an unordered_map are not moved by rehashing, so the
+    // registration can point at the entry until it is removed.
+    epoll_event ev{};
+    ev.events = EpollEvents(requested);
+    ev.data.ptr = &*it;
+    if (epoll_ctl(m_epoll_fd, inserted ? EPOLL_CTL_ADD : EPOLL_CTL_MOD, sock->Get(), &ev) == -1) {
+        LogPrint(BCLog::NET, "Cannot wait on socket with epoll, falling back to poll: %s\n", SysErrorString(errno));
+        StopEpoll();
+    }
+#endif
+}
+
+void SockEventSet::RemoveUnset()
+{
+    for (auto it = m_socks.begin(); it != m_socks.end();) {
+        if (it->second.set) {
+            it->second.set = false;
+            ++it;
+            continue;
+        }
+#ifdef USE_EPOLL
+        // Closing the socket would not remove the registration while other
+        // owners of the Sock keep it open, so remove it explicitly.
+        if (m_epoll_fd != -1) {
+            epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, it->first->Get(), nullptr);
+        }
+#endif
+        it = m_socks.erase(it);
+    }
+}
+
+void SockEventSet::Clear()
+{
+    for (auto& [sock, entry] : m_socks) {
+        entry.set = false;
+    }
+    RemoveUnset();
+}
+
+bool SockEventSet::Wait(std::chrono::milliseconds timeout, Sock::EventsPerSock& occurred)
+{
+    occurred.clear();
+    if (m_socks.empty()) {
+        return false;
+    }
+
+#ifdef USE_EPOLL
+    if (m_epoll_fd != -1) {
+        m_ready.resize(m_socks.size());
+        const int ready{epoll_wait(m_epoll_fd, m_ready.data(), m_ready.size(), count_milliseconds(timeout))};
+        if (ready == -1) {
+            return false;
+        }
+        for (int i = 0; i < ready; ++i) {
+            const auto& [sock, entry] = *static_cast<const EntryPerSock::value_type*>(m_ready[i].data.ptr);
+            Sock::Events events{entry.requested};
+            if (m_ready[i].events & EPOLLIN) {
+                events.occurred |= Sock::RECV;
+            }
+            if (m_ready[i].events & EPOLLOUT) {
+                events.occurred |= Sock::SEND;
+            }
+            if (m_ready[i].events & (EPOLLERR | EPOLLHUP)) {
+                events.occurred |= Sock::ERR;
+            }
+            occurred.emplace(sock, events);
+        }
+        return true;
+    }
+#endif
+
+    for (const auto& [sock, entry] : m_socks) {
+        occurred.emplace(sock, Sock::Events{entry.requested});
+    }
+    if (!occurred.begin()->first->WaitMany(timeout, occurred)) {
+        occurred.clear();
+        return false;
+    }
+    for (auto it = occurred.begin(); it != occurred.end();) {
+        it = it->second.occurred == 0 ? occurred.erase(it) : std::next(it);
+    }
+    return true;
+}
+
 void Sock::Close()
 {
     if (m_socket == INVALID_SOCKET) {
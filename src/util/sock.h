@@ -6,6 +6,7 @@
 #define BITCOIN_UTIL_SOCK_H
 
 #include <compat/compat.h>
+#include <span.h>
 #include <util/threadinterrupt.h>
 #include <util/time.h>
 
@@ -13,6 +14,11 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
+
+#ifdef USE_EPOLL
+#include <sys/epoll.h>
+#endif
 
 /**
  * Maximum time to wait for I/O readiness.
@@ -74,6 +80,17 @@ public:
      */
     [[nodiscard]] virtual ssize_t Send(const void* data, size_t len, int flags) const;
 
+    /** Maximum number of buffers passed to `SendMany()` */
+    static constexpr size_t MAX_SEND_MANY_BUFFERS{64};
+
+    /**
+     * sendmsg(2) wrapper, sending up to `MAX_SEND_MANY_BUFFERS` buffers in one call as if they
+     * were concatenated. Where sendmsg(2) is not available, only the first buffer is sent. Code
+     * that uses this wrapper can be unit tested if this method is overridden by a mock Sock
+     * implementation.
+     */
+    [[nodiscard]] virtual ssize_t SendMany(Span<const Span<const unsigned char>> data, int flags) const;
+
     /**
      * recv(2) wrapper. Equivalent to `recv(this->Get(), buf, len, flags);`. Code that uses this
      * wrapper can be unit tested if this method is overridden by a mock Sock implementation.
@@ -279,6 +296,79 @@ private:
     void Close();
 };
 
+/**
+ * Sockets that are waited on repeatedly, keeping the events requested for
+ * each of them between the waits.
+ *
+ * Where epoll(7) is available, a socket is registered once and only updated
+ * when the events requested for it change, and a wait takes time in the number
+ * of ready sockets rather than the number of registered ones. Otherwise, or
+ * if a socket cannot be registered (e.g. a mocked one), each wait falls back
+ * to `Sock::WaitMany()` on all the sockets.
+ *
+ * Not thread safe.
+ */
+class SockEventSet
+{
+public:
+    SockEventSet();
+    ~SockEventSet();
+
+    SockEventSet(const SockEventSet&) = delete;
+    SockEventSet& operator=(const SockEventSet&) = delete;
+
+    /**
+     * Wait for the requested events on a socket from now on, replacing the
+     * events requested for it before. `Sock::ERR` is reported even if nothing
+     * is requested, as with `Sock::WaitMany()`.
+     */
+    void Set(const std::shared_ptr<const Sock>& sock, Sock::Event requested);
+
+    /**
+     * Stop waiting on the sockets that were not passed to `Set()` since the
+     * previous call. This keeps the set in sync with a changing collection of
+     * sockets by calling `Set()` for each of them before every wait.
+     */
+    void RemoveUnset();
+
+    /** Stop waiting on all sockets. */
+    void Clear();
+
+    size_t Size() const { return m_socks.size(); }
+
+    /**
+     * Wait for the requested events on any of the sockets.
+     * @param[in] timeout Wait this long for at least one of the requested events to occur.
+     * @param[out] occurred The sockets on which events occurred, with `occurred` set.
+     * @return true on success or timeout (with `occurred` empty), false if
+     * the set is empty or the wait failed
+     */
+    [[nodiscard]] bool Wait(std::chrono::milliseconds timeout, Sock::EventsPerSock& occurred);
+
+private:
+    struct Entry {
+        Sock::Event requested;
+        //! Whether `Set()` was called for the socket since the last `RemoveUnset()`
+        bool set;
+    };
+
+    using EntryPerSock = std::unordered_map<std::shared_ptr<const Sock>, Entry, Sock::HashSharedPtrSock, Sock::EqualSharedPtrSock>;
+
+    /**
+     * The registered sockets. The `shared_ptr` keeps the socket open while it
+     * is registered, so its file descriptor cannot be reused by another one.
+     */
+    EntryPerSock m_socks;
+
+#ifdef USE_EPOLL
+    //! The epoll instance, or -1 if waits fall back to `Sock::WaitMany()`
+    int m_epoll_fd{-1};
+    std::vector<epoll_event> m_ready;
+
+    void StopEpoll();
+#endif
+};
+
 /** Return readable error string for a network error code */
 std::string NetworkErrorString(int err);
 
@@ -0,0 +1,52 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <util/threadpool.h>
+
+#include <tinyformat.h>
+#include <util/thread.h>
+
+#include <utility>
+
+void ThreadPool::Run()
+{
+    while (true) {
+        std::function<void()> task;
+        {
+            WAIT_LOCK(m_mutex, lock);
+            m_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_stopping || !m_tasks.empty(); });
+            if (m_stopping) return;
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+        }
+        task();
+    }
+}
+
+void ThreadPool::Start(const std::string& name, int threads)
+{
+    WITH_LOCK(m_mutex, m_stopping = false);
+    for (int i = 0; i < threads; ++i) {
+        m_threads.emplace_back(&util::TraceThread, strprintf("%s.%i", name, i), [this] { Run(); });
+    }
+    m_num_threads = threads;
+}
+
+void ThreadPool::Stop()
+{
+    WITH_LOCK(m_mutex, m_stopping = true);
+    m_num_threads = 0;
+    m_cv.notify_all();
+    for (std::thread& thread : m_threads) {
+        thread.join();
+    }
+    m_threads.clear();
+    WITH_LOCK(m_mutex, m_tasks.clear());
+}
+
+void ThreadPool::Submit(std::function<void()> task)
+{
+    WITH_LOCK(m_mutex, m_tasks.push_back(std::move(task)));
+    m_cv.notify_one();
+}
@@ -0,0 +1,46 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_UTIL_THREADPOOL_H
+#define BITCOIN_UTIL_THREADPOOL_H
+
+#include <sync.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+/** A fixed number of threads that run queued tasks in submission order */
+class ThreadPool
+{
+private:
+    Mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<std::function<void()>> m_tasks GUARDED_BY(m_mutex);
+    bool m_stopping GUARDED_BY(m_mutex){false};
+    std::vector<std::thread> m_threads;
+    std::atomic<int> m_num_threads{0};
+
+    void Run() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+public:
+    ~ThreadPool() { Stop(); }
+
+    /** Start threads named "<name>.0" ... "<name>.<threads-1>". */
+    void Start(const std::string& name, int threads) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /** Wait for running tasks and join the threads. Tasks still queued are dropped. */
+    void Stop() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    int NumThreads() const { return m_num_threads; }
+
+    /** Queue a task. Tasks still queued when the pool stops are dropped. */
+    void Submit(std::function<void()> task) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+};
+
+#endif // BITCOIN_UTIL_THREADPOOL_H
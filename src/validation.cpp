@@ -62,6 +62,7 @@
 #include <cassert>
 #include <chrono>
 #include <deque>
+#include <future>
 #include <numeric>
 #include <optional>
 #include <string>
@@ -169,6 +170,13 @@ bool CheckInputScripts(const CTransaction& tx, TxValidationState& state,
                        std::vector<CScriptCheck>* pvChecks = nullptr)
                        EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
+/** Script checks of connected blocks and of transactions entering the mempool.
+ * Both run under cs_main, so they never compete for the queue. */
+static CCheckQueue<CScriptCheck> scriptcheckqueue(128);
+
+/** Mempool transactions (or packages) with fewer inputs than this have their scripts checked serially. */
+static constexpr size_t PARALLEL_MEMPOOL_SCRIPT_CHECK_MIN_INPUTS{16};
+
 bool CheckFinalTxAtTip(const CBlockIndex& active_chain_tip, const CTransaction& tx)
 {
     AssertLockHeld(cs_main);
@@ -642,6 +650,8 @@ private:
         /** A temporary cache containing serialized transaction data for signature verification.
          * Reused across PolicyScriptChecks and ConsensusScriptChecks. */
         PrecomputedTransactionData m_precomputed_txdata;
+        /** Whether ParallelPolicyScriptChecks() already verified the scripts with our policy flags. */
+        bool m_policy_scripts_checked{false};
     };
 
     // Run the policy checks on a given transaction, excluding any script checks.
@@ -662,6 +672,13 @@ private:
     // only invoke this on transactions that have otherwise passed policy checks.
     bool PolicyScriptChecks(const ATMPArgs& args, Workspace& ws) EXCLUSIVE_LOCKS_REQUIRED(cs_main, m_pool.cs);
 
+    // Run the script checks of PolicyScriptChecks() for all inputs of the given
+    // transactions at once on the script check queue, which stops at the first
+    // failure. If they all pass, PolicyScriptChecks() doesn't run them again;
+    // otherwise it runs them serially to determine the failing transaction and
+    // its validation state. Does nothing for too few inputs.
+    void ParallelPolicyScriptChecks(Span<Workspace> workspaces) EXCLUSIVE_LOCKS_REQUIRED(cs_main, m_pool.cs);
+
     // Re-run the script checks, using consensus flags, and try to cache the
     // result in the scriptcache. This should be done after
     // PolicyScriptChecks(). This requires that all inputs either be in our
@@ -1037,6 +1054,8 @@ bool MemPoolAccept::PolicyScriptChecks(const ATMPArgs& args, Workspace& ws)
 
     constexpr unsigned int scriptVerifyFlags = STANDARD_SCRIPT_VERIFY_FLAGS;
 
+    if (ws.m_policy_scripts_checked) return true;
+
     // Check input scripts and signatures.
     // This is done last to help prevent CPU exhaustion denial-of-service attacks.
     if (!CheckInputScripts(tx, state, m_view, scriptVerifyFlags, true, false, ws.m_precomputed_txdata)) {
@@ -1056,6 +1075,31 @@ bool MemPoolAccept::PolicyScriptChecks(const ATMPArgs& args, Workspace& ws)
     return true;
 }
 
+void MemPoolAccept::ParallelPolicyScriptChecks(Span<Workspace> workspaces)
+{
+    AssertLockHeld(cs_main);
+    AssertLockHeld(m_pool.cs);
+
+    size_t num_inputs{0};
+    for (const Workspace& ws : workspaces) {
+        num_inputs += ws.m_ptx->vin.size();
+    }
+    if (num_inputs < PARALLEL_MEMPOOL_SCRIPT_CHECK_MIN_INPUTS || !scriptcheckqueue.HasThreads()) return;
+
+    CCheckQueueControl<CScriptCheck> control(&scriptcheckqueue);
+    for (Workspace& ws : workspaces) {
+        std::vector<CScriptCheck> checks;
+        TxValidationState state_dummy; // Checks are only collected, nothing is reported here
+        CheckInputScripts(*ws.m_ptx, state_dummy, m_view, STANDARD_SCRIPT_VERIFY_FLAGS, true, false, ws.m_precomputed_txdata, &checks);
+        control.Add(std::move(checks));
+    }
+    if (!control.Wait()) return;
+
+    for (Workspace& ws : workspaces) {
+        ws.m_policy_scripts_checked = true;
+    }
+}
+
 bool MemPoolAccept::ConsensusScriptChecks(const ATMPArgs& args, Workspace& ws)
 {
     AssertLockHeld(cs_main);
@@ -1254,6 +1298,7 @@ MempoolAcceptResult MemPoolAccept::AcceptSingleTransaction(const CTransactionRef
 
     // Perform the inexpensive checks first and avoid hashing and signature verification unless
     // those checks pass, to mitigate CPU exhaustion denial-of-service attacks.
+    ParallelPolicyScriptChecks(Span<Workspace>{&ws, 1});
     if (!PolicyScriptChecks(args, ws)) return MempoolAcceptResult::Failure(ws.m_state);
 
     if (!ConsensusScriptChecks(args, ws)) return MempoolAcceptResult::Failure(ws.m_state);
@@ -1333,6 +1378,8 @@ PackageMempoolAcceptResult MemPoolAccept::AcceptMultipleTransactions(const std::
     all_package_wtxids.reserve(workspaces.size());
     std::transform(workspaces.cbegin(), workspaces.cend(), std::back_inserter(all_package_wtxids),
                    [](const auto& ws) { return ws.m_ptx->GetWitnessHash(); });
+    // Check the scripts of all transactions together; they were all resolved by PreChecks().
+    ParallelPolicyScriptChecks(workspaces);
     for (Workspace& ws : workspaces) {
         ws.m_package_feerate = package_feerate;
         if (!PolicyScriptChecks(args, ws)) {
@@ -1770,6 +1817,12 @@ bool CScriptCheck::operator()() {
     return VerifyScript(scriptSig, m_tx_out.scriptPubKey, witness, nFlags, CachingTransactionSignatureChecker(ptxTo, nIn, m_tx_out.nValue, cacheStore, *txdata), &error);
 }
 
+bool CScriptCheck::operator()(BatchSchnorrVerifier& batch) {
+    const CScript &scriptSig = ptxTo->vin[nIn].scriptSig;
+    const CScriptWitness *witness = &ptxTo->vin[nIn].scriptWitness;
+    return VerifyScript(scriptSig, m_tx_out.scriptPubKey, witness, nFlags, CachingTransactionSignatureChecker(ptxTo, nIn, m_tx_out.nValue, cacheStore, *txdata, &batch), &error);
+}
+
 static CuckooCache::cache<uint256, SignatureCacheHasher> g_scriptExecutionCache;
 static CSHA256 g_scriptExecutionCacheHasher;
 
@@ -2084,16 +2137,107 @@ DisconnectResult Chainstate::DisconnectBlock(const CBlock& block, const CBlockIn
     return fClean ? DISCONNECT_OK : DISCONNECT_UNCLEAN;
 }
 
-static CCheckQueue<CScriptCheck> scriptcheckqueue(128);
+/** Blocks with fewer transactions than this have their Merkle roots computed serially. */
+static constexpr size_t PARALLEL_MERKLE_MIN_LEAVES{4096};
+/** Height of the subtrees a large block's Merkle tree is split into (1024 leaves each). */
+static constexpr unsigned int MERKLE_SUBTREE_HEIGHT{10};
+
+/**
+ * Closure representing the computation of one subtree of a block's (witness)
+ * Merkle tree, from the transaction hashes cached in the block.
+ */
+class CMerkleSubtreeCheck
+{
+public:
+    struct Result {
+        uint256 root;
+        bool mutated{false};
+    };
+
+private:
+    const CBlock* m_block;
+    bool m_witness;
+    size_t m_begin;
+    size_t m_end;
+    Result* m_result;
+
+public:
+    CMerkleSubtreeCheck(const CBlock& block, bool witness, size_t begin, size_t end, Result& result)
+        : m_block(&block), m_witness(witness), m_begin(begin), m_end(end), m_result(&result) {}
+
+    bool operator()()
+    {
+        std::vector<uint256> leaves;
+        leaves.reserve(m_end - m_begin);
+        for (size_t i = m_begin; i < m_end; ++i) {
+            if (!m_witness) {
+                leaves.push_back(m_block->vtx[i]->GetHash());
+            } else if (i == 0) {
+                leaves.emplace_back(); // The witness hash of the coinbase is 0.
+            } else {
+                leaves.push_back(m_block->vtx[i]->GetWitnessHash());
+            }
+        }
+        m_result->root = ComputeMerkleSubtreeRoot(std::move(leaves), MERKLE_SUBTREE_HEIGHT, &m_result->mutated);
+        return true;
+    }
+};
+
+static CCheckQueue<CMerkleSubtreeCheck> merklequeue(1, "merkle");
 
 void StartScriptCheckWorkerThreads(int threads_num)
 {
     scriptcheckqueue.StartWorkerThreads(threads_num);
+    merklequeue.StartWorkerThreads(threads_num);
 }
 
 void StopScriptCheckWorkerThreads()
 {
     scriptcheckqueue.StopWorkerThreads();
+    merklequeue.StopWorkerThreads();
+}
+
+static uint256 ParallelMerkleRoot(const CBlock& block, bool witness, bool* mutated)
+{
+    if (block.vtx.size() < PARALLEL_MERKLE_MIN_LEAVES || !merklequeue.HasThreads()) {
+        return witness ? BlockWitnessMerkleRoot(block, mutated) : BlockMerkleRoot(block, mutated);
+    }
+
+    const size_t subtree_leaves{size_t{1} << MERKLE_SUBTREE_HEIGHT};
+    std::vector<CMerkleSubtreeCheck::Result> subtrees((block.vtx.size() + subtree_leaves - 1) / subtree_leaves);
+    {
+        CCheckQueueControl<CMerkleSubtreeCheck> control(&merklequeue);
+        std::vector<CMerkleSubtreeCheck> checks;
+        checks.reserve(subtrees.size());
+        for (size_t i = 0; i < subtrees.size(); ++i) {
+            checks.emplace_back(block, witness, i * subtree_leaves, std::min(block.vtx.size(), (i + 1) * subtree_leaves), subtrees[i]);
+        }
+        control.Add(std::move(checks));
+        control.Wait();
+    }
+
+    // Combine the subtree roots into the upper levels of the tree.
+    bool mutation{false};
+    std::vector<uint256> roots;
+    roots.reserve(subtrees.size());
+    for (const auto& subtree : subtrees) {
+        roots.push_back(subtree.root);
+        mutation |= subtree.mutated;
+    }
+    bool upper_mutation{false};
+    const uint256 root{ComputeMerkleRoot(std::move(roots), &upper_mutation)};
+    if (mutated) *mutated = mutation || upper_mutation;
+    return root;
+}
+
+uint256 ParallelBlockMerkleRoot(const CBlock& block, bool* mutated)
+{
+    return ParallelMerkleRoot(block, /*witness=*/false, mutated);
+}
+
+uint256 ParallelBlockWitnessMerkleRoot(const CBlock& block, bool* mutated)
+{
+    return ParallelMerkleRoot(block, /*witness=*/true, mutated);
 }
 
 /**
@@ -3713,7 +3857,7 @@ bool CheckBlock(const CBlock& block, BlockValidationState& state, const Consensu
     // Check the merkle root.
     if (fCheckMerkleRoot) {
         bool mutated;
-        uint256 hashMerkleRoot2 = BlockMerkleRoot(block, &mutated);
+        uint256 hashMerkleRoot2 = ParallelBlockMerkleRoot(block, &mutated);
         if (block.hashMerkleRoot != hashMerkleRoot2)
             return state.Invalid(BlockValidationResult::BLOCK_MUTATED, "bad-txnmrklroot", "hashMerkleRoot mismatch");
 
@@ -3767,6 +3911,28 @@ bool CheckBlock(const CBlock& block, BlockValidationState& state, const Consensu
     return true;
 }
 
+bool CheckBlockConcurrentPoW(const CBlock& block, BlockValidationState& state, const Consensus::Params& consensusParams)
+{
+    if (block.fChecked)
+        return true;
+
+    // yespower takes milliseconds, about as long as the other checks of a full block.
+    auto pow_hash{std::async(std::launch::async, [&block] { return block.GetPoWHash_cached(); })};
+    const bool valid{CheckBlock(block, state, consensusParams, /*fCheckPOW=*/false)};
+    pow_hash.wait();
+    if (!valid)
+        return false;
+
+    if (!CheckBlockHeader(block, state, consensusParams))
+        return false;
+    if (consensusParams.signet_blocks && !CheckSignetBlockSolution(block, consensusParams)) {
+        return state.Invalid(BlockValidationResult::BLOCK_CONSENSUS, "bad-signet-blksig", "signet block signature validation failure");
+    }
+
+    block.fChecked = true;
+    return true;
+}
+
 void ChainstateManager::UpdateUncommittedBlockStructures(CBlock& block, const CBlockIndex* pindexPrev) const
 {
     int commitpos = GetWitnessCommitmentIndex(block);
@@ -3925,7 +4091,7 @@ static bool ContextualCheckBlock(const CBlock& block, BlockValidationState& stat
         int commitpos = GetWitnessCommitmentIndex(block);
         if (commitpos != NO_WITNESS_COMMITMENT) {
             bool malleated = false;
-            uint256 hashWitness = BlockWitnessMerkleRoot(block, &malleated);
+            uint256 hashWitness = ParallelBlockWitnessMerkleRoot(block, &malleated);
             // The malleation check is ignored; as the transaction tree itself
             // already does not permit it, it is impossible to trigger in the
             // witness tree.
@@ -23,6 +23,7 @@
 #include <policy/packages.h>
 #include <policy/policy.h>
 #include <script/script_error.h>
+#include <script/sigcache.h>
 #include <shutdown.h>
 #include <sync.h>
 #include <txdb.h>
@@ -117,11 +118,19 @@ extern uint256 g_best_block;
 /** Documentation for argument 'checklevel'. */
 extern const std::vector<std::string> CHECKLEVEL_DOC;
 
-/** Run instances of script checking worker threads */
+/** Run instances of script checking worker threads (and as many Merkle tree worker threads) */
 void StartScriptCheckWorkerThreads(int threads_num);
-/** Stop all of the script checking worker threads */
+/** Stop all of the script checking and Merkle tree worker threads */
 void StopScriptCheckWorkerThreads();
 
+/**
+ * Same as BlockMerkleRoot(), but for large blocks the subtrees of the lower
+ * levels are computed in parallel on the Merkle tree worker threads.
+ */
+uint256 ParallelBlockMerkleRoot(const CBlock& block, bool* mutated = nullptr);
+/** Same as BlockWitnessMerkleRoot(), parallelized like ParallelBlockMerkleRoot() */
+uint256 ParallelBlockWitnessMerkleRoot(const CBlock& block, bool* mutated = nullptr);
+
 CAmount GetBlockSubsidy(int nHeight, const Consensus::Params& consensusParams);
 
 bool AbortNode(BlockValidationState& state, const std::string& strMessage, const bilingual_str& userMessage = bilingual_str{});
@@ -329,6 +338,11 @@ bool CheckSequenceLocksAtTip(CBlockIndex* tip,
  */
 class CScriptCheck
 {
+public:
+    //! Schnorr signature checks are deferred and verified per check queue batch.
+    using Batch = BatchSchnorrVerifier;
+
+
 private:
     CTxOut m_tx_out;
     const CTransaction *ptxTo;
@@ -348,6 +362,7 @@ public:
     CScriptCheck& operator=(CScriptCheck&&) = default;
 
     bool operator()();
+    bool operator()(BatchSchnorrVerifier& batch);
 
     ScriptError GetScriptError() const { return error; }
 };
@@ -360,6 +375,14 @@ public:
 /** Context-independent validity checks */
 bool CheckBlock(const CBlock& block, BlockValidationState& state, const Consensus::Params& consensusParams, bool fCheckPOW = true, bool fCheckMerkleRoot = true);
 
+/**
+ * CheckBlock() that computes the proof of work hash on a separate thread while
+ * the rest of the block is checked. The hash is cached in the block, so later
+ * header checks don't compute it again. The block must not be shared with
+ * other threads yet (see CBlock::fChecked).
+ */
+bool CheckBlockConcurrentPoW(const CBlock& block, BlockValidationState& state, const Consensus::Params& consensusParams);
+
 /** Check a block is completely valid from start to finish (only works on top of our current best block) */
 bool TestBlockValidity(BlockValidationState& state,
                        const CChainParams& chainparams,
@@ -535,6 +535,56 @@ class RESTTest(SugarchainTestFramework):
                 ),
             )
 
+        self.log.info("Test the /blockrange URI and streamed /headers")
+        tip_height = self.nodes[0].getblockcount()
+        genesis_hash = self.nodes[0].getblockhash(0)
+        # Binary headers beyond the JSON limit are streamed, until the tip
+        response = self.test_rest_request(
+            f"/headers/{genesis_hash}",
+            req_type=ReqType.BIN,
+            ret_type=RetType.OBJ,
+            query_params={"count": 5000},
+        )
+        assert_equal(response.getheader("transfer-encoding"), "chunked")
+        response_bytes = response.read()
+        assert_equal(len(response_bytes), (tip_height + 1) * BLOCK_HEADER_SIZE)
+        assert_equal(
+            response_bytes[-BLOCK_HEADER_SIZE:].hex(),
+            self.nodes[0].getblockheader(self.nodes[0].getbestblockhash(), False),
+        )
+
+        # The range ends at the tip
+        expected_blocks = "".join(
+            self.nodes[0].getblock(self.nodes[0].getblockhash(height), 0)
+            for height in range(tip_height - 2, tip_height + 1)
+        )
+        response_bytes = self.test_rest_request(
+            f"/blockrange/{tip_height - 2}/10",
+            req_type=ReqType.BIN,
+            ret_type=RetType.BYTES,
+        )
+        assert_equal(response_bytes.hex(), expected_blocks)
+        response_hex = self.test_rest_request(
+            f"/blockrange/{tip_height - 2}/10",
+            req_type=ReqType.HEX,
+            ret_type=RetType.BYTES,
+        )
+        assert_equal(response_hex.decode("utf-8").rstrip(), expected_blocks)
+
+        resp = self.test_rest_request(
+            f"/blockrange/{tip_height + 1}/1",
+            req_type=ReqType.BIN,
+            ret_type=RetType.OBJ,
+            status=404,
+        )
+        assert_equal(
+            resp.read().decode("utf-8").rstrip(), "Block height out of range"
+        )
+        self.test_rest_request(
+            "/blockrange/0/0", req_type=ReqType.BIN, ret_type=RetType.OBJ, status=400
+        )
+        self.test_rest_request("/blockrange/0/1", ret_type=RetType.OBJ, status=404)
+
         self.log.info("Test tx inclusion in the /mempool and /block URIs")
 
         # Make 3 chained txs and mine them on node 1
@@ -0,0 +1,232 @@
+#!/usr/bin/env python3
+# Copyright (c) 2022 The Bitcoin Core developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+"""Test transaction reconciliation rounds (BIP 330).
+
+A node with many simulated peers, some of which reconcile transactions with
+it, is checked to:
+- flood every transaction to legacy peers, to exactly one outbound reconciling
+  peer and to a small fraction of the inbound reconciling peers;
+- announce its whole set when a round it initiated fails;
+- answer reconciliation requests with a sketch of its set and announce what
+  the peer asks for;
+- disconnect peers that violate the protocol.
+Then a few nodes are checked to relay transactions to each other through
+reconciliations.
+"""
+
+import time
+
+from test_framework.key import TaggedHash
+from test_framework.messages import (
+    MSG_WTX,
+    msg_reconcildiff,
+    msg_reqrecon,
+    msg_sendtxrcncl,
+    msg_sketch,
+)
+from test_framework.p2p import P2PInterface, p2p_lock
+from test_framework.siphash import siphash256
+from test_framework.test_framework import SugarchainTestFramework
+from test_framework.util import assert_equal, assert_greater_than
+from test_framework.wallet import MiniWallet
+
+NUM_OUTBOUND = 8
+NUM_INBOUND = 16
+NUM_LEGACY = 4
+NUM_TXS = 20
+NUM_RELAY_NODES = 5
+
+
+class InvReceiver(P2PInterface):
+    def __init__(self):
+        super().__init__()
+        self.txinvs = set()
+
+    def on_inv(self, message):
+        for i in message.inv:
+            if i.type == MSG_WTX:
+                self.txinvs.add("{:064x}".format(i.hash))
+
+    def get_txinvs(self):
+        with p2p_lock:
+            return set(self.txinvs)
+
+
+class ReconcilingPeer(InvReceiver):
+    def __init__(self):
+        super().__init__()
+        self.salt = 42
+        self.node_salt = None
+        self.respond_with_empty_sketch = False
+        self.reqrecons = []
+        self.sketches = []
+        self.reconcildiffs = []
+
+    def on_version(self, message):
+        # Reconciliation must be negotiated before VERACK.
+        sendtxrcncl = msg_sendtxrcncl()
+        sendtxrcncl.version = 1
+        sendtxrcncl.salt = self.salt
+        self.send_message(sendtxrcncl)
+        super().on_version(message)
+
+    def on_sendtxrcncl(self, message):
+        self.node_salt = message.salt
+
+    def on_reqrecon(self, message):
+        self.reqrecons.append(message)
+        if self.respond_with_empty_sketch:
+            # An empty sketch can't be decoded against a non-empty set, so
+            # the round fails.
+            self.send_message(msg_sketch())
+
+    def on_sketch(self, message):
+        self.sketches.append(message)
+
+    def on_reconcildiff(self, message):
+        self.reconcildiffs.append(message)
+
+    def short_id(self, wtxid):
+        salt1, salt2 = sorted([self.salt, self.node_salt])
+        salt = TaggedHash("Tx Relay Salting", salt1.to_bytes(8, "little") + salt2.to_bytes(8, "little"))
+        k0 = int.from_bytes(salt[0:8], "little")
+        k1 = int.from_bytes(salt[8:16], "little")
+        return 1 + (siphash256(k0, k1, int(wtxid, 16)) % 0xFFFFFFFF)
+
+
+class TxReconciliationTest(SugarchainTestFramework):
+    def set_test_params(self):
+        self.num_nodes = NUM_RELAY_NODES
+        self.extra_args = [["-txreconciliation"]] * self.num_nodes
+
+    def setup_network(self):
+        # Connected later, so that only the simulated peers talk to node0 at first.
+        self.setup_nodes()
+
+    def bump_until(self, predicate):
+        def bump_and_check():
+            self.mocktime += 1
+            self.nodes[0].setmocktime(self.mocktime)
+            return predicate()
+        self.wait_until(bump_and_check)
+
+    def run_test(self):
+        node = self.nodes[0]
+        self.wallet = MiniWallet(node)
+        self.mocktime = int(time.time())
+        node.setmocktime(self.mocktime)
+
+        self.log.info("Connect many reconciling and legacy peers")
+        outbound = [node.add_outbound_p2p_connection(ReconcilingPeer(), p2p_idx=i) for i in range(NUM_OUTBOUND)]
+        inbound = [node.add_p2p_connection(ReconcilingPeer()) for _ in range(NUM_INBOUND)]
+        legacy = [node.add_p2p_connection(InvReceiver()) for _ in range(NUM_LEGACY)]
+        for peer in outbound + inbound:
+            assert peer.node_salt is not None
+
+        self.test_fanout(outbound, inbound, legacy)
+        self.test_initiator_fallback(outbound)
+        self.test_responder(inbound)
+        self.test_protocol_violations(inbound)
+
+        node.disconnect_p2ps()
+        node.setmocktime(0)
+        self.test_relay_between_nodes()
+
+    def test_fanout(self, outbound, inbound, legacy):
+        self.log.info("Transactions are flooded to legacy peers and to a few reconciling peers")
+        self.wtxids = set(self.wallet.send_self_transfer(from_node=self.nodes[0])["wtxid"] for _ in range(NUM_TXS))
+
+        self.bump_until(lambda: all(peer.get_txinvs() == self.wtxids for peer in legacy))
+        self.bump_until(lambda: set().union(*[peer.get_txinvs() for peer in outbound]) == self.wtxids)
+        # Give the remaining outbound trickles a chance to run.
+        for _ in range(30):
+            self.bump_until(lambda: True)
+        for peer in outbound + inbound:
+            peer.sync_with_ping()
+
+        # The outbound reconciling peers don't answer reconciliation requests
+        # yet, so floods are all they got.
+        for wtxid in self.wtxids:
+            assert_equal(sum(wtxid in peer.get_txinvs() for peer in outbound), 1)
+        inbound_floods = sum(len(peer.get_txinvs()) for peer in inbound)
+        assert_greater_than(NUM_TXS * NUM_INBOUND // 2, inbound_floods)
+
+    def test_initiator_fallback(self, outbound):
+        self.log.info("A failed round makes the initiator announce its whole set")
+        flooded = [peer.get_txinvs() for peer in outbound]
+        for peer in outbound:
+            with p2p_lock:
+                peer.respond_with_empty_sketch = True
+        self.bump_until(lambda: all(peer.get_txinvs() == self.wtxids for peer in outbound))
+        for peer, peer_flooded in zip(outbound, flooded):
+            if len(peer_flooded) == NUM_TXS:
+                continue
+            with p2p_lock:
+                assert any(diff.success == 0 for diff in peer.reconcildiffs)
+
+    def test_responder(self, inbound):
+        self.log.info("The responder sends a sketch of its set and announces what is asked for")
+        peer = inbound[0]
+        flooded = peer.get_txinvs()
+        in_set = sorted(self.wtxids - flooded)
+        assert len(in_set) > 0
+
+        peer.send_and_ping(msg_reqrecon(set_size=0, q=0))
+        with p2p_lock:
+            skdata = peer.sketches[-1].skdata
+        assert_equal(len(skdata) % 4, 0)
+        assert_greater_than(len(skdata) // 4, len(in_set))
+
+        asked = in_set[0]
+        peer.send_and_ping(msg_reconcildiff(success=1, ask_shortids=[peer.short_id(asked)]))
+        assert_equal(peer.get_txinvs(), flooded | {asked})
+
+        # The set was emptied by the round.
+        peer.send_and_ping(msg_reqrecon(set_size=0, q=0))
+        with p2p_lock:
+            assert_equal(peer.sketches[-1].skdata, b"")
+        peer.send_and_ping(msg_reconcildiff(success=0))
+        assert_equal(peer.get_txinvs(), flooded | {asked})
+
+        self.log.info("A failed round makes the responder announce its whole set")
+        peer = inbound[1]
+        peer.send_and_ping(msg_reqrecon(set_size=0, q=0))
+        peer.send_and_ping(msg_reconcildiff(success=0))
+        assert_equal(peer.get_txinvs(), self.wtxids)
+
+    def test_protocol_violations(self, inbound):
+        self.log.info("Peers violating the reconciliation protocol are disconnected")
+        # Only the initiator receives sketches.
+        inbound[2].send_message(msg_sketch())
+        inbound[2].wait_for_disconnect()
+        # No round was started.
+        inbound[3].send_message(msg_reconcildiff(success=1))
+        inbound[3].wait_for_disconnect()
+        # One round at a time.
+        inbound[4].send_and_ping(msg_reqrecon(set_size=0, q=0))
+        inbound[4].send_message(msg_reqrecon(set_size=0, q=0))
+        inbound[4].wait_for_disconnect()
+
+    def test_relay_between_nodes(self):
+        self.log.info("Nodes relay transactions to each other through reconciliation")
+        # Every node has two outbound connections, so it reconciles most
+        # transactions with one of them rather than flooding them.
+        for i in range(self.num_nodes):
+            self.connect_nodes(i, (i + 1) % self.num_nodes)
+            self.connect_nodes(i, (i + 2) % self.num_nodes)
+
+        for _ in range(NUM_TXS):
+            self.wallet.send_self_transfer(from_node=self.nodes[0])
+        self.sync_mempools()
+
+        def recon_bytes(msgtype):
+            return sum(peer["bytesrecv_per_msg"].get(msgtype, 0) for node in self.nodes for peer in node.getpeerinfo())
+        self.wait_until(lambda: recon_bytes("reconcildiff") > 0)
+        assert_greater_than(recon_bytes("reqrecon"), 0)
+        assert_greater_than(recon_bytes("sketch"), 0)
+
+
+if __name__ == '__main__':
+    TxReconciliationTest().main()
@@ -337,6 +337,7 @@ BASE_SCRIPTS = [
     "p2p_tx_privacy.py",
     "rpc_scanblocks.py",
     "p2p_sendtxrcncl.py",
+    "p2p_txrecon.py",
     "rpc_scantxoutset.py",
     "feature_txindex_compatibility.py",
     "feature_unsupported_utxo_db.py",